@@ -0,0 +1,133 @@
+/**
+ * Compares the catalog parsing path DSUsync used to have (copy the content into a
+ * std::string, copy it again into a buffer, build a rapidjson DOM in situ, walk the array)
+ * with the streaming parser in content-parser.hpp, on catalogs of 10, 1k and 100k entries.
+ */
+
+#include "content-parser.hpp"
+
+#include <ndn-cxx/data.hpp>
+#include <rapidjson/document.h>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        class TimepointSum : public ContentVisitor
+        {
+        public:
+            TimepointSum()
+            : sum(0)
+            {
+            }
+
+            virtual void
+            onDatapoint(uint64_t timepoint)
+            {
+                sum += timepoint;
+            }
+
+            uint64_t sum;
+        };
+
+        static uint64_t
+        parseWithDocument(const Data& data)
+        {
+            std::string content((char *)data.getContent().value(), data.getContent().value_size());
+            // DSUsync used a stack VLA here, which would not survive the 100k case
+            std::vector<char> buffer(data.getContent().value_size() + 1);
+            std::strcpy(buffer.data(), content.c_str());
+            rapidjson::Document document;
+            if (document.ParseInsitu<0>(buffer.data()).HasParseError()) {
+                return 0;
+            }
+
+            uint64_t sum = 0;
+            const rapidjson::Value& list = document;
+            for (rapidjson::SizeType i = 0; i < list.Size(); i++) {
+                sum += list[i].GetUint64();
+            }
+            return sum;
+        }
+
+        static uint64_t
+        parseWithStream(const Data& data)
+        {
+            TimepointSum visitor;
+            parseCatalog(data.getContent(), visitor);
+            return visitor.sum;
+        }
+
+        static shared_ptr<Data>
+        makeCatalog(size_t nEntries)
+        {
+            std::ostringstream os;
+            os << "[";
+            for (size_t i = 0; i < nEntries; i++) {
+                os << (i == 0 ? "" : ",") << 1456000000000000ULL + i * 1000000;
+            }
+            os << "]";
+            std::string json = os.str();
+
+            shared_ptr<Data> data = make_shared<Data>(Name("/org/openmhealth/alice/data/fitness/physical_activity/time_location/catalog"));
+            data->setContent(reinterpret_cast<const uint8_t*>(json.data()), json.size());
+            return data;
+        }
+
+        template<typename Function>
+        static double
+        measure(Function parse, const Data& data, size_t nIterations, uint64_t& checksum)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < nIterations; i++) {
+                checksum += parse(data);
+            }
+            std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+            return elapsed.count() / nIterations;
+        }
+
+        static void
+        run()
+        {
+            static const size_t SIZES[] = {10, 1000, 100000};
+            // roughly the same number of entries parsed for every catalog size
+            static const size_t TOTAL_ENTRIES = 10000000;
+
+            std::cout << std::setw(10) << "entries"
+                      << std::setw(16) << "document (us)"
+                      << std::setw(16) << "stream (us)"
+                      << std::setw(10) << "speedup" << std::endl;
+
+            for (size_t i = 0; i < sizeof(SIZES) / sizeof(SIZES[0]); i++) {
+                shared_ptr<Data> catalog = makeCatalog(SIZES[i]);
+                size_t nIterations = TOTAL_ENTRIES / SIZES[i];
+
+                uint64_t documentSum = 0;
+                uint64_t streamSum = 0;
+                double document = measure(&parseWithDocument, *catalog, nIterations, documentSum);
+                double stream = measure(&parseWithStream, *catalog, nIterations, streamSum);
+                if (documentSum != streamSum) {
+                    std::cerr << "ERROR: parsers disagree on " << SIZES[i] << " entries" << std::endl;
+                }
+
+                std::cout << std::setw(10) << SIZES[i]
+                          << std::setw(16) << std::fixed << std::setprecision(3) << document
+                          << std::setw(16) << stream
+                          << std::setw(9) << std::setprecision(2) << document / stream << "x" << std::endl;
+            }
+        }
+
+    } // namespace dsu
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+    ndn::dsu::run();
+    return 0;
+}
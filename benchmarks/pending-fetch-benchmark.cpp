@@ -0,0 +1,187 @@
+/**
+ * Memory and time per operation of PendingFetchTable against the nested
+ * std::map<name::Component, std::map<Name, int>> it replaced, at 100k outstanding
+ * datapoint fetches spread over 100 users.
+ */
+
+#include "pending-fetch-table.hpp"
+
+#include <ndn-cxx/name.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+
+// heap accounting: every allocation carries its size in front of the returned block
+static size_t g_allocated = 0;
+
+void*
+operator new(size_t size)
+{
+    void* block = std::malloc(size + sizeof(std::max_align_t));
+    if (block == 0) {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    g_allocated += size;
+    return static_cast<char*>(block) + sizeof(std::max_align_t);
+}
+
+void
+operator delete(void* p) noexcept
+{
+    if (p == 0) {
+        return;
+    }
+    void* block = static_cast<char*>(p) - sizeof(std::max_align_t);
+    g_allocated -= *static_cast<size_t*>(block);
+    std::free(block);
+}
+
+namespace ndn {
+    namespace dsu {
+
+        static const size_t N_USERS = 100;
+        static const size_t N_PER_USER = 1000;
+        static const uint64_t FIRST_TIMESTAMP = 1456000000000;
+
+        typedef std::chrono::steady_clock Clock;
+
+        static double
+        nsPerOperation(const Clock::time_point& start, size_t nOperations)
+        {
+            std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+            return elapsed.count() / nOperations;
+        }
+
+        static void
+        report(const char* label, size_t memory, double insert, double lookup, double erase)
+        {
+            std::cout << std::setw(12) << label
+                      << std::setw(14) << memory / 1024 << " KiB"
+                      << std::setw(10) << std::fixed << std::setprecision(1) << memory / double(N_USERS * N_PER_USER) << " B"
+                      << std::setw(12) << insert
+                      << std::setw(12) << lookup
+                      << std::setw(12) << erase << std::endl;
+        }
+
+        static void
+        runMap(const std::vector<name::Component>& users, const std::vector<std::vector<Name>>& names)
+        {
+            size_t before = g_allocated;
+            size_t nOperations = N_USERS * N_PER_USER;
+            std::map<name::Component, std::map<Name, int>>* table = new std::map<name::Component, std::map<Name, int>>;
+
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < N_PER_USER; i++) {
+                for (size_t u = 0; u < N_USERS; u++) {
+                    (*table)[users[u]][names[u][i]] = 0;
+                }
+            }
+            double insert = nsPerOperation(start, nOperations);
+            size_t memory = g_allocated - before;
+
+            size_t found = 0;
+            start = Clock::now();
+            for (size_t i = 0; i < N_PER_USER; i++) {
+                for (size_t u = 0; u < N_USERS; u++) {
+                    std::map<name::Component, std::map<Name, int>>::iterator it = table->find(users[u]);
+                    found += it->second.count(names[u][i]);
+                }
+            }
+            double lookup = nsPerOperation(start, nOperations);
+
+            start = Clock::now();
+            for (size_t i = 0; i < N_PER_USER; i++) {
+                for (size_t u = 0; u < N_USERS; u++) {
+                    table->find(users[u])->second.erase(names[u][i]);
+                }
+            }
+            double erase = nsPerOperation(start, nOperations);
+
+            delete table;
+            if (found != nOperations) {
+                std::cerr << "ERROR: std::map lost entries" << std::endl;
+            }
+            report("std::map", memory, insert, lookup, erase);
+        }
+
+        static void
+        runTable(const std::vector<name::Component>& users, const std::vector<std::vector<FetchKey>>& keys)
+        {
+            size_t before = g_allocated;
+            size_t nOperations = N_USERS * N_PER_USER;
+            PendingFetchTable* table = new PendingFetchTable;
+
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < N_PER_USER; i++) {
+                for (size_t u = 0; u < N_USERS; u++) {
+                    table->addUser(users[u]).insert(keys[u][i]) = 0;
+                }
+            }
+            double insert = nsPerOperation(start, nOperations);
+            size_t memory = g_allocated - before;
+
+            size_t found = 0;
+            start = Clock::now();
+            for (size_t i = 0; i < N_PER_USER; i++) {
+                for (size_t u = 0; u < N_USERS; u++) {
+                    found += table->getUser(users[u])->find(keys[u][i]) != 0;
+                }
+            }
+            double lookup = nsPerOperation(start, nOperations);
+
+            start = Clock::now();
+            for (size_t i = 0; i < N_PER_USER; i++) {
+                for (size_t u = 0; u < N_USERS; u++) {
+                    table->getUser(users[u])->erase(keys[u][i]);
+                }
+            }
+            double erase = nsPerOperation(start, nOperations);
+
+            delete table;
+            if (found != nOperations) {
+                std::cerr << "ERROR: PendingFetchTable lost entries" << std::endl;
+            }
+            report("hash table", memory, insert, lookup, erase);
+        }
+
+        static void
+        run()
+        {
+            std::vector<name::Component> users;
+            std::vector<std::vector<Name>> names(N_USERS);
+            std::vector<std::vector<FetchKey>> keys(N_USERS);
+            for (size_t u = 0; u < N_USERS; u++) {
+                users.push_back(name::Component("user" + std::to_string(u)));
+                Name prefix = Name("/org/openmhealth").append(users[u]).append("data/fitness/physical_activity/time_location");
+                for (size_t i = 0; i < N_PER_USER; i++) {
+                    uint64_t timestamp = FIRST_TIMESTAMP + i * 1000;
+                    names[u].push_back(Name(prefix).appendTimestamp(time::fromUnixTimestamp(time::milliseconds(timestamp))));
+                    keys[u].push_back(FetchKey(FETCH_DATAPOINT, timestamp));
+                }
+            }
+
+            std::cout << N_USERS * N_PER_USER << " outstanding entries, " << N_USERS << " users" << std::endl;
+            std::cout << std::setw(12) << ""
+                      << std::setw(18) << "memory"
+                      << std::setw(12) << "per entry"
+                      << std::setw(12) << "insert ns"
+                      << std::setw(12) << "lookup ns"
+                      << std::setw(12) << "erase ns" << std::endl;
+            runMap(users, names);
+            runTable(users, keys);
+        }
+
+    } // namespace dsu
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+    ndn::dsu::run();
+    return 0;
+}
@@ -0,0 +1,106 @@
+/**
+ * Reply signing throughput of SigningPool for RSA, ECDSA and SHA-256 digest signatures,
+ * signing on the I/O thread and on worker pools of different sizes.
+ *
+ * Creates the identities /ndnfit-dsu-benchmark/rsa and /ndnfit-dsu-benchmark/ecdsa in the
+ * user's KeyChain and deletes them when done.
+ */
+
+#include "signing-pool.hpp"
+
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace ndn {
+    namespace dsu {
+
+        static const size_t N_PACKETS = 2000;
+
+        static void
+        onSigned(boost::asio::io_service& ioService, size_t& nSigned)
+        {
+            if (++nSigned == N_PACKETS) {
+                ioService.stop();
+            }
+        }
+
+        static double
+        measure(KeyChain& keyChain, const security::SigningInfo& signingInfo, size_t nThreads)
+        {
+            boost::asio::io_service ioService;
+            boost::asio::io_service::work work(ioService);
+            SigningPool pool(ioService, keyChain, nThreads);
+            size_t nSigned = 0;
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < N_PACKETS; i++) {
+                shared_ptr<Data> data = make_shared<Data>(Name("/ndn/edu/ucla/remap/ndnfit/dsu/confirm").appendNumber(i));
+                data->setFreshnessPeriod(time::seconds(10));
+                pool.sign(data, signingInfo, bind(&onSigned, ref(ioService), ref(nSigned)));
+            }
+            if (nSigned < N_PACKETS) {
+                ioService.run();
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            return N_PACKETS / elapsed.count();
+        }
+
+        static void
+        run()
+        {
+            KeyChain keyChain;
+            Name rsaIdentity("/ndnfit-dsu-benchmark/rsa");
+            Name ecdsaIdentity("/ndnfit-dsu-benchmark/ecdsa");
+
+            struct Mode
+            {
+                const char* name;
+                security::SigningInfo signingInfo;
+            } modes[] = {
+                {"rsa", security::signingByCertificate(keyChain.createIdentity(rsaIdentity, RsaKeyParams()))},
+                {"ecdsa", security::signingByCertificate(keyChain.createIdentity(ecdsaIdentity, EcdsaKeyParams()))},
+                {"sha256", security::signingWithSha256()},
+            };
+
+            std::vector<size_t> threadCounts;
+            threadCounts.push_back(0);
+            threadCounts.push_back(1);
+            threadCounts.push_back(std::max(2u, std::thread::hardware_concurrency()));
+
+            std::cout << std::setw(8) << "mode";
+            for (size_t t = 0; t < threadCounts.size(); t++) {
+                std::cout << std::setw(14) << (threadCounts[t] == 0 ? std::string("inline")
+                                                                    : std::to_string(threadCounts[t]) + " threads");
+            }
+            std::cout << "   (packets/s)" << std::endl;
+
+            for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+                std::cout << std::setw(8) << modes[m].name;
+                for (size_t t = 0; t < threadCounts.size(); t++) {
+                    std::cout << std::setw(14) << std::fixed << std::setprecision(0)
+                              << measure(keyChain, modes[m].signingInfo, threadCounts[t]) << std::flush;
+                }
+                std::cout << std::endl;
+            }
+
+            keyChain.deleteIdentity(rsaIdentity);
+            keyChain.deleteIdentity(ecdsaIdentity);
+        }
+
+    } // namespace dsu
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+    try {
+        ndn::dsu::run();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
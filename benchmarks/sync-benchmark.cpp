@@ -0,0 +1,682 @@
+/**
+ * End-to-end sync benchmark: simulated phones, a fake repo and ndnfit-dsu on one host.
+ *
+ * Needs a running NFD. ndnfit-dsu-fake-repo and ndnfit-dsu are started as child processes
+ * (their output goes to --child-log), then this process plays --phones phones over the local
+ * NFD: each one registers /org/openmhealth/<user>/data/..., sends a register Interest to the
+ * DSU and serves a backlog of update_info, catalog and datapoint Data, ignoring a fraction
+ * --loss of the Interests it receives. A phone asks the DSU to confirm every datapoint it has
+ * served, again and again until the confirmation comes back.
+ *
+ * Reported: datapoints confirmed per second, time from registration until all datapoints of a
+ * user are confirmed, and CPU time of ndnfit-dsu per confirmed datapoint.
+ *
+ * Pass an empty --dsu or --fake-repo to use processes started by hand, e.g. under a profiler;
+ * --dsu-pid then tells whose CPU time to report.
+ */
+
+#include <ndn-cxx/face.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/util/random.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ndn {
+    namespace dsu {
+
+        static const std::string DATA_PREFIX = "/org/openmhealth";
+        static const std::string DATA_SUFFIX = "/data/fitness/physical_activity/time_location";
+        static const std::string REGISTER_PREFIX = "/ndn/edu/ucla/remap/ndnfit/dsu/register/org/openmhealth";
+        static const std::string CONFIRM_PREFIX = "/ndn/edu/ucla/remap/ndnfit/dsu/confirm";
+
+        static const name::Component CATALOG_COMP("catalog");
+        static const name::Component UPDATE_INFO_COMP("update_info");
+
+        // register and confirm Interests
+        static const time::milliseconds CONTROL_INTEREST_LIFETIME(2000);
+        static const time::seconds FRESHNESS_PERIOD(10);
+        static const time::seconds PROGRESS_INTERVAL(5);
+
+        struct SyncBenchmarkOptions
+        {
+            SyncBenchmarkOptions()
+            : nPhones(10)
+            , nUpdateInfos(10)
+            , nCatalogs(2)
+            , nDatapoints(50)
+            , loss(0)
+            , confirmDelayMs(500)
+            , registerInterval(0)
+            , dsuPath("build/ndnfit-dsu")
+            , dsuPid(0)
+            , fakeRepoPath("build/bin/ndnfit-dsu-fake-repo")
+            , repoPort(7376)
+            , repoLatencyMs(0)
+            , repoDelayMs(0)
+            , childLogPath("sync-benchmark.log")
+            , timeout(600)
+            , seed(1)
+            , isPerUser(false)
+            {
+            }
+
+            size_t nPhones;
+            // backlog of every phone: update_info packets, catalogs per update_info, datapoints per catalog
+            size_t nUpdateInfos;
+            size_t nCatalogs;
+            size_t nDatapoints;
+            double loss;
+            int confirmDelayMs;
+            int registerInterval;
+
+            std::string dsuPath;
+            std::vector<std::string> dsuArgs;
+            pid_t dsuPid;
+            std::string fakeRepoPath;
+            unsigned short repoPort;
+            int repoLatencyMs;
+            int repoDelayMs;
+            std::string childLogPath;
+
+            int timeout;
+            unsigned int seed;
+            bool isPerUser;
+        };
+
+        /// user plus system CPU time of a process, negative if it cannot be read
+        static time::nanoseconds
+        readCpuTime(pid_t pid)
+        {
+            std::ifstream stat(("/proc/" + boost::lexical_cast<std::string>(pid) + "/stat").c_str());
+            std::string line;
+            if (!std::getline(stat, line) || line.rfind(')') == std::string::npos) {
+                return time::nanoseconds(-1);
+            }
+            // skip the command name, it may contain spaces; utime and stime are fields 14 and 15
+            std::istringstream fields(line.substr(line.rfind(')') + 1));
+            std::string skipped;
+            for (int i = 3; i < 14; i++) {
+                fields >> skipped;
+            }
+            uint64_t utime = 0;
+            uint64_t stime = 0;
+            if (!(fields >> utime >> stime)) {
+                return time::nanoseconds(-1);
+            }
+            return time::nanoseconds((utime + stime) * 1000000000 / sysconf(_SC_CLK_TCK));
+        }
+
+        /**
+         * @brief A process started by the benchmark and terminated when it ends
+         */
+        class ChildProcess : noncopyable
+        {
+        public:
+            class Error : public std::runtime_error
+            {
+            public:
+                explicit
+                Error(const std::string& what)
+                : std::runtime_error(what)
+                {
+                }
+            };
+
+            ChildProcess(const std::string& path, const std::vector<std::string>& args, const std::string& logPath)
+            : m_path(path)
+            {
+                std::vector<char*> argv;
+                argv.push_back(const_cast<char*>(path.c_str()));
+                for (size_t i = 0; i < args.size(); i++) {
+                    argv.push_back(const_cast<char*>(args[i].c_str()));
+                }
+                argv.push_back(0);
+
+                int logFd = ::open(logPath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+                if (logFd < 0) {
+                    throw Error("cannot open " + logPath + ": " + std::strerror(errno));
+                }
+                m_pid = ::fork();
+                if (m_pid == 0) {
+                    ::dup2(logFd, STDOUT_FILENO);
+                    ::dup2(logFd, STDERR_FILENO);
+                    ::execv(path.c_str(), argv.data());
+                    std::cerr << "ERROR: cannot run " << path << ": " << std::strerror(errno) << std::endl;
+                    ::_exit(127);
+                }
+                ::close(logFd);
+                if (m_pid < 0) {
+                    throw Error("cannot fork: " + std::string(std::strerror(errno)));
+                }
+            }
+
+            ~ChildProcess()
+            {
+                if (isRunning()) {
+                    ::kill(m_pid, SIGTERM);
+                    ::waitpid(m_pid, 0, 0);
+                }
+            }
+
+            bool
+            isRunning()
+            {
+                if (m_pid > 0 && ::waitpid(m_pid, 0, WNOHANG) != 0) {
+                    m_pid = -1;
+                }
+                return m_pid > 0;
+            }
+
+            pid_t
+            getPid() const
+            {
+                return m_pid;
+            }
+
+            const std::string&
+            getPath() const
+            {
+                return m_path;
+            }
+
+        private:
+            std::string m_path;
+            pid_t m_pid;
+        };
+
+        class SyncBenchmark : noncopyable
+        {
+        public:
+            explicit
+            SyncBenchmark(const SyncBenchmarkOptions& options)
+            : m_options(options)
+            , m_face(m_ioService)
+            , m_scheduler(m_ioService)
+            , m_random(options.seed)
+            , m_loss(options.loss)
+            , m_nDatapointsPerPhone(options.nUpdateInfos * options.nCatalogs * options.nDatapoints)
+            , m_dsuPid(options.dsuPid)
+            , m_cpuAtStart(-1)
+            , m_nRegistered(0)
+            , m_nConfirmed(0)
+            , m_nCaughtUp(0)
+            , m_nPhoneInterests(0)
+            , m_nDropped(0)
+            , m_isDone(false)
+            {
+                // timestamps are in milliseconds in names and in microseconds in the content
+                m_baseTimestamp = time::toUnixTimestamp(time::system_clock::now()).count();
+
+                // a fresh name per run, so that NFD's content store does not answer for the phones
+                std::string run = boost::lexical_cast<std::string>(random::generateWord32() % 1000000);
+                m_phones.resize(options.nPhones);
+                for (size_t i = 0; i < m_phones.size(); i++) {
+                    Phone& phone = m_phones[i];
+                    phone.user = name::Component("bench" + run + "-" + boost::lexical_cast<std::string>(i));
+                    phone.dataPrefix = Name(DATA_PREFIX).append(phone.user).append(Name(DATA_SUFFIX));
+                    phone.datapoints.assign(m_nDatapointsPerPhone, NOT_SERVED);
+                    phone.nConfirmed = 0;
+                    phone.isRegistered = false;
+                    phone.isCaughtUp = false;
+                }
+            }
+
+            void
+            run()
+            {
+                if (!m_options.fakeRepoPath.empty()) {
+                    std::vector<std::string> args;
+                    args.push_back("--port");
+                    args.push_back(boost::lexical_cast<std::string>(m_options.repoPort));
+                    args.push_back("--latency-ms");
+                    args.push_back(boost::lexical_cast<std::string>(m_options.repoLatencyMs));
+                    args.push_back("--delay-ms");
+                    args.push_back(boost::lexical_cast<std::string>(m_options.repoDelayMs));
+                    m_fakeRepo.reset(new ChildProcess(m_options.fakeRepoPath, args, m_options.childLogPath));
+                }
+                if (!m_options.dsuPath.empty()) {
+                    std::vector<std::string> args;
+                    args.push_back("--repo");
+                    args.push_back("127.0.0.1:" + boost::lexical_cast<std::string>(m_options.repoPort));
+                    // every run starts from scratch
+                    args.push_back("--journal");
+                    args.push_back("");
+                    args.insert(args.end(), m_options.dsuArgs.begin(), m_options.dsuArgs.end());
+                    m_dsu.reset(new ChildProcess(m_options.dsuPath, args, m_options.childLogPath));
+                    m_dsuPid = m_dsu->getPid();
+                }
+
+                std::cout << m_phones.size() << " phones, " << m_nDatapointsPerPhone << " datapoints each, "
+                          << m_options.loss * 100 << "% loss, repo latency " << m_options.repoLatencyMs << " ms"
+                          << std::endl;
+
+                for (size_t i = 0; i < m_phones.size(); i++) {
+                    m_face.setInterestFilter(m_phones[i].dataPrefix,
+                                             bind(&SyncBenchmark::onPhoneInterest, this, i, _2),
+                                             bind(&SyncBenchmark::sendRegister, this, i),
+                                             bind(&SyncBenchmark::onPrefixRegisterFailed, this, _1, _2));
+                }
+                m_startedAt = time::steady_clock::now();
+                m_scheduler.scheduleEvent(time::seconds(m_options.timeout), bind(&SyncBenchmark::finish, this));
+                m_scheduler.scheduleEvent(PROGRESS_INTERVAL, bind(&SyncBenchmark::onProgressTimer, this));
+                m_ioService.run();
+                if (!m_error.empty()) {
+                    throw std::runtime_error(m_error);
+                }
+            }
+
+        private:
+            enum DatapointState {
+                NOT_SERVED,
+                SERVED,
+                CONFIRMED
+            };
+
+            struct Phone
+            {
+                name::Component user;
+                Name dataPrefix;
+                std::vector<uint8_t> datapoints;
+                size_t nConfirmed;
+                bool isRegistered;
+                bool isCaughtUp;
+                // the register Interest the DSU answered was sent at
+                time::steady_clock::TimePoint registeredAt;
+                time::steady_clock::TimePoint caughtUpAt;
+            };
+
+            void
+            onPrefixRegisterFailed(const Name& prefix, const std::string& reason)
+            {
+                fail("cannot register " + prefix.toUri() + " with NFD: " + reason);
+            }
+
+            void
+            sendRegister(size_t phoneIndex)
+            {
+                Phone& phone = m_phones[phoneIndex];
+                Interest interest(Name(REGISTER_PREFIX).append(phone.user));
+                interest.setInterestLifetime(CONTROL_INTEREST_LIFETIME);
+                interest.setMustBeFresh(true);
+                if (!phone.isRegistered) {
+                    phone.registeredAt = time::steady_clock::now();
+                }
+                m_face.expressInterest(interest,
+                                       bind(&SyncBenchmark::onRegisterData, this, phoneIndex),
+                                       bind(&SyncBenchmark::sendRegister, this, phoneIndex));
+            }
+
+            void
+            onRegisterData(size_t phoneIndex)
+            {
+                Phone& phone = m_phones[phoneIndex];
+                if (phone.isRegistered) {
+                    return;
+                }
+                phone.isRegistered = true;
+                if (m_nRegistered++ == 0 && m_dsuPid > 0) {
+                    // the DSU is up, leave its startup out of the CPU time
+                    m_cpuAtStart = readCpuTime(m_dsuPid);
+                }
+                if (m_options.registerInterval > 0) {
+                    scheduleRegister(phoneIndex);
+                }
+            }
+
+            // a phone coming back online registers again; in a cluster, that is what loads a user
+            // handed over to another instance there
+            void
+            scheduleRegister(size_t phoneIndex)
+            {
+                m_scheduler.scheduleEvent(time::seconds(m_options.registerInterval),
+                                          bind(&SyncBenchmark::registerAgain, this, phoneIndex));
+            }
+
+            void
+            registerAgain(size_t phoneIndex)
+            {
+                if (m_isDone) {
+                    return;
+                }
+                sendRegister(phoneIndex);
+                scheduleRegister(phoneIndex);
+            }
+
+            void
+            onPhoneInterest(size_t phoneIndex, const Interest& interest)
+            {
+                m_nPhoneInterests++;
+                if (m_loss(m_random)) {
+                    m_nDropped++;
+                    return;
+                }
+
+                const Phone& phone = m_phones[phoneIndex];
+                const Name& name = interest.getName();
+                size_t kindIndex = phone.dataPrefix.size();
+                std::ostringstream content;
+                try {
+                    if (name.size() > kindIndex + 1 && name.get(kindIndex) == UPDATE_INFO_COMP) {
+                        uint64_t seqNo = name.get(kindIndex + 1).toSequenceNumber();
+                        // past the end of the backlog, the phone has not produced it yet
+                        if (seqNo < 1 || seqNo > m_options.nUpdateInfos) {
+                            return;
+                        }
+                        content << "[";
+                        for (size_t i = 0; i < m_options.nCatalogs; i++) {
+                            uint64_t catalog = (seqNo - 1) * m_options.nCatalogs + i;
+                            content << (i == 0 ? "" : ",") << "{\"timepoint\":" << toTimepoint(catalog)
+                                    << ",\"version\":1}";
+                        }
+                        content << "]";
+                    } else if (name.size() > kindIndex + 1 && name.get(kindIndex) == CATALOG_COMP) {
+                        uint64_t catalog = getIndex(name.get(kindIndex + 1));
+                        if (catalog >= m_options.nUpdateInfos * m_options.nCatalogs) {
+                            return;
+                        }
+                        content << "[";
+                        for (size_t i = 0; i < m_options.nDatapoints; i++) {
+                            content << (i == 0 ? "" : ",") << toTimepoint(catalog * m_options.nDatapoints + i);
+                        }
+                        content << "]";
+                    } else if (name.size() > kindIndex) {
+                        uint64_t datapoint = getIndex(name.get(kindIndex));
+                        if (datapoint >= m_nDatapointsPerPhone) {
+                            return;
+                        }
+                        content << "{\"timepoint\":" << toTimepoint(datapoint)
+                                << ",\"lat\":34.0689,\"lng\":-118.4452}";
+                        onDatapointServed(phoneIndex, datapoint);
+                    } else {
+                        return;
+                    }
+                }
+                catch (const tlv::Error&) {
+                    return;
+                }
+
+                std::string json = content.str();
+                Data data(name);
+                data.setContent(reinterpret_cast<const uint8_t*>(json.data()), json.size());
+                data.setFreshnessPeriod(FRESHNESS_PERIOD);
+                m_keyChain.sign(data, security::signingWithSha256());
+                m_face.put(data);
+            }
+
+            uint64_t
+            toTimepoint(uint64_t index) const
+            {
+                return (m_baseTimestamp + index) * 1000;
+            }
+
+            // inverse of toTimepoint, for a timestamp name component
+            uint64_t
+            getIndex(const name::Component& component) const
+            {
+                return time::toUnixTimestamp(component.toTimestamp()).count() - m_baseTimestamp;
+            }
+
+            void
+            onDatapointServed(size_t phoneIndex, uint64_t datapoint)
+            {
+                uint8_t& state = m_phones[phoneIndex].datapoints[datapoint];
+                if (state == NOT_SERVED) {
+                    state = SERVED;
+                    scheduleConfirm(phoneIndex, datapoint);
+                }
+            }
+
+            void
+            scheduleConfirm(size_t phoneIndex, uint64_t datapoint)
+            {
+                m_scheduler.scheduleEvent(time::milliseconds(m_options.confirmDelayMs),
+                                          bind(&SyncBenchmark::sendConfirm, this, phoneIndex, datapoint));
+            }
+
+            void
+            sendConfirm(size_t phoneIndex, uint64_t datapoint)
+            {
+                if (m_isDone) {
+                    return;
+                }
+                const Phone& phone = m_phones[phoneIndex];
+                Name name = Name(CONFIRM_PREFIX).append(phone.dataPrefix)
+                            .appendTimestamp(time::fromUnixTimestamp(time::milliseconds(m_baseTimestamp + datapoint)));
+                Interest interest(name);
+                interest.setInterestLifetime(CONTROL_INTEREST_LIFETIME);
+                m_face.expressInterest(interest,
+                                       bind(&SyncBenchmark::onConfirmData, this, phoneIndex, datapoint),
+                                       bind(&SyncBenchmark::scheduleConfirm, this, phoneIndex, datapoint));
+            }
+
+            void
+            onConfirmData(size_t phoneIndex, uint64_t datapoint)
+            {
+                Phone& phone = m_phones[phoneIndex];
+                if (phone.datapoints[datapoint] == CONFIRMED) {
+                    return;
+                }
+                phone.datapoints[datapoint] = CONFIRMED;
+                m_nConfirmed++;
+                if (++phone.nConfirmed == m_nDatapointsPerPhone) {
+                    phone.isCaughtUp = true;
+                    phone.caughtUpAt = time::steady_clock::now();
+                    if (++m_nCaughtUp == m_phones.size()) {
+                        finish();
+                    }
+                }
+            }
+
+            void
+            onProgressTimer()
+            {
+                ChildProcess* children[] = {m_fakeRepo.get(), m_dsu.get()};
+                for (size_t i = 0; i < 2; i++) {
+                    if (children[i] != nullptr && !children[i]->isRunning()) {
+                        fail(children[i]->getPath() + " exited, see " + m_options.childLogPath);
+                        return;
+                    }
+                }
+                std::cout << std::fixed << std::setprecision(1) << getElapsedSeconds(m_startedAt) << " s: "
+                          << m_nRegistered << " registered, " << m_nConfirmed << " of "
+                          << m_nDatapointsPerPhone * m_phones.size() << " datapoints confirmed, "
+                          << m_nCaughtUp << " users caught up" << std::endl;
+                m_scheduler.scheduleEvent(PROGRESS_INTERVAL, bind(&SyncBenchmark::onProgressTimer, this));
+            }
+
+            void
+            finish()
+            {
+                if (m_isDone) {
+                    return;
+                }
+                m_isDone = true;
+                report();
+                m_ioService.stop();
+            }
+
+            void
+            fail(const std::string& error)
+            {
+                m_error = error;
+                m_isDone = true;
+                m_ioService.stop();
+            }
+
+            void
+            report()
+            {
+                double elapsed = getElapsedSeconds(m_startedAt);
+                std::cout << std::fixed << std::setprecision(2) << std::endl
+                          << "Synced " << m_nConfirmed << " of " << m_nDatapointsPerPhone * m_phones.size()
+                          << " datapoints in " << elapsed << " s: " << m_nConfirmed / elapsed
+                          << " datapoints/s" << std::endl;
+
+                std::vector<double> catchUpTimes;
+                for (size_t i = 0; i < m_phones.size(); i++) {
+                    const Phone& phone = m_phones[i];
+                    if (phone.isCaughtUp) {
+                        catchUpTimes.push_back(time::duration_cast<time::milliseconds>(phone.caughtUpAt -
+                                                                                      phone.registeredAt).count() / 1000.0);
+                    }
+                    if (m_options.isPerUser) {
+                        std::cout << "  " << phone.user.toUri() << ": " << phone.nConfirmed << " confirmed";
+                        if (phone.isCaughtUp) {
+                            std::cout << ", caught up in " << catchUpTimes.back() << " s";
+                        }
+                        std::cout << std::endl;
+                    }
+                }
+                if (!catchUpTimes.empty()) {
+                    std::sort(catchUpTimes.begin(), catchUpTimes.end());
+                    std::cout << "Time to catch up per user (s): min " << catchUpTimes.front()
+                              << ", median " << catchUpTimes[catchUpTimes.size() / 2]
+                              << ", p95 " << catchUpTimes[catchUpTimes.size() * 95 / 100]
+                              << ", max " << catchUpTimes.back() << std::endl;
+                }
+                if (catchUpTimes.size() < m_phones.size()) {
+                    std::cout << m_phones.size() - catchUpTimes.size() << " users not caught up after "
+                              << elapsed << " s" << std::endl;
+                }
+                std::cout << "Phone Interests: " << m_nPhoneInterests << " received, " << m_nDropped
+                          << " dropped" << std::endl;
+
+                time::nanoseconds cpuTime = m_dsuPid > 0 ? readCpuTime(m_dsuPid) : time::nanoseconds(-1);
+                if (cpuTime.count() >= 0 && m_cpuAtStart.count() >= 0) {
+                    double cpuSeconds = (cpuTime - m_cpuAtStart).count() / 1e9;
+                    std::cout << "ndnfit-dsu CPU: " << cpuSeconds << " s";
+                    if (m_nConfirmed > 0) {
+                        std::cout << ", " << cpuSeconds * 1e6 / m_nConfirmed << " us per synced datapoint";
+                    }
+                    std::cout << std::endl;
+                }
+            }
+
+            static double
+            getElapsedSeconds(const time::steady_clock::TimePoint& since)
+            {
+                return time::duration_cast<time::milliseconds>(time::steady_clock::now() - since).count() / 1000.0;
+            }
+
+        private:
+            SyncBenchmarkOptions m_options;
+            boost::asio::io_service m_ioService;
+            Face m_face;
+            Scheduler m_scheduler;
+            KeyChain m_keyChain;
+            std::mt19937 m_random;
+            std::bernoulli_distribution m_loss;
+
+            std::vector<Phone> m_phones;
+            uint64_t m_nDatapointsPerPhone;
+            uint64_t m_baseTimestamp;
+
+            unique_ptr<ChildProcess> m_fakeRepo;
+            unique_ptr<ChildProcess> m_dsu;
+            pid_t m_dsuPid;
+            time::nanoseconds m_cpuAtStart;
+
+            time::steady_clock::TimePoint m_startedAt;
+            size_t m_nRegistered;
+            uint64_t m_nConfirmed;
+            size_t m_nCaughtUp;
+            uint64_t m_nPhoneInterests;
+            uint64_t m_nDropped;
+            bool m_isDone;
+            std::string m_error;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+    namespace po = boost::program_options;
+
+    ndn::dsu::SyncBenchmarkOptions options;
+    po::options_description description("Usage: sync-benchmark [options]");
+    description.add_options()
+    ("help,h", "print this help message and exit")
+    ("phones", po::value<size_t>(&options.nPhones)->default_value(options.nPhones),
+     "number of simulated phones")
+    ("update-infos", po::value<size_t>(&options.nUpdateInfos)->default_value(options.nUpdateInfos),
+     "update_info packets in the backlog of every phone")
+    ("catalogs", po::value<size_t>(&options.nCatalogs)->default_value(options.nCatalogs),
+     "catalogs listed in every update_info")
+    ("datapoints", po::value<size_t>(&options.nDatapoints)->default_value(options.nDatapoints),
+     "datapoints listed in every catalog")
+    ("loss", po::value<double>(&options.loss)->default_value(options.loss),
+     "fraction of the Interests to phones that are ignored")
+    ("confirm-delay-ms", po::value<int>(&options.confirmDelayMs)->default_value(options.confirmDelayMs),
+     "milliseconds from serving a datapoint, or a confirm timeout, to the next confirm Interest")
+    ("register-interval", po::value<int>(&options.registerInterval)->default_value(options.registerInterval),
+     "seconds between the register Interests of a registered phone, more than the 10 s the DSU's "
+     "reply stays fresh; 0 registers once")
+    ("dsu", po::value<std::string>(&options.dsuPath)->default_value(options.dsuPath),
+     "ndnfit-dsu executable, empty to use one that is already running")
+    ("dsu-arg", po::value<std::vector<std::string>>(&options.dsuArgs)->multitoken(),
+     "extra argument for ndnfit-dsu, may be given several times")
+    ("dsu-pid", po::value<pid_t>(&options.dsuPid),
+     "process whose CPU time is reported, when --dsu is empty")
+    ("fake-repo", po::value<std::string>(&options.fakeRepoPath)->default_value(options.fakeRepoPath),
+     "ndnfit-dsu-fake-repo executable, empty to use a repo that is already running")
+    ("repo-port", po::value<unsigned short>(&options.repoPort)->default_value(options.repoPort),
+     "TCP port of the repo")
+    ("repo-latency-ms", po::value<int>(&options.repoLatencyMs)->default_value(options.repoLatencyMs),
+     "milliseconds before the fake repo replies")
+    ("repo-delay-ms", po::value<int>(&options.repoDelayMs)->default_value(options.repoDelayMs),
+     "milliseconds the fake repo spends on every packet")
+    ("child-log", po::value<std::string>(&options.childLogPath)->default_value(options.childLogPath),
+     "file receiving the output of the child processes")
+    ("timeout", po::value<int>(&options.timeout)->default_value(options.timeout),
+     "seconds before giving up on the users that have not caught up")
+    ("seed", po::value<unsigned int>(&options.seed)->default_value(options.seed),
+     "seed of the loss simulation")
+    ("per-user", po::bool_switch(&options.isPerUser),
+     "report every user");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, description), vm);
+        po::notify(vm);
+    }
+    catch (const po::error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl << description << std::endl;
+        return 2;
+    }
+    if (vm.count("help") > 0) {
+        std::cout << description << std::endl;
+        return 0;
+    }
+    if (options.loss < 0 || options.loss >= 1) {
+        std::cerr << "ERROR: --loss must be in [0, 1)" << std::endl;
+        return 2;
+    }
+
+    try {
+        ndn::dsu::SyncBenchmark benchmark(options);
+        benchmark.run();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * Signature verification throughput of VerificationPool for datapoints signed with RSA and
+ * ECDSA keys, verifying on the I/O thread and on worker pools of different sizes, reported as
+ * datapoints per second and per second per core.
+ *
+ * Creates the identities /ndnfit-dsu-benchmark/verify-rsa and /ndnfit-dsu-benchmark/verify-ecdsa
+ * in the user's KeyChain and deletes them when done.
+ */
+
+#include "verification-pool.hpp"
+
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace ndn {
+    namespace dsu {
+
+        static const size_t N_PACKETS = 4000;
+        // datapoints of one catalog verified together
+        static const size_t BATCH_SIZE = 64;
+        // about the size of a time_location datapoint
+        static const size_t CONTENT_SIZE = 200;
+
+        static void
+        onVerified(const shared_ptr<VerificationPool::Batch>& batch, boost::asio::io_service& ioService,
+                   size_t& nVerified, size_t& nInvalid)
+        {
+            for (size_t i = 0; i < batch->size(); i++) {
+                nInvalid += (*batch)[i].isValid ? 0 : 1;
+            }
+            nVerified += batch->size();
+            if (nVerified == N_PACKETS) {
+                ioService.stop();
+            }
+        }
+
+        // datapoints as fetched from a phone, decoded from their wire encoding
+        static std::vector<shared_ptr<const Data>>
+        makeDatapoints(KeyChain& keyChain, const Name& certName)
+        {
+            std::vector<uint8_t> content(CONTENT_SIZE, 'x');
+            std::vector<shared_ptr<const Data>> datapoints;
+            for (size_t i = 0; i < N_PACKETS; i++) {
+                Data data(Name("/org/openmhealth/benchmark/data/fitness/physical_activity/time_location")
+                          .appendTimestamp(time::fromUnixTimestamp(time::milliseconds(i))));
+                data.setContent(&content[0], content.size());
+                keyChain.sign(data, security::signingByCertificate(certName));
+                datapoints.push_back(make_shared<const Data>(data.wireEncode()));
+            }
+            return datapoints;
+        }
+
+        static double
+        measure(const std::vector<shared_ptr<const Data>>& datapoints, const shared_ptr<const PublicKey>& key,
+                size_t nThreads)
+        {
+            boost::asio::io_service ioService;
+            boost::asio::io_service::work work(ioService);
+            VerificationPool pool(ioService, nThreads);
+            size_t nVerified = 0;
+            size_t nInvalid = 0;
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < datapoints.size(); i += BATCH_SIZE) {
+                shared_ptr<VerificationPool::Batch> batch = make_shared<VerificationPool::Batch>();
+                for (size_t j = i; j < std::min(i + BATCH_SIZE, datapoints.size()); j++) {
+                    VerificationPool::Packet packet = {datapoints[j], false, j};
+                    batch->push_back(packet);
+                }
+                pool.verify(batch, key, bind(&onVerified, _1, ref(ioService), ref(nVerified), ref(nInvalid)));
+            }
+            if (nVerified < N_PACKETS) {
+                ioService.run();
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (nInvalid > 0) {
+                throw std::runtime_error(std::to_string(nInvalid) + " signatures did not verify");
+            }
+            return N_PACKETS / elapsed.count();
+        }
+
+        static void
+        run()
+        {
+            KeyChain keyChain;
+            Name rsaIdentity("/ndnfit-dsu-benchmark/verify-rsa");
+            Name ecdsaIdentity("/ndnfit-dsu-benchmark/verify-ecdsa");
+
+            struct Mode
+            {
+                const char* name;
+                Name certName;
+            } modes[] = {
+                {"rsa", keyChain.createIdentity(rsaIdentity, RsaKeyParams())},
+                {"ecdsa", keyChain.createIdentity(ecdsaIdentity, EcdsaKeyParams())},
+            };
+
+            std::vector<size_t> threadCounts;
+            threadCounts.push_back(0);
+            threadCounts.push_back(1);
+            threadCounts.push_back(2);
+            threadCounts.push_back(std::max(4u, std::thread::hardware_concurrency()));
+
+            std::cout << std::setw(8) << "mode" << std::setw(12) << "threads"
+                      << std::setw(14) << "packets/s" << std::setw(16) << "packets/s/core" << std::endl;
+            for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+                std::vector<shared_ptr<const Data>> datapoints = makeDatapoints(keyChain, modes[m].certName);
+                shared_ptr<const PublicKey> key =
+                    make_shared<PublicKey>(keyChain.getCertificate(modes[m].certName)->getPublicKeyInfo());
+                for (size_t t = 0; t < threadCounts.size(); t++) {
+                    double rate = measure(datapoints, key, threadCounts[t]);
+                    std::cout << std::setw(8) << modes[m].name
+                              << std::setw(12) << (threadCounts[t] == 0 ? std::string("inline")
+                                                                        : std::to_string(threadCounts[t]))
+                              << std::setw(14) << std::fixed << std::setprecision(0) << rate
+                              << std::setw(16) << rate / std::max<size_t>(1, threadCounts[t]) << std::endl;
+                }
+            }
+
+            keyChain.deleteIdentity(rsaIdentity);
+            keyChain.deleteIdentity(ecdsaIdentity);
+        }
+
+    } // namespace dsu
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+    try {
+        ndn::dsu::run();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -3,391 +3,431 @@
 #include <ndn-cxx/face.hpp>
 #include <ndn-cxx/util/scheduler.hpp>
 #include <ndn-cxx/util/time.hpp>
-#include <ndn-cxx/transport/tcp-transport.hpp>
-#include <rapidjson/document.h>		// rapidjson's DOM-style API
-#include <rapidjson/prettywriter.h>	// for stringify JSON
-#include <rapidjson/filestream.h>	// wrapper of C stream for prettywriter as output
+#include <ndn-cxx/util/io.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/security/validator-null.hpp>
+#include <ndn-cxx/util/segment-fetcher.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <algorithm>
 #include <cstdio>
+#include <exception>
+#include <fstream>
+#include <set>
+#include <thread>
+#include "consistent-hash-ring.hpp"
+#include "content-parser.hpp"
+#include "data-verifier.hpp"
+#include "face-endpoint.hpp"
+#include "fetch-name-cache.hpp"
+#include "interest-scheduler.hpp"
+#include "logger.hpp"
+#include "mailbox.hpp"
+#include "metrics.hpp"
+#include "outstanding-interest-table.hpp"
+#include "pending-fetch-table.hpp"
+#include "random-word.hpp"
+#include "repo-client.hpp"
+#include "repo-query-engine.hpp"
+#include "rtt-estimator.hpp"
+#include "segment-pipeline.hpp"
+#include "signing-pool.hpp"
+#include "stored-name-index.hpp"
+#include "sync-journal.hpp"
+#include "update-info-window.hpp"
+#include "user-activity-list.hpp"
+#include "user-spill-store.hpp"
 
 namespace ndn {
     namespace dsu {
         
-        static const std::string COMMON_PREFIX = "/org/openmhealth";
-        static const std::string UPDATE_INFO_SUFFIX = "/data/fitness/physical_activity/time_location/update_info";
-        static const std::string CATALOG_SUFFIX = "/data/fitness/physical_activity/time_location/catalog";
-        static const std::string DATA_SUFFIX = "/data/fitness/physical_activity/time_location";
+        DSU_LOG_INIT(DSUsync);
+        // content of every packet fetched from phones, only logged at trace level
+        static LogModule g_payloadLog("Payload");
+        
+        // parsed once at startup, fetched names are encoded from them by FetchNameCache
+        static const Name COMMON_PREFIX("/org/openmhealth");
+        static const Name DATA_SUFFIX("/data/fitness/physical_activity/time_location");
         
         static const name::Component CATALOG_COMP("catalog");
         static const name::Component UPDATA_INFO_COMP("update_info");
         
-        static const int INTEREST_TIME_OUT_SECONDS = 60;
+        // Interest lifetimes follow each phone's RTO, between these bounds
+        static const int RTO_INITIAL_MILLISECONDS = 1000;
+        static const int RTO_MIN_MILLISECONDS = 200;
+        static const int RTO_MAX_MILLISECONDS = 60000;
+        
+        // wait before retransmitting, doubled on every backoff of the phone's RTO
+        static const int RETRY_DELAY_BASE_MILLISECONDS = 100;
+        static const int RETRY_DELAY_MAX_SECONDS = 300;
+        // an object rejected for want of a certificate is fetched again once the verifier,
+        // which holds an unavailable certificate off for a minute, asks for it again
+        static const int UNVERIFIED_RETRY_DELAY_SECONDS = 60;
+        // an object the full repo connections refused is fetched again after this, and held
+        // back from then on until they have room
+        static const int REFUSED_RETRY_DELAY_SECONDS = 1;
+        
+        // number of update_info Interests kept in flight per user
+        static const double UPDATE_INFO_INITIAL_WINDOW = 2;
+        static const double UPDATE_INFO_MAX_WINDOW = 32;
+        
+        // Interests to phones: in flight over all users, and per-user congestion window
+        static const size_t INTEREST_MAX_IN_FLIGHT = 512;
+        static const double USER_INITIAL_WINDOW = 4;
+        static const double USER_MAX_WINDOW = 64;
+        // Interests a user may express per round-robin turn
+        static const size_t USER_QUANTUM = 4;
+        
+        // a re-registered user's idle fetches are expressed again while fewer than this many of
+        // the user's Interests are queued, checking again after the interval
+        static const size_t RESUME_BURST = 64;
+        static const int RESUME_INTERVAL_MILLISECONDS = 100;
+        
+        // segment Interests in flight per segmented update_info or catalog, and retries per segment
+        static const size_t SEGMENT_WINDOW = 8;
+        static const int SEGMENT_MAX_RETRIES = 3;
+        
+        // existence checks against the repo
+        static const size_t REPO_QUERY_MAX_IN_FLIGHT = 64;
+        static const int REPO_QUERY_TIME_OUT_MILLISECONDS = 2000;
+        static const int REPO_QUERY_MAX_RETRIES = 2;
+        
+        // packets remembered as stored in the repo, to answer confirm Interests directly
+        static const size_t STORED_NAME_INDEX_CAPACITY = 262144;
+        
+        // how often journal pages are pushed to disk
+        static const int JOURNAL_FLUSH_INTERVAL_SECONDS = 1;
+        
+        // expired pending fetches and idle users are looked for this often
+        static const int MEMORY_SWEEP_INTERVAL_SECONDS = 10;
+        // users heard from more recently are not evicted to meet the memory budget
+        static const int EVICTION_MIN_IDLE_SECONDS = 60;
+        // rough heap cost of a node in the per-user maps and lists
+        static const size_t NODE_OVERHEAD_BYTES = 48;
+        
+        // fetched packets must be signed by a key under /org/openmhealth/<user_id>
+        static const size_t USER_KEY_PREFIX_LENGTH = 3;
         
         static const std::string CONFIRM_PREFIX = "/ndn/edu/ucla/remap/ndnfit/dsu/confirm/org/openmhealth";
         static const std::string REGISTER_PREFIX = "/ndn/edu/ucla/remap/ndnfit/dsu/register/org/openmhealth";
         static const std::string CONFIRM_PREFIX_FOR_REPLY = "/ndn/edu/ucla/remap/ndnfit/dsu/confirm";
+        // position of the user_id in the names of confirm and register Interests
+        static const size_t INTEREST_USER_INDEX = 9;
+        // metrics as JSON, only reachable from the local host
+        static const std::string STATUS_PREFIX = "/localhost/ndnfit-dsu/status";
+        // users listed in a status reply, busiest first, to keep it within one packet
+        static const size_t STATUS_MAX_USERS = 50;
+        // instances of a cluster reach each other under <CLUSTER_PREFIX>/<instance name>/...
+        static const std::string CLUSTER_PREFIX = "/ndn/edu/ucla/remap/ndnfit/dsu/cluster";
+        // .../request/<register or confirm Interest name>: forwarded to the owner of the user
+        static const name::Component CLUSTER_REQUEST_COMP("request");
+        // .../handoff/<from instance>/<user_id>/<version>: fetch the state of the user from there
+        static const name::Component CLUSTER_HANDOFF_COMP("handoff");
+        // .../state/<user_id>/<segment>: the spilled state of a user handed over
+        static const name::Component CLUSTER_STATE_COMP("state");
+        // how often the member list is read again
+        static const int CLUSTER_POLL_INTERVAL_SECONDS = 5;
+        static const int CLUSTER_INTEREST_LIFETIME_MILLISECONDS = 4000;
+        static const int HANDOFF_MAX_RETRIES = 5;
+        // a state handed over waits this long for the new owner to fetch it, then goes back to the spill directory
+        static const int HANDOFF_STATE_LIFETIME_SECONDS = 60;
+        static const size_t HANDOFF_SEGMENT_SIZE = 4096;
+        // identity created on first use when replies are signed with ECDSA
+        static const std::string ECDSA_IDENTITY = "/ndn/edu/ucla/remap/ndnfit/dsu";
         
-        class DSUsync : noncopyable
+        struct Options
+        {
+            Options()
+            : signing("default")
+            , digestConfirmations(false)
+            , nSigningThreads(2)
+            , verifySignatures(false)
+            , nVerificationThreads(2)
+            , journalPath("ndnfit-dsu.journal")
+            , compactionInterval(600)
+            , repoEndpoints(1, "localhost:7376")
+            , nRepoConnections(2)
+            , repoDispatch("round-robin")
+            , repoQueueLimit(1024)
+            , repoBatchBytes(65536)
+            , repoBatchDelay(2)
+            , metricsInterval(60)
+            , memoryBudget(512)
+            , userIdleTimeout(86400)
+            , pendingTtl(7 * 86400)
+            , spillDirectory("ndnfit-dsu.spill")
+            , nShards(0)
+            , clusterMembersPath("ndnfit-dsu.members")
+            {
+            }
+            
+            // "default": default identity of the KeyChain, "ecdsa": ECDSA_IDENTITY
+            std::string signing;
+            // sign confirmations with a SHA-256 digest only
+            bool digestConfirmations;
+            // 0 signs on the io_service thread
+            size_t nSigningThreads;
+            // check signatures of fetched packets, only storing those signed by their user's key
+            bool verifySignatures;
+            // 0 verifies on the io_service thread
+            size_t nVerificationThreads;
+            // certificate the users' certificates must be signed by, empty accepts any
+            std::string trustAnchorPath;
+            // empty disables the journal
+            std::string journalPath;
+            // seconds between journal compactions
+            int compactionInterval;
+            // "host:port" of each repo
+            std::vector<std::string> repoEndpoints;
+            // connections opened to every repo
+            size_t nRepoConnections;
+            // "round-robin" or "least-loaded"
+            std::string repoDispatch;
+            // packets queued per connection before fetching pauses
+            size_t repoQueueLimit;
+            // packets written to a repo connection at once, up to this many bytes
+            size_t repoBatchBytes;
+            // milliseconds a packet waits for others to share its write, 0 writes at once
+            int repoBatchDelay;
+            // metrics are written there periodically, empty disables it
+            std::string metricsPath;
+            // seconds between metrics dumps
+            int metricsInterval;
+            // megabytes of per-user sync state kept in memory, 0 is unbounded
+            size_t memoryBudget;
+            // seconds without hearing from a phone before its user is evicted, 0 never
+            int userIdleTimeout;
+            // seconds a catalog or datapoint fetch stays pending without completing, 0 forever
+            int pendingTtl;
+            // evicted users are written there and reloaded on their next register Interest;
+            // empty drops them, they sync again from the start
+            std::string spillDirectory;
+            // engines running on threads of their own, users are split among them;
+            // 0 runs a single engine on the Face's thread
+            size_t nShards;
+            // name of this instance in the cluster; empty runs alone, owning every user
+            std::string clusterName;
+            // names of the instances of the cluster, one per line, read again when it changes
+            std::string clusterMembersPath;
+        };
+        
+        static std::vector<RepoClient::Endpoint>
+        parseRepoEndpoints(const std::vector<std::string>& endpoints)
+        {
+            std::vector<RepoClient::Endpoint> result;
+            for (size_t i = 0; i < endpoints.size(); i++) {
+                result.push_back(RepoClient::parseEndpoint(endpoints[i]));
+            }
+            return result;
+        }
+        
+        static RepoClient::DispatchPolicy
+        parseRepoDispatch(const std::string& policy)
+        {
+            if (policy == "round-robin") {
+                return RepoClient::ROUND_ROBIN;
+            } else if (policy == "least-loaded") {
+                return RepoClient::LEAST_LOADED;
+            }
+            throw std::invalid_argument("unknown repo dispatch policy " + policy);
+        }
+        
+        // keeps the (timepoint, version) pairs listed in an update_info packet
+        class CatalogEntryCollector : public ContentVisitor
         {
         public:
-            DSUsync()
-            : m_face(m_ioService) // Create face with io_service object
-            , tcp_connect_repo_for_put_data("localhost", "7376")
-            , tcp_connect_repo_for_confirmation("localhost", "7376")
-            , m_scheduler(m_ioService)
+            virtual void
+            onCatalogEntry(uint64_t timepoint, uint64_t version)
             {
-                tcp_connect_repo_for_put_data.connect(m_ioService, bind(&DSUsync::putinDataCallback, this, _1));
-                tcp_connect_repo_for_confirmation.connect(m_ioService, bind(&DSUsync::confirmationCallback, this, _1));
+                entries.push_back(std::make_pair(timepoint, version));
             }
             
-            void
-            run()
+            std::vector<std::pair<uint64_t, uint64_t>> entries;
+        };
+        
+        // turns the timepoints listed in a catalog into datapoint keys while the catalog is parsed
+        class DatapointKeyCollector : public ContentVisitor
+        {
+        public:
+            virtual void
+            onDatapoint(uint64_t timepoint)
             {
-                
-                //accept incoming confirm interest
-                m_face.setInterestFilter(CONFIRM_PREFIX,
-                                         bind(&DSUsync::onConfirmInterest, this, _1, _2),
-                                         RegisterPrefixSuccessCallback(),
-                                         bind(&DSUsync::onRegisterFailed, this, _1, _2));
-                
-                //accept incoming register interest
-                m_face.setInterestFilter(REGISTER_PREFIX,
-                                         bind(&DSUsync::onRegisterInterest, this, _1, _2),
-                                         RegisterPrefixSuccessCallback(),
-                                         bind(&DSUsync::onRegisterFailed, this, _1, _2));
-                
-                // m_ioService.run() will block until all events finished or m_ioService.stop() is called
-                m_ioService.run();
-                
-                // Alternatively, m_face.processEvents() can also be called.
-                // processEvents will block until the requested data received or timeout occurs.
-                // m_face.processEvents();
+                keys.push_back(FetchKey(FETCH_DATAPOINT, timepoint / 1000));
             }
             
-        private:
-            void confirmationCallback(const Block& wire) {
-                if (wire.type() == ndn::tlv::Data) {
-                    Data data(wire);
-                    // if the data packet is there in the repo, send confirmation to the mobile device
-                    if(data.getContent().value_size() != 0) {
-                        shared_ptr<Data> confirmationData = make_shared<Data>();
-                        confirmationData->setName(Name(CONFIRM_PREFIX_FOR_REPLY).append(data.getName()));
-                        confirmationData->setFreshnessPeriod(time::seconds(10));
-                        
-                        // Sign Data packet with default identity
-                        m_keyChain.sign(*confirmationData);
-                        std::cout << ">> D: " << *confirmationData << std::endl;
-                        m_face.put(*confirmationData);
-                    }
-                }
-                return;
+            std::vector<FetchKey> keys;
+        };
+        
+        // the part of a fetched name after /org/openmhealth/<user_id>/data/fitness/physical_activity/time_location
+        static FetchKey
+        makeFetchKey(const Name& name)
+        {
+            if (name.get(7) == UPDATA_INFO_COMP) {
+                return FetchKey(FETCH_UPDATE_INFO, name.get(8).toSequenceNumber());
+            } else if (name.get(7) == CATALOG_COMP) {
+                return FetchKey(FETCH_CATALOG, time::toUnixTimestamp(name.get(8).toTimestamp()).count(),
+                                name.get(9).toVersion());
+            } else {
+                return FetchKey(FETCH_DATAPOINT, time::toUnixTimestamp(name.get(7).toTimestamp()).count());
             }
-            void putinDataCallback(const Block& wire) {
-                if (wire.type() == ndn::tlv::Data) {
-                    Data data(wire);
-                    // if the data packet is not there in the repo, send interest to get data
-                    if(data.getContent().value_size() == 0) {
-                        Interest datapointInterest(data.getName());
-                        m_face.expressInterest(datapointInterest,
-                                               bind(&DSUsync::onDatapointData, this, _1, _2),
-                                               bind(&DSUsync::onDatapointTimeout, this, _1));
-                        std::cout << "Sending " << datapointInterest << std::endl;
-                        std::map<name::Component, std::map<Name, int>>::iterator it;
-                        it = user_unretrieve_map.find(data.getName().get(2));
-                        if (it != user_unretrieve_map.end()) {
-                            it->second[datapointInterest.getName()] = 0;
-                        }
-                    }
-                }
-                return;
+        }
+        
+        // like makeFetchKey, for names that come from the network and may not follow the layout
+        static bool
+        parseFetchKey(const Name& name, FetchKey& key)
+        {
+            if (name.size() < 8 || !COMMON_PREFIX.isPrefixOf(name)) {
+                return false;
             }
-            void onUpdateInfoData(const Interest& interest, const Data& data)
-            {
-                std::string content((char *)data.getContent().value(), data.getContent().value_size());
-                std::cout << content << std::endl;
-                char buffer[data.getContent().value_size()+1];
-                std::strcpy(buffer, content.c_str());
-                rapidjson::Document document;
-                if (document.ParseInsitu<0>(buffer).HasParseError())
-                {
-                    std::cout << "Parsing " << data << " error!" << std::endl;
-                }
-                
-                name::Component user_id = interest.getName().get(2);
-                
-                std::map<name::Component, std::map<Name, int>>::iterator outer_it;
-                outer_it = user_unretrieve_map.find(user_id);
-                std::map<Name, int>::iterator inner_it;
-                if (outer_it != user_unretrieve_map.end()) {
-                    inner_it = outer_it->second.find(interest.getName());
-                    if (inner_it != outer_it->second.end()) {
-                        outer_it->second.erase(inner_it);
-                    }
-                } else {
-                    //figure out what to do here
-                    return;
-                }
-                
-                // add into confirm set
-//                std::map<name::Component, std::set<Name>>::iterator it_confirm;
-//                it_confirm = user_confirm_map.find(user_id);
-//                if (it_confirm != user_confirm_map.end()) {
-//                    it_confirm->second.insert(interest.getName());
-//                }
-                //put data into repo
-                tcp_connect_repo_for_put_data.send(data.wireEncode());
-                
-                //parse the content and start to fetch catalog packets, see schema file for the details
-                const rapidjson::Value& list = document;
-                assert(list.IsArray());
-                for (rapidjson::SizeType i = 0; i<list.Size(); i++) {
-                    assert(list[i].IsObject());
-                    assert(list[i]["timepoint"].IsNumber());
-                    assert(list[i]["timepoint"].IsUInt64());
-                    assert(list[i]["version"].IsNumber());
-                    assert(list[i]["version"].IsUInt64());
-                    
-                    //send out catalog interest
-                    Interest catalogInterest(interest.getName().getPrefix(-2).append("catalog")
-                                             .appendTimestamp(time::fromUnixTimestamp(time::milliseconds(list[i]["timepoint"].GetUint64() / 1000)))
-                                             .appendVersion(list[i]["version"].GetUint64()));
-                    catalogInterest.setInterestLifetime(time::seconds(INTEREST_TIME_OUT_SECONDS));
-                    catalogInterest.setMustBeFresh(true);
-                    m_face.expressInterest(catalogInterest,
-                                           bind(&DSUsync::onCatalogData, this, _1, _2),
-                                           bind(&DSUsync::onCatalogTimeout, this, _1));
-                    std::cout << "Sending " << catalogInterest << std::endl;
-                    //                    unretrieveMap.insert(std::pair<Name, int>(catalogInterest.getName(), 0));
-                    outer_it->second[catalogInterest.getName()] = 0;
-                }
-                
-                // continue to fetch the next update information packet
-                uint64_t seqNo = interest.getName().get(-1).toSequenceNumber();
-                Interest updateInfoInterest(interest.getName().getPrefix(-1).appendSequenceNumber(seqNo + 1));
-                updateInfoInterest.setInterestLifetime(time::seconds(INTEREST_TIME_OUT_SECONDS));
-                updateInfoInterest.setMustBeFresh(true);
-                m_face.expressInterest(updateInfoInterest,
-                                       bind(&DSUsync::onUpdateInfoData, this, _1, _2),
-                                       bind(&DSUsync::onUpdateInfoTimeout, this, _1));
-                std::cout << "Sending " << updateInfoInterest << std::endl;
-                //                unretrieveMap.insert(std::pair<Name, int>(updateInfoInterest.getName(), 0));
-                outer_it->second[updateInfoInterest.getName()] = 0;
-            }
-            
-            void onUpdateInfoTimeout (const Interest& interest)
-            {
-                name::Component user_id = interest.getName().get(2);
-                
-                std::map<name::Component, std::map<Name, int>>::iterator outer_it;
-                outer_it = user_unretrieve_map.find(user_id);
-                std::map<Name, int>::iterator inner_it;
-                if (outer_it != user_unretrieve_map.end()) {
-                    inner_it = outer_it->second.find(interest.getName());
-                    if (inner_it == outer_it->second.end()) {
-                        std::cout << "I didn't try to retrieve " << interest.getName().toUri()<< std::endl;
-                        return;
-                    }
-                } else {
-                    //figure out what to do here
-                    return;
-                }
-                
-                
-                int updateInfoRetry = inner_it->second;
-                if(updateInfoRetry == INT_MAX) {
-                    std::cout << "Timeout " << interest << std::endl;
-                    updateInfoRetry = 0;
-                } else {
-                    Interest updateInfoInterest(interest.getName());
-                    updateInfoInterest.setInterestLifetime(time::seconds(INTEREST_TIME_OUT_SECONDS));
-                    updateInfoInterest.setMustBeFresh(true);
-                    m_face.expressInterest(updateInfoInterest,
-                                           bind(&DSUsync::onUpdateInfoData, this, _1, _2),
-                                           bind(&DSUsync::onUpdateInfoTimeout, this, _1));
-                    std::cout << "Sending " << updateInfoInterest << std::endl;
-                    updateInfoRetry++;
-                }
-                inner_it->second = updateInfoRetry;
-            }
-            
-            void onCatalogData(const Interest& interest, const Data& data)
-            {
-                std::string content((char *)data.getContent().value(), data.getContent().value_size());
-                std::cout << content << std::endl;
-                char buffer[data.getContent().value_size()+1];
-                std::strcpy(buffer, content.c_str());
-                rapidjson::Document document;
-                if (document.ParseInsitu<0>(buffer).HasParseError())
-                {
-                    std::cout << "Parsing " << data << " error!" << std::endl;
-                }
-                
-                name::Component user_id = interest.getName().get(2);
-                
-                std::map<name::Component, std::map<Name, int>>::iterator outer_it;
-                outer_it = user_unretrieve_map.find(user_id);
-                std::map<Name, int>::iterator inner_it;
-                if (outer_it != user_unretrieve_map.end()) {
-                    inner_it = outer_it->second.find(interest.getName());
-                    if (inner_it != outer_it->second.end()) {
-                        outer_it->second.erase(inner_it);
-                    }
-                } else {
-                    //figure out what to do here
-                    return;
-                }
-                
-                // add into confirm set
-//                std::map<name::Component, std::set<Name>>::iterator it_confirm;
-//                it_confirm = user_confirm_map.find(user_id);
-//                if (it_confirm != user_confirm_map.end()) {
-//                    it_confirm->second.insert(interest.getName());
-//                }
-                
-                //put data into repo
-                tcp_connect_repo_for_put_data.send(data.wireEncode());
-                
-                //parse the content and start to fetch the data points, see schema file for the details
-                const rapidjson::Value& list = document;
-                assert(list.IsArray());
-                for (rapidjson::SizeType i = 0; i<list.Size(); i++) {
-                    assert(list[i].IsNumber());
-                    assert(list[i].IsUInt64());
-                    
-                    //std::cout << list[i].GetUint64() << std::endl;
-                    // send out datapoints interest
-                    Interest datapointInterest(interest.getName().getPrefix(-3).appendTimestamp(time::fromUnixTimestamp(time::milliseconds(list[i].GetUint64()/1000))));
-                    datapointInterest.setInterestLifetime(time::seconds(INTEREST_TIME_OUT_SECONDS));
-                    datapointInterest.setMustBeFresh(true);
-                    tcp_connect_repo_for_put_data.send(datapointInterest.wireEncode());
-                    //                    m_face.expressInterest(datapointInterest,
-                    //                                           bind(&DSUsync::onDatapointData, this, _1, _2),
-                    //                                           bind(&DSUsync::onDatapointTimeout, this, _1));
-                    //                    std::cout << "Sending " << datapointInterest << std::endl;
-                    //                    outer_it->second[datapointInterest.getName()] = 0;
+            for (size_t i = 0; i < DATA_SUFFIX.size(); i++) {
+                if (name.get(3 + i) != DATA_SUFFIX.get(i)) {
+                    return false;
                 }
-                
             }
-            
-            void onCatalogTimeout (const Interest& interest)
+            if ((name.get(7) == UPDATA_INFO_COMP && name.size() < 9) ||
+                (name.get(7) == CATALOG_COMP && name.size() < 10)) {
+                return false;
+            }
+            try {
+                key = makeFetchKey(name);
+            }
+            catch (const tlv::Error&) {
+                return false;
+            }
+            return true;
+        }
+        
+        static bool
+        isWholeMillisecond(const name::Component& component)
+        {
+            time::system_clock::TimePoint timestamp = component.toTimestamp();
+            return time::fromUnixTimestamp(time::toUnixTimestamp(timestamp)) == timestamp;
+        }
+        
+        // like parseFetchKey, but only for names that are the exact name of @p key: no components
+        // after it, and timestamps that makeFetchKey does not truncate
+        static bool
+        parseExactFetchKey(const Name& name, FetchKey& key)
+        {
+            if (!parseFetchKey(name, key)) {
+                return false;
+            }
+            switch (key.kind) {
+            case FETCH_UPDATE_INFO:
+                return name.size() == 9;
+            case FETCH_CATALOG:
+                return name.size() == 10 && isWholeMillisecond(name.get(8));
+            default:
+                return name.size() == 8 && isWholeMillisecond(name.get(7));
+            }
+        }
+        
+        // kind of a fetched name, without parsing its timestamp
+        static FetchKind
+        getFetchKind(const Name& name)
+        {
+            if (name.get(7) == UPDATA_INFO_COMP) {
+                return FETCH_UPDATE_INFO;
+            } else if (name.get(7) == CATALOG_COMP) {
+                return FETCH_CATALOG;
+            }
+            return FETCH_DATAPOINT;
+        }
+        
+        // an update_info or catalog Interest answered with one segment of the object
+        static bool
+        isSegmented(const Interest& interest, const Data& data)
+        {
+            return data.getName().size() == interest.getName().size() + 1 && data.getName().get(-1).isSegment();
+        }
+        
+        class DSUsync : noncopyable
+        {
+        public:
+            /**
+             * @brief An engine running on the thread of @p ioService
+             *
+             * Incoming Interests are handed to onConfirmInterest() and onRegisterInterest()
+             * on that thread; Interests to phones and replies go out through @p face.
+             */
+            DSUsync(boost::asio::io_service& ioService, FaceEndpoint& face, const Options& options = Options())
+            : m_ioService(ioService)
+            , m_face(face)
+            , m_scheduler(m_ioService)
+            , m_interestScheduler(m_face, INTEREST_MAX_IN_FLIGHT, USER_INITIAL_WINDOW, USER_MAX_WINDOW, USER_QUANTUM)
+            , m_outstanding(m_interestScheduler)
+            , m_repo(m_ioService, m_scheduler, parseRepoEndpoints(options.repoEndpoints), options.nRepoConnections,
+                     parseRepoDispatch(options.repoDispatch), options.repoQueueLimit,
+                     bind(&DSUsync::putinDataCallback, this, _1),
+                     options.repoBatchBytes, time::milliseconds(options.repoBatchDelay))
+            , m_repoQueries(m_repo, m_scheduler, REPO_QUERY_MAX_IN_FLIGHT,
+                            time::milliseconds(REPO_QUERY_TIME_OUT_MILLISECONDS), REPO_QUERY_MAX_RETRIES)
+            , m_storedNames(STORED_NAME_INDEX_CAPACITY)
+            , m_fetchNames(COMMON_PREFIX, DATA_SUFFIX)
+            , m_memoryBudget(options.memoryBudget * 1024 * 1024)
+            , m_userIdleTimeout(std::max(options.userIdleTimeout, 0))
+            , m_pendingTtl(std::max(options.pendingTtl, 0))
             {
-                name::Component user_id = interest.getName().get(2);
+                m_repo.onWritable.connect(bind(&DSUsync::onRepoWritable, this));
                 
-                std::map<name::Component, std::map<Name, int>>::iterator outer_it;
-                outer_it = user_unretrieve_map.find(user_id);
-                std::map<Name, int>::iterator inner_it;
-                if (outer_it != user_unretrieve_map.end()) {
-                    inner_it = outer_it->second.find(interest.getName());
-                    if (inner_it == outer_it->second.end()) {
-                        std::cout << "I didn't try to retrieve " << interest << std::endl;
-                        return;
+                if (options.signing == "ecdsa") {
+                    Name certName = m_keyChain.createIdentity(Name(ECDSA_IDENTITY), EcdsaKeyParams());
+                    m_registrationSigning = security::signingByCertificate(certName);
+                } else if (options.signing != "default") {
+                    throw std::invalid_argument("unknown signing mode " + options.signing);
+                }
+                m_confirmationSigning = options.digestConfirmations ? security::signingWithSha256()
+                                                                    : m_registrationSigning;
+                m_signingPool.reset(new SigningPool(m_ioService, m_keyChain, options.nSigningThreads));
+                if (options.verifySignatures) {
+                    m_verifier.reset(new DataVerifier(m_ioService, m_face, options.nVerificationThreads,
+                                                      USER_KEY_PREFIX_LENGTH,
+                                                      bind(&DSUsync::onDataVerified, this, _1),
+                                                      bind(&DSUsync::onDataRejected, this, _1, _2, _3)));
+                    if (!options.trustAnchorPath.empty()) {
+                        shared_ptr<IdentityCertificate> anchor = io::load<IdentityCertificate>(options.trustAnchorPath);
+                        if (anchor == nullptr) {
+                            throw std::invalid_argument("cannot load trust anchor " + options.trustAnchorPath);
+                        }
+                        m_verifier->setTrustAnchor(*anchor);
                     }
-                } else {
-                    //figure out what to do here
-                    return;
                 }
                 
-                int catalogRetry = inner_it->second;
-                if(catalogRetry == 3) {
-                    std::cout << "Timeout " << interest << std::endl;
-                    catalogRetry = 0;
-                } else {
-                    Name previousName = interest.getName();
-                    Interest catalogInterest(interest.getName());
-                    catalogInterest.setInterestLifetime(time::seconds(INTEREST_TIME_OUT_SECONDS));
-                    catalogInterest.setMustBeFresh(true);
-                    m_face.expressInterest(catalogInterest,
-                                           bind(&DSUsync::onCatalogData, this, _1, _2),
-                                           bind(&DSUsync::onCatalogTimeout, this, _1));
-                    std::cout << "Sending " << catalogInterest << std::endl;
-                    catalogRetry++;
+                if (!options.spillDirectory.empty()) {
+                    m_spillStore.reset(new UserSpillStore(options.spillDirectory));
                 }
-                inner_it->second = catalogRetry;
-            }
-            
-            void onDatapointData(const Interest& interest, const Data& data)
-            {
-                std::string content((char *)data.getContent().value(), data.getContent().value_size());
-                std::cout << content << std::endl;
-                // to correctly parse the JSON, the '\0' should be included.
-                char buffer[data.getContent().value_size()+1];
-                std::strcpy(buffer, content.c_str());
-                rapidjson::Document document;
-                if (document.ParseInsitu<0>(buffer).HasParseError())
-                {
-                    std::cout << "Parsing " << data << " error!" << std::endl;
+                if (!options.journalPath.empty()) {
+                    openJournal(options.journalPath, options.nShards, options.compactionInterval);
                 }
+                m_scheduler.scheduleEvent(time::seconds(MEMORY_SWEEP_INTERVAL_SECONDS),
+                                          bind(&DSUsync::onMemorySweepTimer, this));
                 
-                name::Component user_id = interest.getName().get(2);
-                
-                std::map<name::Component, std::map<Name, int>>::iterator outer_it;
-                outer_it = user_unretrieve_map.find(user_id);
-                std::map<Name, int>::iterator inner_it;
-                if (outer_it != user_unretrieve_map.end()) {
-                    inner_it = outer_it->second.find(interest.getName());
-                    if (inner_it != outer_it->second.end()) {
-                        outer_it->second.erase(inner_it);
-                    }
-                } else {
-                    //figure out what to do here
-                    return;
+                m_repoQueries.afterRttMeasurement.connect(bind(&Histogram::record, &m_metrics.repoQueryRtt, _1));
+                if (!options.metricsPath.empty()) {
+                    m_metricsPath = options.metricsPath;
+                    m_metricsInterval = time::seconds(options.metricsInterval);
+                    m_scheduler.scheduleEvent(m_metricsInterval, bind(&DSUsync::onMetricsTimer, this));
                 }
-                
-                // add into confirm set
-//                std::map<name::Component, std::set<Name>>::iterator it_confirm;
-//                it_confirm = user_confirm_map.find(user_id);
-//                if (it_confirm != user_confirm_map.end()) {
-//                    it_confirm->second.insert(interest.getName());
-//                }
-                
-                //put data into repo
-                tcp_connect_repo_for_put_data.send(data.wireEncode());
-                
             }
             
-            void onDatapointTimeout (const Interest& interest)
+            void
+            onConfirmInterest(const Interest& interest)
             {
-                name::Component user_id = interest.getName().get(2);
+                DSU_LOG_DEBUG("<< I: " << interest);
                 
-                std::map<name::Component, std::map<Name, int>>::iterator outer_it;
-                outer_it = user_unretrieve_map.find(user_id);
-                std::map<Name, int>::iterator inner_it;
-                if (outer_it != user_unretrieve_map.end()) {
-                    inner_it = outer_it->second.find(interest.getName());
-                    if (inner_it == outer_it->second.end()) {
-                        std::cout << "I didn't try to retrieve " << interest << std::endl;
-                        return;
-                    }
-                } else {
-                    //figure out what to do here
+                Name dataName = interest.getName().getSubName(7);
+                FetchKey key;
+                // the index only holds keys, a name it would confuse with another is asked about instead
+                if (parseExactFetchKey(dataName, key) && m_storedNames.contains(dataName.get(2), key)) {
+                    sendConfirmation(dataName);
                     return;
                 }
                 
-                int datapointRetry = inner_it->second;
-                if(datapointRetry == 3) {
-                    std::cout << "Timeout " << interest << std::endl;
-                    datapointRetry = 0;
-                } else {
-                    Name previousName = interest.getName();
-                    Interest datapointInterest(interest.getName());
-                    datapointInterest.setInterestLifetime(time::seconds(INTEREST_TIME_OUT_SECONDS));
-                    datapointInterest.setMustBeFresh(true);
-                    m_face.expressInterest(datapointInterest,
-                                           bind(&DSUsync::onDatapointData, this, _1, _2),
-                                           bind(&DSUsync::onDatapointTimeout, this, _1));
-                    std::cout << "Sending " << datapointInterest << std::endl;
-                    datapointRetry++;
-                }
-                inner_it->second = datapointRetry;
-            }
-            
-            void
-            onConfirmInterest(const InterestFilter& filter, const Interest& interest)
-            {
-                std::cout << "<< I: " << interest << std::endl;
-                
-                Interest dataInterest(interest.getName().getSubName(7));
-                
-                tcp_connect_repo_for_confirmation.send(dataInterest.wireEncode());
+                // a phone is waiting for the answer, so the check jumps ahead of the catalog ones
+                m_metrics.repoQueries.increment();
+                m_repoQueries.query(std::vector<Name>(1, dataName),
+                                    bind(&DSUsync::onConfirmQueryResult, this, _1, _2), true);
                 
                 // Create new name, based on Interest's name
 //                Name confirmDataName(interest.getName());
@@ -416,110 +456,2120 @@ namespace ndn {
             }
             
             void
-            onRegisterInterest(const InterestFilter& filter, const Interest& interest)
+            onRegisterInterest(const Interest& interest)
             {
-                std::cout << "<< I: " << interest << std::endl;
+                DSU_LOG_DEBUG("<< I: " << interest);
                 Name registerSuccessDataName(interest.getName());
                 name::Component user_id = registerSuccessDataName.get(9);
                 
-                std::map<name::Component, std::map<Name, int>>::iterator it;
-                it = user_unretrieve_map.find(user_id);
-                if (it != user_unretrieve_map.end()) {
-                    for (std::map<Name,int>::iterator inner_it=it->second.begin(); inner_it!=it->second.end(); ++inner_it) {
-                        name::Component keyComp = inner_it->first.get(7);
-                        Interest resentInterest(inner_it->first);
-                        resentInterest.setInterestLifetime(time::seconds(INTEREST_TIME_OUT_SECONDS));
-                        resentInterest.setMustBeFresh(true);
-                        // since the same update information interest keeps being sent, so we do not need to do the following part
-//                        if (keyComp == UPDATA_INFO_COMP) {
-//                            m_face.expressInterest(resentInterest,
-//                                                   bind(&DSUsync::onUpdateInfoData, this, _1, _2),
-//                                                   bind(&DSUsync::onUpdateInfoTimeout, this, _1));
-//                            
-//                        } else
-                        if(keyComp == CATALOG_COMP) {
-                            m_face.expressInterest(resentInterest,
-                                                   bind(&DSUsync::onCatalogData, this, _1, _2),
-                                                   bind(&DSUsync::onCatalogTimeout, this, _1));
-                        } else {
-                            m_face.expressInterest(resentInterest,
-                                                   bind(&DSUsync::onDatapointData, this, _1, _2),
-                                                   bind(&DSUsync::onDatapointTimeout, this, _1));
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                if (pending == 0 && reloadUser(user_id)) {
+                    pending = m_pendingFetches.getUser(user_id);
+                }
+                if (pending != 0) {
+                    // a register Interest repeated while the previous walk is under way starts it over
+                    std::deque<FetchKey>& keys = m_resumeQueues[user_id];
+                    bool isResuming = !keys.empty();
+                    keys.clear();
+                    pending->forEach([&keys] (const FetchKey& key, int retry) {
+                        // update information interests are kept in flight by the window
+                        if (key.kind != FETCH_UPDATE_INFO) {
+                            keys.push_back(key);
                         }
-                        std::cout << "Sending " << resentInterest << std::endl;
+                    });
+                    // the phone is back online, open up the window if it was only probing
+                    getRttEstimator(user_id).resetBackoff();
+                    std::map<name::Component, UpdateInfoWindow>::iterator window_it = m_updateInfoWindows.find(user_id);
+                    if (window_it != m_updateInfoWindows.end()) {
+                        window_it->second.resetProbeTimeouts();
+                    }
+                    fillUpdateInfoWindow(user_id);
+                    if (!isResuming) {
+                        resumeFetches(user_id);
                     }
                 } else {
-                    //send out update information interest
-                    Interest updateInfoInterest(Name(COMMON_PREFIX).append(user_id).append(Name(UPDATE_INFO_SUFFIX)).appendSequenceNumber(1));
-                    updateInfoInterest.setInterestLifetime(time::seconds(INTEREST_TIME_OUT_SECONDS));
-                    updateInfoInterest.setMustBeFresh(true);
-                    m_face.expressInterest(updateInfoInterest,
-                                           bind(&DSUsync::onUpdateInfoData, this, _1, _2),
-                                           bind(&DSUsync::onUpdateInfoTimeout, this, _1));
-                    std::cout << "Sending " << updateInfoInterest << std::endl;
-                    
-                    std::map<Name, int> unretrieve_map;
-                    unretrieve_map[updateInfoInterest.getName()] = 0;
-                    user_unretrieve_map[user_id] = unretrieve_map;
-                    
-                    std::map<name::Component, std::map<Name, int>>::iterator outer_it;
-                    outer_it = user_unretrieve_map.find(user_id);
-                    std::map<Name, int>::iterator inner_it;
-                    if (outer_it != user_unretrieve_map.end()) {
-                        inner_it = outer_it->second.find(updateInfoInterest.getName());
-                        if (inner_it == outer_it->second.end()) {
-                            std::cout << "check if the interest is there " << updateInfoInterest << std::endl;
-                            return;
-                        }
+                    //send out update information interests, starting from sequence number 1
+                    m_pendingFetches.addUser(user_id);
+                    if (m_journal != nullptr) {
+                        m_journal->addUser(user_id);
                     }
+                    m_updateInfoWindows.insert(std::make_pair(user_id,
+                                                              UpdateInfoWindow(1, UPDATE_INFO_INITIAL_WINDOW,
+                                                                               UPDATE_INFO_MAX_WINDOW)));
+                    fillUpdateInfoWindow(user_id);
                     
 //                    std::set<Name> confirm_set;
 //                    user_confirm_map[user_id] = confirm_set;
                 }
+                noteUserActivity(user_id);
                 
                 shared_ptr<Data> data = make_shared<Data>();
                 data->setName(registerSuccessDataName);
                 data->setFreshnessPeriod(time::seconds(10));
-                // Sign Data packet with default identity
-                m_keyChain.sign(*data);
-                std::cout << ">> D: " << *data << std::endl;
-                m_face.put(*data);
+                m_signingPool->sign(data, m_registrationSigning, bind(&DSUsync::putSignedData, this, _1));
+            }
+            
+            std::string
+            makeMetricsReport(size_t maxUsers)
+            {
+                Metrics::Gauges gauges;
+                gauges.push_back(std::make_pair("interests_queued", m_interestScheduler.getQueued()));
+                gauges.push_back(std::make_pair("interests_in_flight", m_interestScheduler.getInFlight()));
+                gauges.push_back(std::make_pair("interests_outstanding", m_outstanding.size()));
+                gauges.push_back(std::make_pair("users_resuming", m_resumeQueues.size()));
+                gauges.push_back(std::make_pair("segmented_fetches", m_segmentedFetches.size()));
+                gauges.push_back(std::make_pair("deferred_fetches", m_deferredFetches.size()));
+                gauges.push_back(std::make_pair("pending_fetches", m_pendingFetches.size()));
+                gauges.push_back(std::make_pair("pending_fetches_bytes", m_pendingFetches.getMemoryUsage()));
+                gauges.push_back(std::make_pair("repo_queue", m_repo.getQueueSize()));
+                gauges.push_back(std::make_pair("repo_writes", m_repo.getWriteCount()));
+                gauges.push_back(std::make_pair("repo_packets_written", m_repo.getWrittenCount()));
+                gauges.push_back(std::make_pair("repo_queries_in_flight", m_repoQueries.getInFlight()));
+                gauges.push_back(std::make_pair("repo_queries_queued", m_repoQueries.getQueued()));
+                gauges.push_back(std::make_pair("stored_index_size", m_storedNames.size()));
+                gauges.push_back(std::make_pair("stored_index_hits", m_storedNames.getHitCount()));
+                gauges.push_back(std::make_pair("stored_index_misses", m_storedNames.getMissCount()));
+                gauges.push_back(std::make_pair("stored_index_users", m_storedNames.getUserCount()));
+                if (m_journal != nullptr) {
+                    gauges.push_back(std::make_pair("journal_bytes", m_journal->getSize()));
+                }
+                if (m_spillStore != nullptr) {
+                    gauges.push_back(std::make_pair("users_spilled", m_spillStore->size()));
+                }
+                if (m_verifier != nullptr) {
+                    gauges.push_back(std::make_pair("verification_backlog", m_verifier->getBacklog()));
+                    gauges.push_back(std::make_pair("verification_keys", m_verifier->getKeyCount()));
+                    gauges.push_back(std::make_pair("certificate_fetches", m_verifier->getCertificateFetchCount()));
+                }
+                size_t memoryUsage = 0;
                 
+                std::vector<Metrics::UserStats> users;
+                m_pendingFetches.forEachUser([&] (const name::Component& user_id, const PendingFetchSet& pending) {
+                    Metrics::UserStats stats;
+                    stats.user = user_id.toUri();
+                    stats.nPending = pending.size();
+                    stats.nQueued = m_interestScheduler.getQueueDepth(user_id);
+                    stats.nInFlight = m_interestScheduler.getInFlight(user_id);
+                    stats.window = m_interestScheduler.getWindow(user_id);
+                    std::map<name::Component, RttEstimator>::iterator rtt = m_rttEstimators.find(user_id);
+                    stats.rtoMs = rtt != m_rttEstimators.end() ? rtt->second.getRto().count() : RTO_INITIAL_MILLISECONDS;
+                    stats.memoryBytes = getUserMemoryUsage(user_id, pending);
+                    memoryUsage += stats.memoryBytes;
+                    users.push_back(stats);
+                });
+                gauges.push_back(std::make_pair("memory_bytes", memoryUsage));
+                gauges.push_back(std::make_pair("memory_budget_bytes", m_memoryBudget));
+                return m_metrics.toJson(gauges, users, maxUsers);
             }
             
-            void
-            onRegisterFailed(const Name& prefix, const std::string& reason)
+            /**
+             * @brief Evict the users that belong to another instance, spilling their state
+             * @return the users of another instance in the spill directory, those just evicted and
+             *         those spilled earlier for being idle, for takeUserState()
+             */
+            std::vector<name::Component>
+            handOffUsers(const function<bool(const name::Component& user_id)>& isOwned)
+            {
+                std::vector<name::Component> users;
+                m_pendingFetches.forEachUser([&] (const name::Component& user_id, const PendingFetchSet& pending) {
+                    if (!isOwned(user_id)) {
+                        users.push_back(user_id);
+                    }
+                });
+                for (size_t i = 0; i < users.size(); i++) {
+                    evictUser(users[i]);
+                }
+                
+                std::vector<name::Component> spilled;
+                if (m_spillStore != nullptr) {
+                    std::vector<name::Component> stored = m_spillStore->listUsers();
+                    for (size_t i = 0; i < stored.size(); i++) {
+                        if (!isOwned(stored[i])) {
+                            spilled.push_back(stored[i]);
+                        }
+                    }
+                }
+                return spilled;
+            }
+            
+            /// the spilled state of @p user_id, no longer kept here; empty if there is none
+            std::vector<uint8_t>
+            takeUserState(const name::Component& user_id)
+            {
+                std::vector<uint8_t> state;
+                if (m_spillStore == nullptr || !m_spillStore->takeState(user_id, state)) {
+                    state.clear();
+                }
+                return state;
+            }
+            
+            /**
+             * @brief Take over the state of @p user_id from another instance
+             *
+             * It goes to the spill directory, and is loaded on the user's next register Interest.
+             * A user already known here, whose phone registered before the handoff completed,
+             * gets it merged in: the pending fetches it lacks, and the sequence number to fetch
+             * update_info from if it is further along.
+             * @return false if the state is damaged or cannot be written
+             */
+            bool
+            importUserState(const name::Component& user_id, const std::vector<uint8_t>& state)
             {
-                std::cerr << "ERROR: Failed to register prefix \""
-                << prefix << "\" in local hub's daemon (" << reason << ")"
-                << std::endl;
+                if (m_spillStore == nullptr) {
+                    return false;
+                }
+                if (m_pendingFetches.getUser(user_id) == 0 && !reloadUser(user_id)) {
+                    try {
+                        m_spillStore->putState(user_id, state);
+                    }
+                    catch (const UserSpillStore::Error& e) {
+                        DSU_LOG_ERROR(e.what());
+                        return false;
+                    }
+                    return true;
+                }
+                
+                std::vector<UserSpillStore::Entry> entries;
+                uint64_t nextSeqNo = 1;
+                if (!UserSpillStore::parseState(state, entries, nextSeqNo, getPendingClock())) {
+                    DSU_LOG_WARN("Damaged state handed over for user " << user_id);
+                    return false;
+                }
+                mergeUser(user_id, entries, nextSeqNo);
+                return true;
             }
             
         private:
-            // Explicitly create io_service object, which can be shared between Face and Scheduler
-            boost::asio::io_service m_ioService;
-            Face m_face;
-            TcpTransport tcp_connect_repo_for_put_data;
-            TcpTransport tcp_connect_repo_for_confirmation;
-            Scheduler m_scheduler;
-            std::map<name::Component, std::map<Name, int>> user_unretrieve_map;
-//            std::map<name::Component, std::set<Name>> user_confirm_map;
-            KeyChain m_keyChain;
-        };
-        
-        
-        
-    } // namespace dsu
-} // namespace ndn
-
-int
-main(int argc, char** argv)
-{
-    ndn::dsu::DSUsync dsusync;
+            void onConfirmQueryResult(const Name& name, RepoQueryEngine::Result result) {
+                // if the data packet is there in the repo, send confirmation to the mobile device
+                if (result == RepoQueryEngine::STORED) {
+                    markStored(name);
+                    sendConfirmation(name);
+                }
+            }
+            void sendConfirmation(const Name& name) {
+                m_metrics.confirmationsServed.increment();
+                shared_ptr<Data> confirmationData = make_shared<Data>();
+                confirmationData->setName(Name(CONFIRM_PREFIX_FOR_REPLY).append(name));
+                confirmationData->setFreshnessPeriod(time::seconds(10));
+                
+                m_signingPool->sign(confirmationData, m_confirmationSigning,
+                                    bind(&DSUsync::putSignedData, this, _1));
+            }
+            // put data into repo once its signature is checked, if they are
+            void insertIntoRepo(const Data& data) {
+                if (m_verifier != nullptr) {
+                    VerifyingObject& object = m_verifyingObjects[getObjectName(data.getName())];
+                    object.nPackets++;
+                    object.isAbandoned = false;
+                    m_verifier->verify(data);
+                } else if (!storeInRepo(data)) {
+                    m_verifyingObjects[getObjectName(data.getName())].isRefused = true;
+                }
+            }
+            void onDataVerified(const Data& data) {
+                m_metrics.packetsVerified.increment();
+                if (!storeInRepo(data)) {
+                    m_verifyingObjects[getObjectName(data.getName())].isRefused = true;
+                }
+                onPacketVerified(data, false, false);
+            }
+            void onDataRejected(const Data& data, const std::string& reason, bool isTransient) {
+                m_metrics.packetsRejected.increment();
+                DSU_LOG_WARN("Not storing " << data.getName() << ": " << reason);
+                onPacketVerified(data, !isTransient, isTransient);
+            }
+            
+            // the name an object is fetched under, for a packet of it
+            Name getObjectName(const Name& name) {
+                return m_fetchNames.makeName(name.get(2), makeFetchKey(name));
+            }
+            
+            void onPacketVerified(const Data& data, bool hasBadSignature, bool hasNoCertificate) {
+                std::map<Name, VerifyingObject>::iterator it = m_verifyingObjects.find(getObjectName(data.getName()));
+                if (it == m_verifyingObjects.end()) {
+                    return;
+                }
+                VerifyingObject& object = it->second;
+                object.nPackets--;
+                object.hasBadSignature = object.hasBadSignature || hasBadSignature;
+                object.hasNoCertificate = object.hasNoCertificate || hasNoCertificate;
+                if (object.nPackets > 0) {
+                    return;
+                }
+                if (object.isComplete) {
+                    Name name = it->first;
+                    int retryDelay = object.getRetryDelay();
+                    m_verifyingObjects.erase(it);
+                    completeFetch(name, retryDelay);
+                } else if (object.isAbandoned) {
+                    m_verifyingObjects.erase(it);
+                }
+            }
+            
+            // every packet of the object fetched under @p name has been passed to insertIntoRepo();
+            // it stops being pending once they are all verified
+            void finishFetch(const Name& name) {
+                std::map<Name, VerifyingObject>::iterator it = m_verifyingObjects.find(name);
+                if (it == m_verifyingObjects.end()) {
+                    completeFetch(name, 0);
+                    return;
+                }
+                it->second.isComplete = true;
+                if (it->second.nPackets == 0) {
+                    int retryDelay = it->second.getRetryDelay();
+                    m_verifyingObjects.erase(it);
+                    completeFetch(name, retryDelay);
+                }
+            }
+            
+            // the segments of an object already passed to the verifier are not followed up
+            void abandonVerification(const Name& name) {
+                std::map<Name, VerifyingObject>::iterator it = m_verifyingObjects.find(name);
+                if (it == m_verifyingObjects.end()) {
+                    return;
+                }
+                if (it->second.nPackets == 0) {
+                    m_verifyingObjects.erase(it);
+                } else {
+                    it->second.isAbandoned = true;
+                }
+            }
+            
+            // an object with a packet that could not be stored for now stays pending, it is fetched
+            // again after @p retryDelay seconds; 0 drops it, whether it was stored or not
+            void completeFetch(const Name& name, int retryDelay) {
+                name::Component user_id = name.get(2);
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                if (pending == 0) {
+                    return;
+                }
+                if (retryDelay > 0) {
+                    DSU_LOG_INFO("Fetching " << name << " again in " << retryDelay << " s");
+                    m_scheduler.scheduleEvent(time::seconds(retryDelay),
+                                              bind(&DSUsync::retryFetch, this, name));
+                    return;
+                }
+                removePendingFetch(*pending, user_id, makeFetchKey(name));
+                if (getFetchKind(name) == FETCH_UPDATE_INFO) {
+                    onUpdateInfoReceived(name);
+                }
+            }
+            // the wire received from the phone is queued as is; it counts as stored once the batch
+            // it was queued in has been written to the repo connection
+            // @return false if the repo connections are full and the packet was dropped
+            bool storeInRepo(const Data& data) {
+                if (!m_repo.send(data.wireEncode(), bind(&DSUsync::markStored, this, data.getName()))) {
+                    m_metrics.repoRefused.increment();
+                    DSU_LOG_WARN("Repo connections full, not storing " << data.getName());
+                    return false;
+                }
+                m_metrics.repoInserts.increment();
+                return true;
+            }
+            void markStored(const Name& name) {
+                // an object is not complete with one of its segments, the repo is asked about it instead
+                if (name.get(-1).isSegment()) {
+                    return;
+                }
+                FetchKey key;
+                if (parseExactFetchKey(name, key)) {
+                    m_storedNames.insert(name.get(2), key);
+                }
+            }
+            void putinDataCallback(const Block& wire) {
+                if (wire.type() == ndn::tlv::Data) {
+                    Data data(wire);
+                    if (!m_repoQueries.onData(data)) {
+                        DSU_LOG_DEBUG("Unsolicited repo reply " << data.getName());
+                    }
+                }
+                return;
+            }
+            void onRepoQueryResult(const Name& name, RepoQueryEngine::Result result) {
+                if (result == RepoQueryEngine::STORED) {
+                    markStored(name);
+                    return;
+                }
+                if (result == RepoQueryEngine::LOST) {
+                    DSU_LOG_WARN("Repo did not answer for " << name << ", fetching it anyway");
+                }
+                // if the data packet is not there in the repo, send interest to get data
+                PendingFetchSet* pending = m_pendingFetches.getUser(name.get(2));
+                if (pending != 0) {
+                    addPendingFetch(*pending, name.get(2), makeFetchKey(name));
+                }
+                expressFetchInterest(name);
+            }
+            void onUpdateInfoData(const Interest& interest, const Data& data,
+                                  const time::steady_clock::TimePoint& sentAt)
+            {
+                recordFetchData(interest.getName(), sentAt);
+                if (isSegmented(interest, data)) {
+                    startSegmentedFetch(interest, data, sentAt);
+                    return;
+                }
+                const Block& content = data.getContent();
+                logPayload(data);
+                CatalogEntryCollector catalogs;
+                if (!parseUpdateInfo(content, catalogs))
+                {
+                    DSU_LOG_WARN("Parsing " << data.getName() << " error!");
+                }
+                
+                name::Component user_id = interest.getName().get(2);
+                
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                if (pending != 0) {
+                    measureRtt(*pending, user_id, makeFetchKey(interest.getName()), sentAt);
+                } else {
+                    //figure out what to do here
+                    return;
+                }
+                
+                // add into confirm set
+//                std::map<name::Component, std::set<Name>>::iterator it_confirm;
+//                it_confirm = user_confirm_map.find(user_id);
+//                if (it_confirm != user_confirm_map.end()) {
+//                    it_confirm->second.insert(interest.getName());
+//                }
+                //put data into repo
+                insertIntoRepo(data);
+                
+                fetchCatalogs(interest.getName(), catalogs.entries);
+                finishFetch(interest.getName());
+            }
+            
+            //start to fetch the catalog packets listed in an update_info, see schema file for the details
+            void fetchCatalogs(const Name& updateInfoName,
+                               const std::vector<std::pair<uint64_t, uint64_t>>& entries)
+            {
+                name::Component user_id = updateInfoName.get(2);
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                if (pending == 0) {
+                    return;
+                }
+                for (size_t i = 0; i < entries.size(); i++) {
+                    //send out catalog interest
+                    FetchKey key(FETCH_CATALOG, entries[i].first / 1000, entries[i].second);
+                    addPendingFetch(*pending, user_id, key);
+                    expressFetchInterest(m_fetchNames.makeName(user_id, key));
+                }
+            }
+            
+            // slide the window and continue to fetch the next update information packets
+            void onUpdateInfoReceived(const Name& name)
+            {
+                name::Component user_id = name.get(2);
+                uint64_t seqNo = name.get(-1).toSequenceNumber();
+                std::map<name::Component, UpdateInfoWindow>::iterator window_it;
+                window_it = m_updateInfoWindows.find(user_id);
+                if (window_it != m_updateInfoWindows.end()) {
+                    uint64_t nextExpected = window_it->second.getNextExpected();
+                    window_it->second.onData(seqNo);
+                    if (m_journal != nullptr && window_it->second.getNextExpected() != nextExpected) {
+                        m_journal->setProgress(user_id, window_it->second.getNextExpected());
+                        m_journalProgress[user_id] = window_it->second.getNextExpected();
+                    }
+                }
+                fillUpdateInfoWindow(user_id);
+            }
+            
+            // true if @p name is already being fetched; the outcome of that fetch is handled once,
+            // so the request is not merged into it: its callbacks would handle the same outcome again
+            bool isFetching(const Name& name)
+            {
+                if (m_segmentedFetches.count(name) == 0 && !m_outstanding.contains(name)) {
+                    return false;
+                }
+                m_metrics.interestsMerged.increment();
+                DSU_LOG_DEBUG("Already fetching " << name);
+                return true;
+            }
+            
+            void expressUpdateInfoInterest(const Name& name)
+            {
+                if (isFetching(name)) {
+                    return;
+                }
+                Interest updateInfoInterest = m_fetchNames.makeInterest(name, getRttEstimator(name.get(2)).getRto());
+                m_outstanding.express(name.get(2), updateInfoInterest,
+                                      bind(&DSUsync::onUpdateInfoData, this, _1, _2, _3),
+                                      bind(&DSUsync::onUpdateInfoTimeout, this, _1, _2));
+                m_metrics.getFetch(FETCH_UPDATE_INFO).interestsSent.increment();
+                DSU_LOG_DEBUG("Sending " << updateInfoInterest);
+            }
+            
+            // express a catalog or datapoint Interest, or hold it back while the repo cannot keep up
+            void expressFetchInterest(const Name& name)
+            {
+                if (isFetching(name)) {
+                    return;
+                }
+                if (m_repo.isSaturated()) {
+                    if (m_deferredNames.insert(name).second) {
+                        m_deferredFetches.push_back(name);
+                    }
+                    return;
+                }
+                Interest fetchInterest = m_fetchNames.makeInterest(name, getRttEstimator(name.get(2)).getRto());
+                if (name.get(7) == CATALOG_COMP) {
+                    m_outstanding.express(name.get(2), fetchInterest,
+                                          bind(&DSUsync::onCatalogData, this, _1, _2, _3),
+                                          bind(&DSUsync::onCatalogTimeout, this, _1, _2));
+                } else {
+                    m_outstanding.express(name.get(2), fetchInterest,
+                                          bind(&DSUsync::onDatapointData, this, _1, _2, _3),
+                                          bind(&DSUsync::onDatapointTimeout, this, _1, _2));
+                }
+                m_metrics.getFetch(getFetchKind(name)).interestsSent.increment();
+                DSU_LOG_DEBUG("Sending " << fetchInterest);
+            }
+            
+            // the repo connections have room again, resume what was held back
+            void onRepoWritable()
+            {
+                m_repoQueries.dispatch();
+                while (!m_deferredFetches.empty() && !m_repo.isSaturated()) {
+                    Name name = m_deferredFetches.front();
+                    m_deferredFetches.pop_front();
+                    m_deferredNames.erase(name);
+                    // the fetch may have expired or its user been evicted in the meantime
+                    PendingFetchSet* pending = m_pendingFetches.getUser(name.get(2));
+                    if (pending != 0 && pending->find(makeFetchKey(name)) != 0) {
+                        expressFetchInterest(name);
+                    }
+                }
+                for (std::map<name::Component, UpdateInfoWindow>::iterator it = m_updateInfoWindows.begin();
+                     it != m_updateInfoWindows.end() && !m_repo.isSaturated(); ++it) {
+                    fillUpdateInfoWindow(it->first);
+                }
+            }
+            
+            // express every update_info Interest the user's window currently allows
+            void fillUpdateInfoWindow(const name::Component& user_id)
+            {
+                // every update_info fetched leads to more repo traffic, wait for the repo to drain
+                if (m_repo.isSaturated()) {
+                    return;
+                }
+                std::map<name::Component, UpdateInfoWindow>::iterator window_it;
+                window_it = m_updateInfoWindows.find(user_id);
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                if (window_it == m_updateInfoWindows.end() || pending == 0) {
+                    return;
+                }
+                
+                std::vector<uint64_t> seqNos = window_it->second.fill();
+                for (size_t i = 0; i < seqNos.size(); i++) {
+                    FetchKey key(FETCH_UPDATE_INFO, seqNos[i]);
+                    expressUpdateInfoInterest(m_fetchNames.makeName(user_id, key));
+                    addPendingFetch(*pending, user_id, key);
+                }
+            }
+            
+            void onUpdateInfoTimeout (const Interest& interest, const time::steady_clock::TimePoint& sentAt)
+            {
+                m_metrics.getFetch(getFetchKind(interest.getName())).timeouts.increment();
+                name::Component user_id = interest.getName().get(2);
+                
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                int* retry = 0;
+                if (pending != 0) {
+                    retry = pending->find(makeFetchKey(interest.getName()));
+                    if (retry == 0) {
+                        DSU_LOG_DEBUG("I didn't try to retrieve " << interest.getName());
+                        return;
+                    }
+                } else {
+                    //figure out what to do here
+                    return;
+                }
+                
+                
+                UpdateInfoWindow::TimeoutAction action = UpdateInfoWindow::RETRANSMIT;
+                std::map<name::Component, UpdateInfoWindow>::iterator window_it;
+                window_it = m_updateInfoWindows.find(user_id);
+                if (window_it != m_updateInfoWindows.end()) {
+                    action = window_it->second.onTimeout(interest.getName().get(-1).toSequenceNumber());
+                }
+                
+                if (action == UpdateInfoWindow::DROP) {
+                    // speculative Interest past the end of the stream, it will be asked again later
+                    removePendingFetch(*pending, user_id, makeFetchKey(interest.getName()));
+                    return;
+                }
+                if (action == UpdateInfoWindow::PROBE) {
+                    // the end-of-stream probe keeps being retried, ever more slowly while the phone is silent;
+                    // an idle phone is no lossy one, so the RTO the other fetches use is left alone
+                    scheduleRetry(interest.getName(), window_it->second.getProbeTimeoutCount());
+                } else {
+                    getRttEstimator(user_id).onTimeout(sentAt);
+                    scheduleRetry(interest.getName());
+                }
+                if (*retry < INT_MAX) {
+                    (*retry)++;
+                }
+            }
+            
+            void onCatalogData(const Interest& interest, const Data& data,
+                               const time::steady_clock::TimePoint& sentAt)
+            {
+                recordFetchData(interest.getName(), sentAt);
+                if (isSegmented(interest, data)) {
+                    startSegmentedFetch(interest, data, sentAt);
+                    return;
+                }
+                const Block& content = data.getContent();
+                logPayload(data);
+                DatapointKeyCollector datapoints;
+                if (!parseCatalog(content, datapoints))
+                {
+                    DSU_LOG_WARN("Parsing " << data.getName() << " error!");
+                }
+                
+                name::Component user_id = interest.getName().get(2);
+                
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                if (pending != 0) {
+                    measureRtt(*pending, user_id, makeFetchKey(interest.getName()), sentAt);
+                } else {
+                    //figure out what to do here
+                    return;
+                }
+                
+                // add into confirm set
+//                std::map<name::Component, std::set<Name>>::iterator it_confirm;
+//                it_confirm = user_confirm_map.find(user_id);
+//                if (it_confirm != user_confirm_map.end()) {
+//                    it_confirm->second.insert(interest.getName());
+//                }
+                
+                //put data into repo
+                insertIntoRepo(data);
+                finishFetch(interest.getName());
+                
+                queryDatapoints(user_id, datapoints.keys);
+            }
+            
+            // start to fetch the data points listed in a catalog, see schema file for the details;
+            // ask the repo which datapoints it already has, the missing ones are fetched in onRepoQueryResult;
+            // datapoints the index knows to be stored need no question
+            void queryDatapoints(const name::Component& user_id, const std::vector<FetchKey>& datapointKeys)
+            {
+                std::vector<Name> unknownNames;
+                unknownNames.reserve(datapointKeys.size());
+                for (size_t i = 0; i < datapointKeys.size(); i++) {
+                    if (!m_storedNames.contains(user_id, datapointKeys[i])) {
+                        unknownNames.push_back(m_fetchNames.makeName(user_id, datapointKeys[i]));
+                    }
+                }
+                m_metrics.repoQueries.increment(unknownNames.size());
+                m_repoQueries.query(unknownNames, bind(&DSUsync::onRepoQueryResult, this, _1, _2));
+            }
+            
+            // fetch the other segments of an update_info or catalog, processing each one as it comes in order
+            void startSegmentedFetch(const Interest& interest, const Data& data,
+                                     const time::steady_clock::TimePoint& sentAt)
+            {
+                const Name& name = interest.getName();
+                name::Component user_id = name.get(2);
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                if (pending == 0) {
+                    return;
+                }
+                measureRtt(*pending, user_id, makeFetchKey(name), sentAt);
+                
+                SegmentedFetch fetch;
+                fetch.parser = make_shared<SegmentedContentParser>(getFetchKind(name) == FETCH_CATALOG ?
+                                                                   SegmentedContentParser::CATALOG :
+                                                                   SegmentedContentParser::UPDATE_INFO);
+                fetch.isParsed = true;
+                fetch.pipeline = make_shared<SegmentPipeline>(ref(m_outstanding), user_id, SEGMENT_WINDOW,
+                                                              getRttEstimator(user_id).getRto(), SEGMENT_MAX_RETRIES,
+                                                              bind(&DSUsync::onSegment, this, name, _1),
+                                                              bind(&DSUsync::onSegmentedFetchComplete, this, name),
+                                                              bind(&DSUsync::onSegmentedFetchFailed, this, name));
+                shared_ptr<SegmentPipeline> pipeline = fetch.pipeline;
+                m_segmentedFetches[name] = fetch;
+                DSU_LOG_DEBUG("Fetching the segments of " << name);
+                pipeline->start(data);
+            }
+            
+            void onSegment(const Name& name, const Data& segment)
+            {
+                noteUserActivity(name.get(2));
+                logPayload(segment);
+                insertIntoRepo(segment);
+                
+                std::map<Name, SegmentedFetch>::iterator it = m_segmentedFetches.find(name);
+                if (it == m_segmentedFetches.end() || !it->second.isParsed) {
+                    return;
+                }
+                // the entries listed so far are acted upon now, not when the last segment has arrived
+                if (getFetchKind(name) == FETCH_CATALOG) {
+                    DatapointKeyCollector datapoints;
+                    it->second.isParsed = it->second.parser->feed(segment.getContent(), datapoints);
+                    queryDatapoints(name.get(2), datapoints.keys);
+                } else {
+                    CatalogEntryCollector catalogs;
+                    it->second.isParsed = it->second.parser->feed(segment.getContent(), catalogs);
+                    fetchCatalogs(name, catalogs.entries);
+                }
+                if (!it->second.isParsed) {
+                    DSU_LOG_WARN("Parsing " << segment.getName() << " error!");
+                }
+            }
+            
+            void onSegmentedFetchComplete(const Name& name)
+            {
+                std::map<Name, SegmentedFetch>::iterator it = m_segmentedFetches.find(name);
+                if (it == m_segmentedFetches.end()) {
+                    return;
+                }
+                if (it->second.isParsed && !it->second.parser->finish()) {
+                    DSU_LOG_WARN("Parsing " << name << " error!");
+                }
+                m_segmentedFetches.erase(it);
+                finishFetch(name);
+            }
+            
+            // a segment could not be fetched: handled like a timeout of the object, which is fetched again whole
+            void onSegmentedFetchFailed(const Name& name)
+            {
+                m_segmentedFetches.erase(name);
+                abandonVerification(name);
+                DSU_LOG_INFO("Could not fetch all segments of " << name);
+                if (getFetchKind(name) == FETCH_UPDATE_INFO) {
+                    onUpdateInfoTimeout(Interest(name), time::steady_clock::now());
+                } else {
+                    onCatalogTimeout(Interest(name), time::steady_clock::now());
+                }
+            }
+            
+            void onCatalogTimeout (const Interest& interest, const time::steady_clock::TimePoint& sentAt)
+            {
+                m_metrics.getFetch(getFetchKind(interest.getName())).timeouts.increment();
+                name::Component user_id = interest.getName().get(2);
+                
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                int* retry = 0;
+                if (pending != 0) {
+                    retry = pending->find(makeFetchKey(interest.getName()));
+                    if (retry == 0) {
+                        DSU_LOG_DEBUG("I didn't try to retrieve " << interest);
+                        return;
+                    }
+                } else {
+                    //figure out what to do here
+                    return;
+                }
+                
+                getRttEstimator(user_id).onTimeout(sentAt);
+                int catalogRetry = *retry;
+                if(catalogRetry == 3) {
+                    DSU_LOG_INFO("Timeout " << interest);
+                    catalogRetry = 0;
+                } else {
+                    scheduleRetry(interest.getName());
+                    catalogRetry++;
+                }
+                *retry = catalogRetry;
+            }
+            
+            void onDatapointData(const Interest& interest, const Data& data,
+                                 const time::steady_clock::TimePoint& sentAt)
+            {
+                recordFetchData(interest.getName(), sentAt);
+                const Block& content = data.getContent();
+                logPayload(data);
+                if (!isValidJson(content))
+                {
+                    DSU_LOG_WARN("Parsing " << data.getName() << " error!");
+                }
+                
+                name::Component user_id = interest.getName().get(2);
+                
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                if (pending != 0) {
+                    measureRtt(*pending, user_id, makeFetchKey(interest.getName()), sentAt);
+                } else {
+                    //figure out what to do here
+                    return;
+                }
+                
+                // add into confirm set
+//                std::map<name::Component, std::set<Name>>::iterator it_confirm;
+//                it_confirm = user_confirm_map.find(user_id);
+//                if (it_confirm != user_confirm_map.end()) {
+//                    it_confirm->second.insert(interest.getName());
+//                }
+                
+                //put data into repo
+                insertIntoRepo(data);
+                finishFetch(interest.getName());
+            }
+            
+            void onDatapointTimeout (const Interest& interest, const time::steady_clock::TimePoint& sentAt)
+            {
+                m_metrics.getFetch(getFetchKind(interest.getName())).timeouts.increment();
+                name::Component user_id = interest.getName().get(2);
+                
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                int* retry = 0;
+                if (pending != 0) {
+                    retry = pending->find(makeFetchKey(interest.getName()));
+                    if (retry == 0) {
+                        DSU_LOG_DEBUG("I didn't try to retrieve " << interest);
+                        return;
+                    }
+                } else {
+                    //figure out what to do here
+                    return;
+                }
+                
+                getRttEstimator(user_id).onTimeout(sentAt);
+                int datapointRetry = *retry;
+                if(datapointRetry == 3) {
+                    DSU_LOG_INFO("Timeout " << interest);
+                    datapointRetry = 0;
+                } else {
+                    scheduleRetry(interest.getName());
+                    datapointRetry++;
+                }
+                *retry = datapointRetry;
+            }
+            
+            RttEstimator&
+            getRttEstimator(const name::Component& user_id)
+            {
+                std::map<name::Component, RttEstimator>::iterator it = m_rttEstimators.find(user_id);
+                if (it == m_rttEstimators.end()) {
+                    it = m_rttEstimators.insert(std::make_pair(user_id,
+                                                               RttEstimator(time::milliseconds(RTO_INITIAL_MILLISECONDS),
+                                                                            time::milliseconds(RTO_MIN_MILLISECONDS),
+                                                                            time::milliseconds(RTO_MAX_MILLISECONDS)))).first;
+                }
+                return it->second;
+            }
+            
+            // RTT sample from an answered Interest, unless it was retransmitted (Karn's algorithm)
+            void
+            measureRtt(PendingFetchSet& pending, const name::Component& user_id, const FetchKey& key,
+                       const time::steady_clock::TimePoint& sentAt)
+            {
+                int* retry = pending.find(key);
+                if (retry != 0 && *retry == 0) {
+                    getRttEstimator(user_id).addMeasurement(time::steady_clock::now() - sentAt);
+                }
+            }
+            
+            // express a timed-out Interest again after a jittered delay that grows while the phone stays silent
+            void
+            scheduleRetry(const Name& name)
+            {
+                scheduleRetry(name, getRttEstimator(name.get(2)).getBackoffCount());
+            }
+            
+            // the delay doubles with every one of @p nBackoffs
+            void
+            scheduleRetry(const Name& name, int nBackoffs)
+            {
+                time::milliseconds delay(RETRY_DELAY_BASE_MILLISECONDS << std::min(std::max(nBackoffs - 1, 0), 20));
+                delay = std::min<time::milliseconds>(delay, time::seconds(RETRY_DELAY_MAX_SECONDS));
+                delay = delay / 2 + time::milliseconds(generateRandomWord() % (delay.count() / 2 + 1));
+                m_scheduler.scheduleEvent(delay, bind(&DSUsync::retryFetch, this, name));
+            }
+            
+            void
+            retryFetch(const Name& name)
+            {
+                // the fetch may have completed or been dropped in the meantime
+                PendingFetchSet* pending = m_pendingFetches.getUser(name.get(2));
+                if (pending == 0 || pending->find(makeFetchKey(name)) == 0) {
+                    return;
+                }
+                m_metrics.getFetch(getFetchKind(name)).retries.increment();
+                if (name.get(7) == UPDATA_INFO_COMP) {
+                    expressUpdateInfoInterest(name);
+                } else {
+                    expressFetchInterest(name);
+                }
+            }
+            
+            // express a re-registered user's pending fetches that are neither queued nor in flight,
+            // a burst at a time so that a large backlog does not flood the user's queue
+            void
+            resumeFetches(const name::Component& user_id)
+            {
+                std::map<name::Component, std::deque<FetchKey>>::iterator it = m_resumeQueues.find(user_id);
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                if (it == m_resumeQueues.end()) {
+                    return;
+                }
+                std::deque<FetchKey>& keys = it->second;
+                while (pending != 0 && !keys.empty() && !m_repo.isSaturated() &&
+                       m_interestScheduler.getQueueDepth(user_id) < RESUME_BURST) {
+                    FetchKey key = keys.front();
+                    keys.pop_front();
+                    Name name = m_fetchNames.makeName(user_id, key);
+                    // completed since the walk, still outstanding, or fetched and being verified
+                    if (pending->find(key) == 0 || m_outstanding.contains(name) || m_verifyingObjects.count(name) > 0) {
+                        continue;
+                    }
+                    expressFetchInterest(name);
+                }
+                if (pending == 0 || keys.empty()) {
+                    m_resumeQueues.erase(it);
+                    return;
+                }
+                m_scheduler.scheduleEvent(time::milliseconds(RESUME_INTERVAL_MILLISECONDS),
+                                          bind(&DSUsync::resumeFetches, this, user_id));
+            }
+            
+            void
+            recordFetchData(const Name& name, const time::steady_clock::TimePoint& sentAt)
+            {
+                Metrics::FetchMetrics& fetch = m_metrics.getFetch(getFetchKind(name));
+                fetch.dataReceived.increment();
+                fetch.latency.record(time::steady_clock::now() - sentAt);
+                noteUserActivity(name.get(2));
+            }
+            
+            // the phone of a user in memory was heard from
+            void
+            noteUserActivity(const name::Component& user_id)
+            {
+                if (m_pendingFetches.hasUser(user_id)) {
+                    m_userActivity.touch(user_id, time::steady_clock::now());
+                }
+            }
+            
+            // seconds of the wall clock, the clock pending fetches are stamped with; it is kept in the
+            // journal and the spill files, so that the age of a fetch survives restarts and evictions
+            static uint32_t
+            getPendingClock()
+            {
+                return static_cast<uint32_t>(time::toUnixTimestamp(time::system_clock::now()).count() / 1000);
+            }
+            
+            // estimated heap bytes held for @p user_id: pending fetches, update_info window,
+            // RTT estimator, resume walk and the entries of the tables they are kept in
+            size_t
+            getUserMemoryUsage(const name::Component& user_id, const PendingFetchSet& pending) const
+            {
+                size_t usage = pending.getMemoryUsage() + sizeof(PendingFetchSet) +
+                               sizeof(UpdateInfoWindow) + sizeof(RttEstimator) +
+                               5 * (NODE_OVERHEAD_BYTES + user_id.size());
+                std::map<name::Component, UpdateInfoWindow>::const_iterator window_it = m_updateInfoWindows.find(user_id);
+                if (window_it != m_updateInfoWindows.end()) {
+                    usage += window_it->second.getInFlight() * NODE_OVERHEAD_BYTES;
+                }
+                std::map<name::Component, std::deque<FetchKey>>::const_iterator resume_it = m_resumeQueues.find(user_id);
+                if (resume_it != m_resumeQueues.end()) {
+                    usage += resume_it->second.size() * sizeof(FetchKey);
+                }
+                return usage;
+            }
+            
+            size_t
+            getMemoryUsage() const
+            {
+                size_t total = 0;
+                m_pendingFetches.forEachUser([&] (const name::Component& user_id, const PendingFetchSet& pending) {
+                    total += getUserMemoryUsage(user_id, pending);
+                });
+                return total;
+            }
+            
+            void
+            onMemorySweepTimer()
+            {
+                expirePendingFetches();
+                evictUsers();
+                m_scheduler.scheduleEvent(time::seconds(MEMORY_SWEEP_INTERVAL_SECONDS),
+                                          bind(&DSUsync::onMemorySweepTimer, this));
+            }
+            
+            // drop catalog and datapoint fetches that have not completed within the TTL; their retries
+            // ran out long ago and the phone did not come back with them. update_info fetches are
+            // kept in flight by the window and go away with their user.
+            void
+            expirePendingFetches()
+            {
+                uint32_t now = getPendingClock();
+                if (m_pendingTtl == 0 || now < m_pendingTtl) {
+                    return;
+                }
+                std::vector<std::pair<name::Component, FetchKey>> expired;
+                std::vector<FetchKey> keys;
+                m_pendingFetches.forEachUser([&] (const name::Component& user_id, const PendingFetchSet& pending) {
+                    keys.clear();
+                    pending.collectExpired(now - m_pendingTtl, keys);
+                    for (size_t i = 0; i < keys.size(); i++) {
+                        if (keys[i].kind != FETCH_UPDATE_INFO) {
+                            expired.push_back(std::make_pair(user_id, keys[i]));
+                        }
+                    }
+                });
+                for (size_t i = 0; i < expired.size(); i++) {
+                    PendingFetchSet* pending = m_pendingFetches.getUser(expired[i].first);
+                    removePendingFetch(*pending, expired[i].first, expired[i].second);
+                }
+                if (!expired.empty()) {
+                    m_metrics.pendingExpired.increment(expired.size());
+                    DSU_LOG_INFO("Expired " << expired.size() << " fetches pending for more than "
+                                 << m_pendingTtl << " s");
+                }
+            }
+            
+            // evict the users idle for too long, then the least recently active ones while over the budget
+            void
+            evictUsers()
+            {
+                time::steady_clock::TimePoint now = time::steady_clock::now();
+                while (m_userIdleTimeout > 0 && !m_userActivity.empty() &&
+                       now - m_userActivity.getLeastRecentTime() >= time::seconds(m_userIdleTimeout)) {
+                    evictUser(name::Component(m_userActivity.getLeastRecentUser()));
+                }
+                if (m_memoryBudget == 0) {
+                    return;
+                }
+                size_t usage = getMemoryUsage();
+                while (usage > m_memoryBudget && !m_userActivity.empty()) {
+                    if (now - m_userActivity.getLeastRecentTime() < time::seconds(EVICTION_MIN_IDLE_SECONDS)) {
+                        DSU_LOG_WARN("Users active in the last " << EVICTION_MIN_IDLE_SECONDS << " s hold "
+                                     << usage << " bytes, more than the memory budget");
+                        return;
+                    }
+                    name::Component user_id = m_userActivity.getLeastRecentUser();
+                    const PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                    usage -= pending != 0 ? std::min(usage, getUserMemoryUsage(user_id, *pending)) : 0;
+                    evictUser(user_id);
+                }
+            }
+            
+            // forget everything held in memory about @p user_id, writing it to the spill directory first
+            void
+            evictUser(const name::Component& user_id)
+            {
+                PendingFetchSet* pending = m_pendingFetches.getUser(user_id);
+                bool isSpilled = false;
+                if (pending != 0 && m_spillStore != nullptr) {
+                    std::map<name::Component, UpdateInfoWindow>::iterator window_it = m_updateInfoWindows.find(user_id);
+                    uint64_t nextSeqNo = window_it != m_updateInfoWindows.end() ? window_it->second.getNextExpected() : 1;
+                    try {
+                        m_spillStore->save(user_id, *pending, nextSeqNo);
+                        isSpilled = true;
+                        m_metrics.usersSpilled.increment();
+                    }
+                    catch (const UserSpillStore::Error& e) {
+                        // evicted all the same, the user syncs again from the start
+                        DSU_LOG_ERROR(e.what());
+                    }
+                }
+                if (pending != 0 && m_journal != nullptr) {
+                    m_journal->removeUser(user_id);
+                }
+                m_journalProgress.erase(user_id);
+                m_pendingFetches.removeUser(user_id);
+                m_updateInfoWindows.erase(user_id);
+                m_rttEstimators.erase(user_id);
+                m_resumeQueues.erase(user_id);
+                m_interestScheduler.removeUser(user_id);
+                m_fetchNames.removeUser(user_id);
+                if (m_verifier != nullptr) {
+                    m_verifier->removeKeys(Name(COMMON_PREFIX).append(user_id));
+                }
+                m_userActivity.remove(user_id);
+                m_metrics.usersEvicted.increment();
+                DSU_LOG_INFO("Evicted user " << user_id << (isSpilled ? ", spilled to disk" : ""));
+            }
+            
+            // add to a user in memory the pending fetches it lacks, and move its update_info window
+            // forward to @p nextSeqNo if it is behind
+            void
+            mergeUser(const name::Component& user_id, const std::vector<UserSpillStore::Entry>& entries,
+                      uint64_t nextSeqNo)
+            {
+                PendingFetchSet& pending = *m_pendingFetches.getUser(user_id);
+                std::deque<FetchKey>& queue = m_resumeQueues[user_id];
+                bool isResuming = !queue.empty();
+                size_t nAdded = 0;
+                for (size_t i = 0; i < entries.size(); i++) {
+                    if (pending.find(entries[i].key) == 0) {
+                        addPendingFetch(pending, user_id, entries[i].key, entries[i].insertedAt);
+                        queue.push_back(entries[i].key);
+                        nAdded++;
+                    }
+                }
+                
+                std::map<name::Component, UpdateInfoWindow>::iterator window_it = m_updateInfoWindows.find(user_id);
+                if (window_it != m_updateInfoWindows.end() && window_it->second.getNextExpected() < nextSeqNo) {
+                    // what was fetched below nextSeqNo since the user started here was synced before
+                    std::vector<FetchKey> behind;
+                    pending.forEach([&] (const FetchKey& key, int retry) {
+                        if (key.kind == FETCH_UPDATE_INFO && key.id < nextSeqNo) {
+                            behind.push_back(key);
+                        }
+                    });
+                    for (size_t i = 0; i < behind.size(); i++) {
+                        removePendingFetch(pending, user_id, behind[i]);
+                    }
+                    window_it->second = UpdateInfoWindow(nextSeqNo, UPDATE_INFO_INITIAL_WINDOW, UPDATE_INFO_MAX_WINDOW);
+                    if (m_journal != nullptr) {
+                        m_journal->setProgress(user_id, nextSeqNo);
+                        m_journalProgress[user_id] = nextSeqNo;
+                    }
+                    fillUpdateInfoWindow(user_id);
+                }
+                
+                if (queue.empty()) {
+                    m_resumeQueues.erase(user_id);
+                } else if (!isResuming) {
+                    resumeFetches(user_id);
+                }
+                DSU_LOG_INFO("Merged " << nAdded << " pending fetches into user " << user_id << ", update_info from "
+                             << (window_it != m_updateInfoWindows.end() ? window_it->second.getNextExpected() : 1));
+            }
+            
+            // bring a spilled user back into memory and the journal
+            bool
+            reloadUser(const name::Component& user_id)
+            {
+                std::vector<UserSpillStore::Entry> entries;
+                uint64_t nextSeqNo = 1;
+                if (m_spillStore == nullptr || !m_spillStore->take(user_id, entries, nextSeqNo, getPendingClock())) {
+                    return false;
+                }
+                PendingFetchSet& pending = m_pendingFetches.addUser(user_id);
+                if (m_journal != nullptr) {
+                    m_journal->addUser(user_id);
+                    m_journal->setProgress(user_id, nextSeqNo);
+                    m_journalProgress[user_id] = nextSeqNo;
+                }
+                // the fetches keep their age, so that those abandoned still expire
+                for (size_t i = 0; i < entries.size(); i++) {
+                    addPendingFetch(pending, user_id, entries[i].key, entries[i].insertedAt);
+                }
+                m_updateInfoWindows.insert(std::make_pair(user_id,
+                                                          UpdateInfoWindow(nextSeqNo, UPDATE_INFO_INITIAL_WINDOW,
+                                                                           UPDATE_INFO_MAX_WINDOW)));
+                m_metrics.usersReloaded.increment();
+                DSU_LOG_INFO("Reloaded user " << user_id << " with " << entries.size() << " pending fetches, "
+                             "update_info from " << nextSeqNo);
+                return true;
+            }
+            
+            // replace the metrics file, so that readers never see it half written
+            void
+            onMetricsTimer()
+            {
+                std::string temporaryPath = m_metricsPath + ".tmp";
+                {
+                    std::ofstream file(temporaryPath.c_str(), std::ios::trunc);
+                    file << makeMetricsReport(SIZE_MAX) << std::endl;
+                }
+                if (std::rename(temporaryPath.c_str(), m_metricsPath.c_str()) != 0) {
+                    DSU_LOG_ERROR("Cannot write metrics to " << m_metricsPath);
+                }
+                m_scheduler.scheduleEvent(m_metricsInterval, bind(&DSUsync::onMetricsTimer, this));
+            }
+            
+            void
+            logPayload(const Data& data)
+            {
+                const Block& content = data.getContent();
+                DSU_LOG_TO(g_payloadLog, LOG_TRACE, data.getName() << " "
+                           << std::string(reinterpret_cast<const char*>(content.value()), content.value_size()));
+            }
+            
+            void
+            putSignedData(const shared_ptr<Data>& data)
+            {
+                DSU_LOG_DEBUG(">> D: " << *data);
+                m_face.put(*data);
+            }
+            
+            // rebuild users, pending fetches and update_info progress from the journal
+            void
+            openJournal(const std::string& path, size_t nShards, int compactionInterval)
+            {
+                time::steady_clock::TimePoint start = time::steady_clock::now();
+                m_journal.reset(new SyncJournal(path, nShards));
+                SyncJournal::ProgressMap progress;
+                size_t nRecords = m_journal->load(m_pendingFetches, progress, getPendingClock());
+                
+                time::steady_clock::TimePoint now = time::steady_clock::now();
+                m_pendingFetches.forEachUser([&] (const name::Component& user_id, const PendingFetchSet& pending) {
+                    // idle time counts from the restart
+                    m_userActivity.touch(user_id, now);
+                    SyncJournal::ProgressMap::iterator it = progress.find(user_id);
+                    uint64_t nextSeqNo = it != progress.end() ? it->second : 1;
+                    m_updateInfoWindows.insert(std::make_pair(user_id,
+                                                              UpdateInfoWindow(nextSeqNo, UPDATE_INFO_INITIAL_WINDOW,
+                                                                               UPDATE_INFO_MAX_WINDOW)));
+                });
+                m_journalProgress.swap(progress);
+                compactJournal();
+                
+                DSU_LOG_INFO("Restored " << m_pendingFetches.getUserCount() << " users and "
+                             << m_pendingFetches.size() << " pending fetches from " << nRecords << " journal records in "
+                             << time::duration_cast<time::milliseconds>(time::steady_clock::now() - start).count() << " ms");
+                
+                m_compactionInterval = time::seconds(compactionInterval);
+                m_scheduler.scheduleEvent(time::seconds(JOURNAL_FLUSH_INTERVAL_SECONDS),
+                                          bind(&DSUsync::onJournalFlushTimer, this));
+                m_scheduler.scheduleEvent(m_compactionInterval, bind(&DSUsync::onJournalCompactionTimer, this));
+            }
+            
+            void
+            compactJournal()
+            {
+                try {
+                    m_journal->compact(m_pendingFetches, m_journalProgress);
+                }
+                catch (const SyncJournal::Error& e) {
+                    DSU_LOG_ERROR(e.what());
+                }
+            }
+            
+            void
+            onJournalFlushTimer()
+            {
+                m_journal->flush();
+                m_scheduler.scheduleEvent(time::seconds(JOURNAL_FLUSH_INTERVAL_SECONDS),
+                                          bind(&DSUsync::onJournalFlushTimer, this));
+            }
+            
+            void
+            onJournalCompactionTimer()
+            {
+                compactJournal();
+                m_scheduler.scheduleEvent(m_compactionInterval, bind(&DSUsync::onJournalCompactionTimer, this));
+            }
+            
+            // update_info fetches are covered by the window progress and are not journaled
+            void
+            addPendingFetch(PendingFetchSet& pending, const name::Component& user_id, const FetchKey& key)
+            {
+                addPendingFetch(pending, user_id, key, getPendingClock());
+            }
+            
+            void
+            addPendingFetch(PendingFetchSet& pending, const name::Component& user_id, const FetchKey& key,
+                            uint32_t insertedAt)
+            {
+                pending.insert(key, insertedAt) = 0;
+                if (m_journal != nullptr && key.kind != FETCH_UPDATE_INFO) {
+                    m_journal->addPending(user_id, key, insertedAt);
+                }
+            }
+            
+            void
+            removePendingFetch(PendingFetchSet& pending, const name::Component& user_id, const FetchKey& key)
+            {
+                if (pending.erase(key) && m_journal != nullptr && key.kind != FETCH_UPDATE_INFO) {
+                    m_journal->removePending(user_id, key);
+                }
+            }
+            
+        private:
+            boost::asio::io_service& m_ioService;
+            FaceEndpoint& m_face;
+            Scheduler m_scheduler;
+            InterestScheduler m_interestScheduler;
+            OutstandingInterestTable m_outstanding;
+            RepoClient m_repo;
+            RepoQueryEngine m_repoQueries;
+            StoredNameIndex m_storedNames;
+            FetchNameCache m_fetchNames;
+            // catalog and datapoint fetches held back while the repo connections are saturated,
+            // in the order they were deferred; at most one per pending fetch
+            std::deque<Name> m_deferredFetches;
+            std::set<Name> m_deferredNames;
+            // an update_info or catalog object that comes in several segments
+            struct SegmentedFetch
+            {
+                shared_ptr<SegmentPipeline> pipeline;
+                shared_ptr<SegmentedContentParser> parser;
+                // false once the content turned out to be invalid, the segments are still stored
+                bool isParsed;
+            };
+            // by the name of the object, from its first segment until its last one
+            std::map<Name, SegmentedFetch> m_segmentedFetches;
+            // an object with packets in the verifier, it stays pending until they are all verified;
+            // also one with a packet the repo connections refused
+            struct VerifyingObject
+            {
+                VerifyingObject()
+                : nPackets(0)
+                , isComplete(false)
+                , isAbandoned(false)
+                , hasBadSignature(false)
+                , hasNoCertificate(false)
+                , isRefused(false)
+                {
+                }
+                
+                // seconds to wait before fetching the object again, 0 if it is done with;
+                // one with a bad signature is dropped
+                int
+                getRetryDelay() const
+                {
+                    if (hasBadSignature) {
+                        return 0;
+                    }
+                    if (hasNoCertificate) {
+                        return UNVERIFIED_RETRY_DELAY_SECONDS;
+                    }
+                    return isRefused ? REFUSED_RETRY_DELAY_SECONDS : 0;
+                }
+                
+                size_t nPackets;
+                // finishFetch() was called, every packet has been passed to the verifier
+                bool isComplete;
+                // the fetch failed before it was complete, forgotten once its packets are verified
+                bool isAbandoned;
+                bool hasBadSignature;
+                bool hasNoCertificate;
+                bool isRefused;
+            };
+            // by the name of the object
+            std::map<Name, VerifyingObject> m_verifyingObjects;
+            // fetches of re-registered users still to be expressed again, see resumeFetches()
+            std::map<name::Component, std::deque<FetchKey>> m_resumeQueues;
+            PendingFetchTable m_pendingFetches;
+            std::map<name::Component, UpdateInfoWindow> m_updateInfoWindows;
+            std::map<name::Component, RttEstimator> m_rttEstimators;
+//            std::map<name::Component, std::set<Name>> user_confirm_map;
+            KeyChain m_keyChain;
+            security::SigningInfo m_registrationSigning;
+            security::SigningInfo m_confirmationSigning;
+            unique_ptr<SigningPool> m_signingPool;
+            unique_ptr<DataVerifier> m_verifier;
+            unique_ptr<SyncJournal> m_journal;
+            // last update_info progress written to the journal, kept for compaction
+            SyncJournal::ProgressMap m_journalProgress;
+            time::nanoseconds m_compactionInterval;
+            Metrics m_metrics;
+            std::string m_metricsPath;
+            time::nanoseconds m_metricsInterval;
+            // users in memory, by the last time their phone was heard from
+            UserActivityList m_userActivity;
+            unique_ptr<UserSpillStore> m_spillStore;
+            size_t m_memoryBudget;
+            int m_userIdleTimeout;
+            uint32_t m_pendingTtl;
+        };
+
+        /**
+         * @brief Owns the Face and hands incoming Interests to the sync engines
+         *
+         * Without shards, one engine runs on the Face's thread. With N shards, each shard runs an
+         * engine of its own on its own thread, with its own pending state, journal and repo
+         * connections, and a user always goes to the shard picked by the hash of its user_id.
+         * The Face's thread then only hands Interests to the shards and expresses or puts the
+         * packets they send, through a pair of lock-free queues per shard.
+         *
+         * In a cluster, every instance registers the same prefixes, and users are split among the
+         * instances by a ConsistentHashRing of the member list. A register or confirm Interest
+         * for a user owned by another instance is forwarded to it under CLUSTER_PREFIX, and its
+         * reply, still signed by the owner, comes back wrapped in a Data packet; a forwarded
+         * request is always handled where it arrives, so it is forwarded once at most. When the
+         * member list changes, every instance evicts the users it no longer owns into its spill
+         * directory and tells the new owner of every user there it no longer owns, which fetches
+         * the spilled state and loads it on the user's next register Interest, or merges it into
+         * the user if its phone registered there first. An instance is removed by taking it off the list
+         * and stopping it once it has handed its users over.
+         */
+        class DSUServer : noncopyable
+        {
+        public:
+            explicit
+            DSUServer(const Options& options = Options())
+            : m_face(m_ioService)
+            , m_scheduler(m_ioService)
+            , m_clusterName(options.clusterName)
+            , m_membersPath(options.clusterMembersPath)
+            {
+                if (!m_clusterName.empty()) {
+                    if (options.spillDirectory.empty()) {
+                        throw std::invalid_argument("users are handed over through the spill directory, "
+                                                    "a cluster needs one");
+                    }
+                    std::vector<std::string> members = readMembers();
+                    if (members.empty()) {
+                        throw std::invalid_argument("no cluster members in " + m_membersPath);
+                    }
+                    m_ring = make_shared<ConsistentHashRing>(members);
+                    m_clusterPrefix = Name(CLUSTER_PREFIX).append(name::Component(m_clusterName));
+                }
+                
+                // the journals of a run with or without shards are not even looked at by the other
+                if (!options.journalPath.empty()) {
+                    std::string otherPath = options.nShards == 0 ? options.journalPath + ".0" : options.journalPath;
+                    if (std::ifstream(otherPath.c_str()).good()) {
+                        throw std::invalid_argument(otherPath + " was written " +
+                                                    (options.nShards == 0 ? "with" : "without") +
+                                                    " --shards, its users would not be restored; restart as "
+                                                    "before or move the journals and spill directories away");
+                    }
+                }
+                
+                FaceEndpoint::PutCallback put = bind(&DSUServer::putReply, this, _1);
+                if (options.nShards == 0) {
+                    m_directFace.reset(new DirectFaceEndpoint(m_face, put));
+                    m_engine.reset(new DSUsync(m_ioService, *m_directFace, options));
+                    return;
+                }
+                // one after the other, engines create the ECDSA identity and open their files
+                for (size_t i = 0; i < options.nShards; i++) {
+                    m_shards.push_back(unique_ptr<Shard>(new Shard(m_face, m_ioService, put)));
+                    Shard& shard = *m_shards.back();
+                    shard.engine.reset(new DSUsync(shard.ioService, shard.endpoint, makeShardOptions(options, i)));
+                }
+                for (size_t i = 0; i < m_shards.size(); i++) {
+                    m_shards[i]->thread = std::thread(&DSUServer::runShard, this, std::ref(*m_shards[i]));
+                }
+                DSU_LOG_INFO("Running " << m_shards.size() << " shards");
+            }
+            
+            ~DSUServer()
+            {
+                for (size_t i = 0; i < m_shards.size(); i++) {
+                    m_shards[i]->ioService.stop();
+                }
+                for (size_t i = 0; i < m_shards.size(); i++) {
+                    if (m_shards[i]->thread.joinable()) {
+                        m_shards[i]->thread.join();
+                    }
+                }
+            }
+            
+            /**
+             * @brief Register the prefixes and process events until an engine fails
+             * @throw the exception that stopped a shard
+             */
+            void
+            run()
+            {
+                //accept incoming confirm interest
+                m_face.setInterestFilter(CONFIRM_PREFIX,
+                                         bind(&DSUServer::onUserInterest, this, _2, &DSUsync::onConfirmInterest),
+                                         RegisterPrefixSuccessCallback(),
+                                         bind(&DSUServer::onRegisterFailed, this, _1, _2));
+                
+                //accept incoming register interest
+                m_face.setInterestFilter(REGISTER_PREFIX,
+                                         bind(&DSUServer::onUserInterest, this, _2, &DSUsync::onRegisterInterest),
+                                         RegisterPrefixSuccessCallback(),
+                                         bind(&DSUServer::onRegisterFailed, this, _1, _2));
+                
+                //accept incoming status interest
+                m_face.setInterestFilter(STATUS_PREFIX,
+                                         bind(&DSUServer::onStatusInterest, this),
+                                         RegisterPrefixSuccessCallback(),
+                                         bind(&DSUServer::onRegisterFailed, this, _1, _2));
+                
+                if (m_ring != nullptr) {
+                    //accept requests, handoffs and state fetches from the other instances
+                    m_face.setInterestFilter(m_clusterPrefix,
+                                             bind(&DSUServer::onClusterInterest, this, _2),
+                                             RegisterPrefixSuccessCallback(),
+                                             bind(&DSUServer::onRegisterFailed, this, _1, _2));
+                    logMembers();
+                    // users restored from the journal may belong elsewhere since the last run
+                    rebalance();
+                    m_scheduler.scheduleEvent(time::seconds(CLUSTER_POLL_INTERVAL_SECONDS),
+                                              bind(&DSUServer::onClusterTimer, this));
+                }
+                
+                // m_ioService.run() will block until all events finished or m_ioService.stop() is called
+                m_ioService.run();
+                
+                for (size_t i = 0; i < m_shards.size(); i++) {
+                    if (m_shards[i]->error) {
+                        std::rethrow_exception(m_shards[i]->error);
+                    }
+                }
+            }
+            
+        private:
+            struct Shard
+            {
+                Shard(Face& face, boost::asio::io_service& faceIoService, const FaceEndpoint::PutCallback& put)
+                : work(ioService)
+                , toFace(faceIoService)
+                , toShard(ioService)
+                , endpoint(face, toFace, toShard, put)
+                {
+                }
+                
+                boost::asio::io_service ioService;
+                // keeps the shard's thread running while it waits for Interests
+                boost::asio::io_service::work work;
+                // filled by the shard's thread, drained on the Face's thread
+                Mailbox toFace;
+                // filled by the Face's thread, drained on the shard's thread
+                Mailbox toShard;
+                ShardFaceEndpoint endpoint;
+                unique_ptr<DSUsync> engine;
+                std::thread thread;
+                // what stopped the shard, rethrown by run()
+                std::exception_ptr error;
+            };
+            
+            // metrics of the shards gathered for one status Interest
+            struct StatusReports
+            {
+                std::vector<std::string> reports;
+                size_t nMissing;
+            };
+            
+            // a request forwarded here, by the name of the Interest it is for
+            struct ForwardedRequest
+            {
+                Name forwardedName;
+                time::steady_clock::TimePoint expiry;
+            };
+            
+            // the state of a user handed over, while the new owner fetches it
+            struct OutgoingState
+            {
+                shared_ptr<const std::vector<uint8_t>> state;
+                time::steady_clock::TimePoint expiry;
+            };
+            
+            // every shard keeps its own files; the memory budget is split evenly
+            static Options
+            makeShardOptions(const Options& options, size_t index)
+            {
+                std::string suffix = "." + std::to_string(index);
+                Options shardOptions(options);
+                if (!options.journalPath.empty()) {
+                    shardOptions.journalPath += suffix;
+                }
+                if (!options.metricsPath.empty()) {
+                    shardOptions.metricsPath += suffix;
+                }
+                if (!options.spillDirectory.empty()) {
+                    shardOptions.spillDirectory += suffix;
+                }
+                shardOptions.memoryBudget = (options.memoryBudget + options.nShards - 1) / options.nShards;
+                return shardOptions;
+            }
+            
+            void
+            runShard(Shard& shard)
+            {
+                try {
+                    shard.ioService.run();
+                }
+                catch (...) {
+                    shard.error = std::current_exception();
+                    m_ioService.stop();
+                }
+            }
+            
+            // FNV-1a, the shard of a user must not change from one run to the next
+            size_t
+            getShardIndex(const name::Component& user) const
+            {
+                uint32_t hash = 2166136261u;
+                for (size_t i = 0; i < user.value_size(); i++) {
+                    hash = (hash ^ user.value()[i]) * 16777619u;
+                }
+                return hash % m_shards.size();
+            }
+            
+            size_t
+            getEngineIndex(const name::Component& user) const
+            {
+                return m_engine != nullptr ? 0 : getShardIndex(user);
+            }
+            
+            size_t
+            getEngineCount() const
+            {
+                return m_engine != nullptr ? 1 : m_shards.size();
+            }
+            
+            // run @p task on the thread of engine @p index, then @p onResult on the Face's thread
+            template<typename Result>
+            void
+            askEngine(size_t index, const function<Result(DSUsync&)>& task,
+                      const function<void(const Result&)>& onResult)
+            {
+                if (m_engine != nullptr) {
+                    Result result = task(*m_engine);
+                    if (onResult) {
+                        onResult(result);
+                    }
+                    return;
+                }
+                Shard& shard = *m_shards[index];
+                shard.toShard.post(bind(&DSUServer::runOnShard<Result>, std::ref(shard), task, onResult));
+            }
+            
+            template<typename Result>
+            static void
+            runOnShard(Shard& shard, const function<Result(DSUsync&)>& task,
+                       const function<void(const Result&)>& onResult)
+            {
+                Result result = task(*shard.engine);
+                if (onResult) {
+                    shard.toFace.post(bind(onResult, result));
+                }
+            }
+            
+            void
+            onUserInterest(const Interest& interest, void (DSUsync::*handler)(const Interest&))
+            {
+                if (interest.getName().size() <= INTEREST_USER_INDEX) {
+                    DSU_LOG_DEBUG("Ignoring " << interest.getName() << ", it has no user_id");
+                    return;
+                }
+                const name::Component& user = interest.getName().get(INTEREST_USER_INDEX);
+                if (m_ring != nullptr && !m_ring->isOwner(m_clusterName, user)) {
+                    forwardRequest(interest, m_ring->getOwner(user));
+                    return;
+                }
+                dispatch(interest, handler);
+            }
+            
+            void
+            dispatch(const Interest& interest, void (DSUsync::*handler)(const Interest&))
+            {
+                if (m_engine != nullptr) {
+                    (m_engine.get()->*handler)(interest);
+                    return;
+                }
+                Shard& shard = *m_shards[getShardIndex(interest.getName().get(INTEREST_USER_INDEX))];
+                shard.toShard.post(bind(handler, shard.engine.get(), interest));
+            }
+            
+            // the replies of the engines, wrapped for the instance that forwarded the request
+            void
+            putReply(const Data& data)
+            {
+                std::map<Name, ForwardedRequest>::iterator it = m_forwardedRequests.find(data.getName());
+                if (it == m_forwardedRequests.end()) {
+                    m_face.put(data);
+                    return;
+                }
+                Data wrapper(it->second.forwardedName);
+                wrapper.setContent(data.wireEncode());
+                wrapper.setFreshnessPeriod(time::seconds(1));
+                m_keyChain.sign(wrapper, security::signingWithSha256());
+                m_face.put(wrapper);
+                m_forwardedRequests.erase(it);
+            }
+            
+            static time::milliseconds
+            getClusterLifetime(const Interest& interest)
+            {
+                return interest.getInterestLifetime() > time::milliseconds::zero()
+                       ? interest.getInterestLifetime()
+                       : time::milliseconds(CLUSTER_INTEREST_LIFETIME_MILLISECONDS);
+            }
+            
+            static std::string
+            toString(const name::Component& component)
+            {
+                return std::string(reinterpret_cast<const char*>(component.value()), component.value_size());
+            }
+            
+            void
+            forwardRequest(const Interest& interest, const std::string& owner)
+            {
+                Interest forwarded(Name(CLUSTER_PREFIX).append(name::Component(owner)).append(CLUSTER_REQUEST_COMP)
+                                   .append(interest.getName()));
+                forwarded.setInterestLifetime(getClusterLifetime(interest));
+                forwarded.setMustBeFresh(true);
+                forwarded.setNonce(generateRandomWord());
+                m_face.expressInterest(forwarded,
+                                       bind(&DSUServer::onForwardedReply, this, interest, _2),
+                                       bind(&DSUServer::onForwardTimeout, this, interest, owner));
+            }
+            
+            void
+            onForwardedReply(const Interest& interest, const Data& wrapper)
+            {
+                try {
+                    Data reply(wrapper.getContent().blockFromValue());
+                    if (!interest.matchesData(reply)) {
+                        DSU_LOG_WARN("Reply " << reply.getName() << " does not match " << interest.getName());
+                        return;
+                    }
+                    m_face.put(reply);
+                }
+                catch (const tlv::Error& e) {
+                    DSU_LOG_WARN("Malformed reply to the forwarded " << interest.getName() << ": " << e.what());
+                }
+            }
+            
+            // the Interest is declined, the phone asks again
+            void
+            onForwardTimeout(const Interest& interest, const std::string& owner)
+            {
+                DSU_LOG_DEBUG("Instance " << owner << " did not answer for " << interest.getName());
+            }
+            
+            void
+            onClusterInterest(const Interest& interest)
+            {
+                const Name& name = interest.getName();
+                if (name.size() <= m_clusterPrefix.size() + 1) {
+                    return;
+                }
+                const name::Component& kind = name.get(m_clusterPrefix.size());
+                if (kind == CLUSTER_REQUEST_COMP) {
+                    onForwardedRequest(interest);
+                } else if (kind == CLUSTER_HANDOFF_COMP) {
+                    onHandoffNotice(interest);
+                } else if (kind == CLUSTER_STATE_COMP) {
+                    onStateInterest(interest);
+                }
+            }
+            
+            void
+            onForwardedRequest(const Interest& interest)
+            {
+                Interest request(interest.getName().getSubName(m_clusterPrefix.size() + 1));
+                const Name& name = request.getName();
+                void (DSUsync::*handler)(const Interest&) = 0;
+                if (Name(CONFIRM_PREFIX).isPrefixOf(name)) {
+                    handler = &DSUsync::onConfirmInterest;
+                } else if (Name(REGISTER_PREFIX).isPrefixOf(name)) {
+                    handler = &DSUsync::onRegisterInterest;
+                }
+                if (handler == 0 || name.size() <= INTEREST_USER_INDEX) {
+                    DSU_LOG_DEBUG("Ignoring forwarded " << name);
+                    return;
+                }
+                ForwardedRequest& forwarded = m_forwardedRequests[name];
+                forwarded.forwardedName = interest.getName();
+                forwarded.expiry = time::steady_clock::now() + getClusterLifetime(interest);
+                dispatch(request, handler);
+            }
+            
+            // read the member list, one name per line; blank lines and lines starting with # are skipped
+            std::vector<std::string>
+            readMembers() const
+            {
+                std::vector<std::string> members;
+                std::ifstream file(m_membersPath.c_str());
+                std::string line;
+                while (std::getline(file, line)) {
+                    size_t begin = line.find_first_not_of(" \t\r");
+                    if (begin == std::string::npos || line[begin] == '#') {
+                        continue;
+                    }
+                    members.push_back(line.substr(begin, line.find_last_not_of(" \t\r") + 1 - begin));
+                }
+                return members;
+            }
+            
+            void
+            logMembers()
+            {
+                std::string members;
+                for (size_t i = 0; i < m_ring->getMembers().size(); i++) {
+                    members += (i > 0 ? ", " : "") + m_ring->getMembers()[i];
+                }
+                DSU_LOG_INFO("Cluster members: " << members << (m_ring->hasMember(m_clusterName) ? "" :
+                             "; " + m_clusterName + " is not one of them, it hands all its users over"));
+            }
+            
+            void
+            onClusterTimer()
+            {
+                std::vector<std::string> members = readMembers();
+                std::sort(members.begin(), members.end());
+                members.erase(std::unique(members.begin(), members.end()), members.end());
+                if (members.empty()) {
+                    DSU_LOG_ERROR("No cluster members in " << m_membersPath << ", keeping the previous ones");
+                } else if (members != m_ring->getMembers()) {
+                    m_ring = make_shared<ConsistentHashRing>(members);
+                    logMembers();
+                    rebalance();
+                }
+                
+                time::steady_clock::TimePoint now = time::steady_clock::now();
+                for (std::map<Name, ForwardedRequest>::iterator it = m_forwardedRequests.begin();
+                     it != m_forwardedRequests.end();) {
+                    if (it->second.expiry <= now) {
+                        m_forwardedRequests.erase(it++);
+                    } else {
+                        ++it;
+                    }
+                }
+                for (std::map<name::Component, OutgoingState>::iterator it = m_outgoingStates.begin();
+                     it != m_outgoingStates.end();) {
+                    if (it->second.expiry <= now) {
+                        returnState(it->first, *it->second.state);
+                        m_outgoingStates.erase(it++);
+                    } else {
+                        ++it;
+                    }
+                }
+                m_scheduler.scheduleEvent(time::seconds(CLUSTER_POLL_INTERVAL_SECONDS),
+                                          bind(&DSUServer::onClusterTimer, this));
+            }
+            
+            // evict the users owned elsewhere from every engine, then tell their owners
+            void
+            rebalance()
+            {
+                function<bool(const name::Component&)> isOwned = bind(&ConsistentHashRing::isOwner, m_ring,
+                                                                      m_clusterName, _1);
+                for (size_t i = 0; i < getEngineCount(); i++) {
+                    askEngine<std::vector<name::Component>>(i, bind(&DSUsync::handOffUsers, _1, isOwned),
+                                                            bind(&DSUServer::onUsersHandedOff, this, _1));
+                }
+            }
+            
+            void
+            onUsersHandedOff(const std::vector<name::Component>& users)
+            {
+                if (!users.empty()) {
+                    DSU_LOG_INFO("Handing " << users.size() << " users over to their new owners");
+                }
+                for (size_t i = 0; i < users.size(); i++) {
+                    sendHandoffNotice(users[i], 0);
+                }
+            }
+            
+            void
+            sendHandoffNotice(const name::Component& user, int nRetries)
+            {
+                const std::string& owner = m_ring->getOwner(user);
+                if (owner == m_clusterName) {
+                    // the ring changed back, the user is reloaded from the spill directory here
+                    return;
+                }
+                Interest notice(Name(CLUSTER_PREFIX).append(name::Component(owner)).append(CLUSTER_HANDOFF_COMP)
+                                .append(name::Component(m_clusterName)).append(user).appendVersion());
+                notice.setInterestLifetime(time::milliseconds(CLUSTER_INTEREST_LIFETIME_MILLISECONDS));
+                notice.setNonce(generateRandomWord());
+                m_face.expressInterest(notice,
+                                       bind(&DSUServer::onHandoffAck, this, user, owner),
+                                       bind(&DSUServer::onHandoffTimeout, this, user, nRetries));
+            }
+            
+            void
+            onHandoffAck(const name::Component& user, const std::string& owner)
+            {
+                m_outgoingStates.erase(user);
+                DSU_LOG_INFO("Handed user " << user << " over to " << owner);
+            }
+            
+            void
+            onHandoffTimeout(const name::Component& user, int nRetries)
+            {
+                if (nRetries + 1 < HANDOFF_MAX_RETRIES) {
+                    sendHandoffNotice(user, nRetries + 1);
+                    return;
+                }
+                DSU_LOG_WARN("Could not hand user " << user << " over, it syncs again from the start at its new owner");
+            }
+            
+            // the new owner of a user is told to fetch its state
+            void
+            onHandoffNotice(const Interest& interest)
+            {
+                const Name& name = interest.getName();
+                if (name.size() < m_clusterPrefix.size() + 3) {
+                    return;
+                }
+                std::string from = toString(name.get(m_clusterPrefix.size() + 1));
+                name::Component user = name.get(m_clusterPrefix.size() + 2);
+                Interest stateInterest(Name(CLUSTER_PREFIX).append(name::Component(from)).append(CLUSTER_STATE_COMP).append(user));
+                stateInterest.setInterestLifetime(time::milliseconds(CLUSTER_INTEREST_LIFETIME_MILLISECONDS));
+                stateInterest.setMustBeFresh(true);
+                util::SegmentFetcher::fetch(m_face, stateInterest, make_shared<ValidatorNull>(),
+                                            bind(&DSUServer::onStateFetched, this, interest, user, _1),
+                                            bind(&DSUServer::onStateFetchFailed, this, interest, _2));
+            }
+            
+            void
+            onStateFetched(const Interest& notice, const name::Component& user, const ConstBufferPtr& content)
+            {
+                std::vector<uint8_t> state(content->begin(), content->end());
+                if (state.empty()) {
+                    // taken by an earlier notice
+                    putHandoffAck(notice);
+                    return;
+                }
+                askEngine<bool>(getEngineIndex(user), bind(&DSUsync::importUserState, _1, user, state),
+                                bind(&DSUServer::onStateImported, this, notice, user, _1));
+            }
+            
+            void
+            onStateImported(const Interest& notice, const name::Component& user, bool isImported)
+            {
+                std::string from = toString(notice.getName().get(m_clusterPrefix.size() + 1));
+                if (!isImported) {
+                    // not acknowledged, the notice is sent again
+                    DSU_LOG_WARN("Cannot take over user " << user << " handed over by " << from);
+                    return;
+                }
+                DSU_LOG_INFO("Took over user " << user << " handed over by " << from);
+                putHandoffAck(notice);
+            }
+            
+            // not acknowledged, the notice is sent again
+            void
+            onStateFetchFailed(const Interest& notice, const std::string& reason)
+            {
+                DSU_LOG_WARN("Cannot fetch the state handed over by " << notice.getName() << ": " << reason);
+            }
+            
+            void
+            putHandoffAck(const Interest& notice)
+            {
+                Data ack(notice.getName());
+                ack.setFreshnessPeriod(time::seconds(1));
+                m_keyChain.sign(ack, security::signingWithSha256());
+                m_face.put(ack);
+            }
+            
+            // the new owner of a user fetches its state
+            void
+            onStateInterest(const Interest& interest)
+            {
+                const Name& name = interest.getName();
+                name::Component user = name.get(m_clusterPrefix.size() + 1);
+                uint64_t segment = 0;
+                if (name.size() > m_clusterPrefix.size() + 2 && name.get(m_clusterPrefix.size() + 2).isSegment()) {
+                    segment = name.get(m_clusterPrefix.size() + 2).toSegment();
+                }
+                std::map<name::Component, OutgoingState>::iterator it = m_outgoingStates.find(user);
+                if (it != m_outgoingStates.end()) {
+                    putStateSegment(user, *it->second.state, segment);
+                } else if (segment == 0) {
+                    askEngine<std::vector<uint8_t>>(getEngineIndex(user), bind(&DSUsync::takeUserState, _1, user),
+                                                    bind(&DSUServer::onStateTaken, this, user, _1));
+                }
+            }
+            
+            void
+            onStateTaken(const name::Component& user, const std::vector<uint8_t>& state)
+            {
+                OutgoingState& outgoing = m_outgoingStates[user];
+                // a second Interest for the first segment found nothing left to take
+                if (outgoing.state == nullptr || !state.empty()) {
+                    outgoing.state = make_shared<const std::vector<uint8_t>>(state);
+                    outgoing.expiry = time::steady_clock::now() + time::seconds(HANDOFF_STATE_LIFETIME_SECONDS);
+                }
+                putStateSegment(user, *outgoing.state, 0);
+            }
+            
+            void
+            putStateSegment(const name::Component& user, const std::vector<uint8_t>& state, uint64_t segment)
+            {
+                uint64_t nSegments = std::max<uint64_t>(1, (state.size() + HANDOFF_SEGMENT_SIZE - 1) / HANDOFF_SEGMENT_SIZE);
+                if (segment >= nSegments) {
+                    return;
+                }
+                size_t offset = segment * HANDOFF_SEGMENT_SIZE;
+                Data data(Name(m_clusterPrefix).append(CLUSTER_STATE_COMP).append(user).appendSegment(segment));
+                data.setContent(state.data() + offset, std::min(HANDOFF_SEGMENT_SIZE, state.size() - offset));
+                data.setFinalBlockId(name::Component::fromSegment(nSegments - 1));
+                data.setFreshnessPeriod(time::seconds(1));
+                m_keyChain.sign(data, security::signingWithSha256());
+                m_face.put(data);
+            }
+            
+            // a state nobody fetched goes back to the spill directory
+            void
+            returnState(const name::Component& user, const std::vector<uint8_t>& state)
+            {
+                if (state.empty()) {
+                    return;
+                }
+                DSU_LOG_WARN("The state of user " << user << " was not taken over, keeping it");
+                askEngine<bool>(getEngineIndex(user), bind(&DSUsync::importUserState, _1, user, state),
+                                function<void(const bool&)>());
+            }
+            
+            void
+            onStatusInterest()
+            {
+                if (m_engine != nullptr) {
+                    putStatus(m_engine->makeMetricsReport(STATUS_MAX_USERS));
+                    return;
+                }
+                shared_ptr<StatusReports> status = make_shared<StatusReports>();
+                status->reports.resize(m_shards.size());
+                status->nMissing = m_shards.size();
+                for (size_t i = 0; i < m_shards.size(); i++) {
+                    m_shards[i]->toShard.post(bind(&DSUServer::makeShardStatus, this, std::ref(*m_shards[i]), i, status));
+                }
+            }
+            
+            // on the shard's thread
+            void
+            makeShardStatus(Shard& shard, size_t index, const shared_ptr<StatusReports>& status)
+            {
+                // the user list is split among shards to keep the reply within one packet
+                std::string report = shard.engine->makeMetricsReport(STATUS_MAX_USERS / m_shards.size() + 1);
+                shard.toFace.post(bind(&DSUServer::onShardStatus, this, index, report, status));
+            }
+            
+            void
+            onShardStatus(size_t index, const std::string& report, const shared_ptr<StatusReports>& status)
+            {
+                status->reports[index] = report;
+                if (--status->nMissing > 0) {
+                    return;
+                }
+                std::string reports = "{\"shards\":[";
+                for (size_t i = 0; i < status->reports.size(); i++) {
+                    reports += (i > 0 ? "," : "") + status->reports[i];
+                }
+                putStatus(reports + "]}");
+            }
+            
+            void
+            putStatus(const std::string& report)
+            {
+                Data data(Name(STATUS_PREFIX).appendVersion());
+                data.setContent(reinterpret_cast<const uint8_t*>(report.data()), report.size());
+                data.setFreshnessPeriod(time::seconds(1));
+                m_keyChain.sign(data, security::signingWithSha256());
+                m_face.put(data);
+            }
+            
+            void
+            onRegisterFailed(const Name& prefix, const std::string& reason)
+            {
+                DSU_LOG_ERROR("Failed to register prefix \"" << prefix
+                              << "\" in local hub's daemon (" << reason << ")");
+            }
+            
+        private:
+            // Explicitly create io_service object, which can be shared between Face and Scheduler
+            boost::asio::io_service m_ioService;
+            Face m_face;
+            // signs status replies with a digest only
+            KeyChain m_keyChain;
+            // without shards
+            unique_ptr<DirectFaceEndpoint> m_directFace;
+            unique_ptr<DSUsync> m_engine;
+            std::vector<unique_ptr<Shard>> m_shards;
+            Scheduler m_scheduler;
+            // empty without a cluster
+            std::string m_clusterName;
+            std::string m_membersPath;
+            shared_ptr<const ConsistentHashRing> m_ring;
+            // <CLUSTER_PREFIX>/<m_clusterName>
+            Name m_clusterPrefix;
+            std::map<Name, ForwardedRequest> m_forwardedRequests;
+            std::map<name::Component, OutgoingState> m_outgoingStates;
+        };
+        
+        
+        
+    } // namespace dsu
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+    namespace po = boost::program_options;
+    
+    ndn::dsu::Options options;
+    std::string logLevels = "*=info";
+    po::options_description description("Usage: ndnfit-dsu [options]");
+    description.add_options()
+    ("help,h", "print this help message and exit")
+    ("log", po::value<std::string>(&logLevels)->default_value(logLevels),
+     "log levels per module, e.g. \"*=info,RepoClient=debug\"; \"Payload=trace\" dumps fetched content")
+    ("signing,s", po::value<std::string>(&options.signing)->default_value(options.signing),
+     "key used to sign replies: default (default identity) or ecdsa")
+    ("digest-confirmations", po::bool_switch(&options.digestConfirmations),
+     "sign confirmation replies with a SHA-256 digest only")
+    ("signing-threads", po::value<size_t>(&options.nSigningThreads)->default_value(options.nSigningThreads),
+     "number of signing threads, 0 signs on the I/O thread")
+    ("verify", po::bool_switch(&options.verifySignatures),
+     "only store fetched packets signed by a key of their user, fetching its certificate")
+    ("verification-threads", po::value<size_t>(&options.nVerificationThreads)->default_value(options.nVerificationThreads),
+     "number of signature verification threads, 0 verifies on the I/O thread")
+    ("trust-anchor", po::value<std::string>(&options.trustAnchorPath),
+     "certificate file the users' certificates must be signed by; without it any certificate "
+     "named under the user's prefix is accepted")
+    ("journal,j", po::value<std::string>(&options.journalPath)->default_value(options.journalPath),
+     "sync state journal, restored on startup; empty disables it")
+    ("compaction-interval", po::value<int>(&options.compactionInterval)->default_value(options.compactionInterval),
+     "seconds between journal compactions")
+    ("repo", po::value<std::vector<std::string>>(&options.repoEndpoints)->multitoken()
+              ->default_value(options.repoEndpoints, "localhost:7376"),
+     "repo host:port, may be given several times")
+    ("repo-connections", po::value<size_t>(&options.nRepoConnections)->default_value(options.nRepoConnections),
+     "TCP connections opened to every repo")
+    ("repo-dispatch", po::value<std::string>(&options.repoDispatch)->default_value(options.repoDispatch),
+     "how packets are spread over repo connections: round-robin or least-loaded")
+    ("repo-queue-limit", po::value<size_t>(&options.repoQueueLimit)->default_value(options.repoQueueLimit),
+     "packets queued per repo connection before fetching from phones pauses; twice as many are refused")
+    ("repo-batch-bytes", po::value<size_t>(&options.repoBatchBytes)->default_value(options.repoBatchBytes),
+     "bytes of queued packets written to a repo connection in one write")
+    ("repo-batch-delay", po::value<int>(&options.repoBatchDelay)->default_value(options.repoBatchDelay),
+     "milliseconds a packet may wait for others to share its write to the repo; 0 writes at once")
+    ("metrics-file", po::value<std::string>(&options.metricsPath),
+     "file the metrics are periodically written to as JSON")
+    ("metrics-interval", po::value<int>(&options.metricsInterval)->default_value(options.metricsInterval),
+     "seconds between writes of the metrics file")
+    ("memory-budget", po::value<size_t>(&options.memoryBudget)->default_value(options.memoryBudget),
+     "megabytes of per-user sync state kept in memory before the least recently active users are evicted; 0 is unbounded")
+    ("user-idle-timeout", po::value<int>(&options.userIdleTimeout)->default_value(options.userIdleTimeout),
+     "seconds without hearing from a phone before its user is evicted; 0 never")
+    ("pending-ttl", po::value<int>(&options.pendingTtl)->default_value(options.pendingTtl),
+     "seconds a catalog or datapoint fetch stays pending without completing; 0 forever")
+    ("spill-dir", po::value<std::string>(&options.spillDirectory)->default_value(options.spillDirectory),
+     "directory evicted users are written to and reloaded from on their next register Interest; "
+     "empty drops them")
+    ("shards", po::value<size_t>(&options.nShards)->default_value(options.nShards),
+     "sync engines run on threads of their own, users are split among them by user_id; "
+     "each shard keeps its own journal, spill directory and metrics file (suffixed .0, .1, ...) "
+     "and repo connections; the journals record the number, and a restart with another one is refused; "
+     "0 runs one engine on the I/O thread")
+    ("cluster-name", po::value<std::string>(&options.clusterName),
+     "run as this member of a cluster: users are split among the members, requests for users owned by "
+     "another member are forwarded to it and users are handed over when the members change; "
+     "needs a spill directory of its own")
+    ("cluster-members", po::value<std::string>(&options.clusterMembersPath)->default_value(options.clusterMembersPath),
+     "file listing the cluster members, one name per line, shared by all of them; "
+     "re-read every few seconds to add or remove members");
+    
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, description), vm);
+        po::notify(vm);
+    }
+    catch (const po::error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl << description << std::endl;
+        return 2;
+    }
+    if (vm.count("help") > 0) {
+        std::cout << description << std::endl;
+        return 0;
+    }
+    try {
+        ndn::dsu::Logging::setLevels(logLevels);
+    }
+    catch (const ndn::dsu::Logging::Error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 2;
+    }
+    
     try {
-        dsusync.run();
+        ndn::dsu::DSUServer server(options);
+        server.run();
     }
     catch (const std::exception& e) {
+        ndn::dsu::Logging::flush();
         std::cerr << "ERROR: " << e.what() << std::endl;
     }
     return 0;
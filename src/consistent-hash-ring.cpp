@@ -0,0 +1,58 @@
+#include "consistent-hash-ring.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+    namespace dsu {
+
+        static uint64_t
+        hashBytes(const uint8_t* data, size_t size)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            for (size_t i = 0; i < size; i++) {
+                hash = (hash ^ data[i]) * 1099511628211ull;
+            }
+            // FNV-1a leaves the last bytes in the low bits, while the ring is ordered by the high
+            // ones: without mixing, names that differ at the end (user42, user43) bunch together
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdull;
+            hash ^= hash >> 33;
+            hash *= 0xc4ceb9fe1a85ec53ull;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        ConsistentHashRing::ConsistentHashRing(const std::vector<std::string>& members, size_t nVirtualNodes)
+        : m_members(members)
+        {
+            std::sort(m_members.begin(), m_members.end());
+            m_members.erase(std::unique(m_members.begin(), m_members.end()), m_members.end());
+            for (size_t i = 0; i < m_members.size(); i++) {
+                for (size_t j = 0; j < nVirtualNodes; j++) {
+                    std::string point = m_members[i] + "#" + std::to_string(j);
+                    // on a collision the smaller name wins, the same on every instance
+                    m_points.insert(std::make_pair(hashBytes(reinterpret_cast<const uint8_t*>(point.data()),
+                                                             point.size()), i));
+                }
+            }
+        }
+
+        const std::string&
+        ConsistentHashRing::getOwner(const name::Component& user) const
+        {
+            std::map<uint64_t, size_t>::const_iterator it = m_points.lower_bound(hashBytes(user.value(),
+                                                                                           user.value_size()));
+            if (it == m_points.end()) {
+                it = m_points.begin();
+            }
+            return m_members[it->second];
+        }
+
+        bool
+        ConsistentHashRing::hasMember(const std::string& member) const
+        {
+            return std::binary_search(m_members.begin(), m_members.end(), member);
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,56 @@
+#ifndef NDNFIT_DSU_CONSISTENT_HASH_RING_HPP
+#define NDNFIT_DSU_CONSISTENT_HASH_RING_HPP
+
+#include <ndn-cxx/name.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Assigns users to the members of a cluster by consistent hashing
+         *
+         * Every member is placed at @p nVirtualNodes points of a 64-bit ring, and a user belongs
+         * to the member at the first point at or after the hash of its user_id. When a member
+         * joins or leaves, only the users between its points and the previous ones change
+         * hands. Hashes are FNV-1a with the MurmurHash3 finalizer, so every instance computes
+         * the same ring from the same member names.
+         */
+        class ConsistentHashRing
+        {
+        public:
+            explicit
+            ConsistentHashRing(const std::vector<std::string>& members, size_t nVirtualNodes = 64);
+
+            /// @pre the ring has members
+            const std::string&
+            getOwner(const name::Component& user) const;
+
+            bool
+            isOwner(const std::string& member, const name::Component& user) const
+            {
+                return !m_points.empty() && getOwner(user) == member;
+            }
+
+            bool
+            hasMember(const std::string& member) const;
+
+            const std::vector<std::string>&
+            getMembers() const
+            {
+                return m_members;
+            }
+
+        private:
+            std::vector<std::string> m_members;
+            // point on the ring -> index in m_members
+            std::map<uint64_t, size_t> m_points;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_CONSISTENT_HASH_RING_HPP
@@ -0,0 +1,787 @@
+#include "content-parser.hpp"
+
+#include <rapidjson/reader.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        namespace {
+
+            /**
+             * @brief SAX handler that accepts any document and records schema violations
+             *
+             * Every callback returns true so that rapidjson keeps going; derived handlers set
+             * m_isValid to false instead.
+             */
+            class HandlerBase
+            {
+            public:
+                typedef char Ch;
+
+                HandlerBase()
+                : m_isValid(true)
+                , m_depth(0)
+                {
+                }
+
+                virtual
+                ~HandlerBase()
+                {
+                }
+
+                bool
+                isValid() const
+                {
+                    return m_isValid;
+                }
+
+                bool Null() { return onScalar(); }
+                bool Bool(bool) { return onScalar(); }
+                bool Int(int i) { return i >= 0 ? onNumber(static_cast<uint64_t>(i)) : onScalar(); }
+                bool Uint(unsigned u) { return onNumber(u); }
+                bool Int64(int64_t i) { return i >= 0 ? onNumber(static_cast<uint64_t>(i)) : onScalar(); }
+                bool Uint64(uint64_t u) { return onNumber(u); }
+                bool Double(double) { return onScalar(); }
+                // only called with kParseNumbersAsStringsFlag, but rapidjson 1.1 needs it to compile
+                bool RawNumber(const Ch*, rapidjson::SizeType, bool) { return onScalar(); }
+                bool String(const Ch* str, rapidjson::SizeType length, bool) { return onString(str, length); }
+                bool Key(const Ch* str, rapidjson::SizeType length, bool) { return onString(str, length); }
+                bool StartObject() { return onStart(true); }
+                bool EndObject(rapidjson::SizeType) { return onEnd(true); }
+                bool StartArray() { return onStart(false); }
+                bool EndArray(rapidjson::SizeType) { return onEnd(false); }
+
+            protected:
+                virtual bool
+                onScalar()
+                {
+                    return true;
+                }
+
+                virtual bool
+                onNumber(uint64_t value)
+                {
+                    return onScalar();
+                }
+
+                virtual bool
+                onString(const Ch* str, rapidjson::SizeType length)
+                {
+                    return onScalar();
+                }
+
+                virtual bool
+                onStart(bool isObject)
+                {
+                    m_depth++;
+                    return true;
+                }
+
+                virtual bool
+                onEnd(bool isObject)
+                {
+                    m_depth--;
+                    return true;
+                }
+
+                bool
+                fail()
+                {
+                    m_isValid = false;
+                    return true;
+                }
+
+            protected:
+                bool m_isValid;
+                int m_depth;
+            };
+
+            // [<uint64>, ...]
+            class CatalogHandler : public HandlerBase
+            {
+            public:
+                explicit
+                CatalogHandler(ContentVisitor& visitor)
+                : m_visitor(visitor)
+                {
+                }
+
+            protected:
+                virtual bool
+                onScalar()
+                {
+                    return fail();
+                }
+
+                virtual bool
+                onNumber(uint64_t value)
+                {
+                    if (m_depth != 1) {
+                        return fail();
+                    }
+                    m_visitor.onDatapoint(value);
+                    return true;
+                }
+
+                virtual bool
+                onStart(bool isObject)
+                {
+                    if (isObject || m_depth != 0) {
+                        fail();
+                    }
+                    return HandlerBase::onStart(isObject);
+                }
+
+            private:
+                ContentVisitor& m_visitor;
+            };
+
+            // [{"timepoint": <uint64>, "version": <uint64>}, ...]
+            class UpdateInfoHandler : public HandlerBase
+            {
+            public:
+                explicit
+                UpdateInfoHandler(ContentVisitor& visitor)
+                : m_visitor(visitor)
+                , m_key(NONE)
+                , m_timepoint(0)
+                , m_version(0)
+                , m_hasTimepoint(false)
+                , m_hasVersion(false)
+                {
+                }
+
+            protected:
+                virtual bool
+                onScalar()
+                {
+                    // unknown members are skipped, anything else is out of place
+                    if (m_depth != 2 || m_key != OTHER) {
+                        fail();
+                    }
+                    m_key = NONE;
+                    return true;
+                }
+
+                virtual bool
+                onNumber(uint64_t value)
+                {
+                    if (m_depth != 2) {
+                        return fail();
+                    }
+                    if (m_key == TIMEPOINT) {
+                        m_timepoint = value;
+                        m_hasTimepoint = true;
+                    } else if (m_key == VERSION) {
+                        m_version = value;
+                        m_hasVersion = true;
+                    } else if (m_key != OTHER) {
+                        fail();
+                    }
+                    m_key = NONE;
+                    return true;
+                }
+
+                virtual bool
+                onString(const Ch* str, rapidjson::SizeType length)
+                {
+                    if (m_depth != 2) {
+                        return fail();
+                    }
+                    if (m_key != NONE) {
+                        // string value of a member
+                        return onScalar();
+                    }
+                    if (length == 9 && std::memcmp(str, "timepoint", 9) == 0) {
+                        m_key = TIMEPOINT;
+                    } else if (length == 7 && std::memcmp(str, "version", 7) == 0) {
+                        m_key = VERSION;
+                    } else {
+                        m_key = OTHER;
+                    }
+                    return true;
+                }
+
+                virtual bool
+                onStart(bool isObject)
+                {
+                    if (m_depth == 1 && isObject) {
+                        m_hasTimepoint = false;
+                        m_hasVersion = false;
+                        m_key = NONE;
+                    } else if (m_depth != 0 || isObject) {
+                        fail();
+                    }
+                    return HandlerBase::onStart(isObject);
+                }
+
+                virtual bool
+                onEnd(bool isObject)
+                {
+                    if (m_depth == 2 && isObject) {
+                        if (m_hasTimepoint && m_hasVersion) {
+                            m_visitor.onCatalogEntry(m_timepoint, m_version);
+                        } else {
+                            fail();
+                        }
+                    }
+                    return HandlerBase::onEnd(isObject);
+                }
+
+            private:
+                enum Key {
+                    NONE,
+                    TIMEPOINT,
+                    VERSION,
+                    OTHER
+                };
+
+                ContentVisitor& m_visitor;
+                Key m_key;
+                uint64_t m_timepoint;
+                uint64_t m_version;
+                bool m_hasTimepoint;
+                bool m_hasVersion;
+            };
+
+            template<typename Handler>
+            bool
+            parse(const Block& content, Handler& handler)
+            {
+                BlockInputStream stream(content);
+                rapidjson::Reader reader;
+                if (!reader.Parse<0>(stream, handler)) {
+                    return false;
+                }
+                return handler.isValid();
+            }
+
+            // hands the entries over to the visitor of the current SegmentedContentParser::feed() call
+            class ForwardingVisitor : public ContentVisitor
+            {
+            public:
+                ForwardingVisitor()
+                : target(0)
+                {
+                }
+
+                virtual void
+                onCatalogEntry(uint64_t timepoint, uint64_t version)
+                {
+                    if (target != 0) {
+                        target->onCatalogEntry(timepoint, version);
+                    }
+                }
+
+                virtual void
+                onDatapoint(uint64_t timepoint)
+                {
+                    if (target != 0) {
+                        target->onDatapoint(timepoint);
+                    }
+                }
+
+                // 0 outside of feed(), when finish() completes a trailing token that cannot be an entry
+                ContentVisitor* target;
+            };
+
+            const size_t MAX_DEPTH = 64;
+
+            inline bool
+            isDigit(char c)
+            {
+                return c >= '0' && c <= '9';
+            }
+
+            inline bool
+            isLetter(char c)
+            {
+                return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            }
+
+            // the value of a hex digit, -1 if @p c is not one
+            inline int
+            getHexValue(char c)
+            {
+                if (isDigit(c)) {
+                    return c - '0';
+                }
+                if (c >= 'a' && c <= 'f') {
+                    return c - 'a' + 10;
+                }
+                if (c >= 'A' && c <= 'F') {
+                    return c - 'A' + 10;
+                }
+                return -1;
+            }
+
+            void
+            appendUtf8(std::string& s, unsigned codepoint)
+            {
+                if (codepoint < 0x80) {
+                    s.push_back(static_cast<char>(codepoint));
+                } else if (codepoint < 0x800) {
+                    s.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+                    s.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+                } else if (codepoint < 0x10000) {
+                    s.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+                    s.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+                    s.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+                } else {
+                    s.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+                    s.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+                    s.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+                    s.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+                }
+            }
+
+        } // anonymous namespace
+
+        /**
+         * A JSON tokenizer that can stop at any byte and resume with the next segment, feeding
+         * the same SAX handlers as the single-packet parsers. rapidjson cannot do that: its
+         * reader pulls from the stream until the document ends.
+         */
+        class SegmentedContentParser::Impl
+        {
+        public:
+            explicit
+            Impl(Schema schema)
+            : m_isValid(true)
+            , m_expect(VALUE)
+            , m_token(NO_TOKEN)
+            , m_isKey(false)
+            , m_hasEscape(false)
+            {
+                if (schema == CATALOG) {
+                    m_handler.reset(new CatalogHandler(m_visitor));
+                } else {
+                    m_handler.reset(new UpdateInfoHandler(m_visitor));
+                }
+            }
+
+            bool
+            feed(const Block& content, ContentVisitor& visitor)
+            {
+                m_visitor.target = &visitor;
+                const char* begin = reinterpret_cast<const char*>(content.value());
+                const char* end = begin + content.value_size();
+                for (const char* it = begin; it != end && isValid(); ++it) {
+                    onChar(*it);
+                }
+                m_visitor.target = 0;
+                return isValid();
+            }
+
+            bool
+            finish()
+            {
+                if (isValid() && (m_token == NUMBER || m_token == LITERAL)) {
+                    endToken();
+                }
+                return isValid() && m_token == NO_TOKEN && m_expect == DONE;
+            }
+
+        private:
+            enum Expect {
+                VALUE,
+                // just after '['
+                VALUE_OR_END,
+                KEY,
+                // just after '{'
+                KEY_OR_END,
+                COLON,
+                COMMA_OR_END,
+                // the root value is complete, only whitespace may follow
+                DONE
+            };
+
+            enum Token {
+                NO_TOKEN,
+                STRING,
+                // the character after a backslash
+                STRING_ESCAPE,
+                NUMBER,
+                LITERAL
+            };
+
+            bool
+            isValid() const
+            {
+                return m_isValid && m_handler->isValid();
+            }
+
+            void
+            onChar(char c)
+            {
+                switch (m_token) {
+                    case STRING:
+                        if (c == '"') {
+                            endToken();
+                        } else if (static_cast<unsigned char>(c) < 0x20) {
+                            // control characters must be escaped
+                            m_isValid = false;
+                        } else {
+                            if (c == '\\') {
+                                m_token = STRING_ESCAPE;
+                                m_hasEscape = true;
+                            }
+                            append(c);
+                        }
+                        return;
+                    case STRING_ESCAPE:
+                        m_token = STRING;
+                        append(c);
+                        return;
+                    case NUMBER:
+                        if (isDigit(c) || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                            append(c);
+                            return;
+                        }
+                        endToken();
+                        break;
+                    case LITERAL:
+                        if (isLetter(c)) {
+                            append(c);
+                            return;
+                        }
+                        endToken();
+                        break;
+                    case NO_TOKEN:
+                        break;
+                }
+                if (isValid()) {
+                    onStructural(c);
+                }
+            }
+
+            void
+            onStructural(char c)
+            {
+                bool expectsValue = m_expect == VALUE || m_expect == VALUE_OR_END;
+                switch (c) {
+                    case ' ':
+                    case '\t':
+                    case '\n':
+                    case '\r':
+                        return;
+                    case '"':
+                        if (m_expect == KEY || m_expect == KEY_OR_END) {
+                            startToken(STRING, true);
+                        } else if (expectsValue) {
+                            startToken(STRING, false);
+                        } else {
+                            m_isValid = false;
+                        }
+                        return;
+                    case '[':
+                    case '{':
+                        if (!expectsValue || m_containers.size() == MAX_DEPTH) {
+                            m_isValid = false;
+                            return;
+                        }
+                        m_containers.push_back(c);
+                        if (c == '[') {
+                            m_handler->StartArray();
+                            m_expect = VALUE_OR_END;
+                        } else {
+                            m_handler->StartObject();
+                            m_expect = KEY_OR_END;
+                        }
+                        return;
+                    case ']':
+                    case '}':
+                        if (m_containers.empty() || m_containers.back() != (c == ']' ? '[' : '{') ||
+                            (m_expect != COMMA_OR_END && m_expect != (c == ']' ? VALUE_OR_END : KEY_OR_END))) {
+                            m_isValid = false;
+                            return;
+                        }
+                        m_containers.pop_back();
+                        if (c == ']') {
+                            m_handler->EndArray(0);
+                        } else {
+                            m_handler->EndObject(0);
+                        }
+                        afterValue();
+                        return;
+                    case ',':
+                        if (m_expect != COMMA_OR_END) {
+                            m_isValid = false;
+                            return;
+                        }
+                        m_expect = m_containers.back() == '[' ? VALUE : KEY;
+                        return;
+                    case ':':
+                        if (m_expect != COLON) {
+                            m_isValid = false;
+                            return;
+                        }
+                        m_expect = VALUE;
+                        return;
+                    default:
+                        if (expectsValue && (c == '-' || isDigit(c))) {
+                            startToken(NUMBER, false);
+                            append(c);
+                        } else if (expectsValue && isLetter(c)) {
+                            startToken(LITERAL, false);
+                            append(c);
+                        } else {
+                            m_isValid = false;
+                        }
+                        return;
+                }
+            }
+
+            void
+            startToken(Token token, bool isKey)
+            {
+                m_token = token;
+                m_isKey = isKey;
+                m_hasEscape = false;
+                m_buffer.clear();
+            }
+
+            void
+            append(char c)
+            {
+                if (m_buffer.size() == MAX_TOKEN_LENGTH) {
+                    m_isValid = false;
+                    return;
+                }
+                m_buffer.push_back(c);
+            }
+
+            void
+            endToken()
+            {
+                Token token = m_token;
+                m_token = NO_TOKEN;
+                if (token == STRING) {
+                    if (m_hasEscape && !unescape()) {
+                        m_isValid = false;
+                        return;
+                    }
+                    if (m_isKey) {
+                        m_handler->Key(m_buffer.data(), m_buffer.size(), true);
+                        m_expect = COLON;
+                        return;
+                    }
+                    m_handler->String(m_buffer.data(), m_buffer.size(), true);
+                } else if (token == NUMBER) {
+                    if (!endNumber()) {
+                        m_isValid = false;
+                        return;
+                    }
+                } else if (m_buffer == "true" || m_buffer == "false") {
+                    m_handler->Bool(m_buffer == "true");
+                } else if (m_buffer == "null") {
+                    m_handler->Null();
+                } else {
+                    m_isValid = false;
+                    return;
+                }
+                afterValue();
+            }
+
+            // replace the escapes of the string in m_buffer with the characters they stand for,
+            // UTF-8 encoded; a high surrogate must be followed by a low one, as rapidjson wants
+            bool
+            unescape()
+            {
+                const std::string& s = m_buffer;
+                std::string& decoded = m_decoded;
+                decoded.clear();
+                for (size_t i = 0; i < s.size(); i++) {
+                    if (s[i] != '\\') {
+                        decoded.push_back(s[i]);
+                        continue;
+                    }
+                    // a backslash is always followed by the escaped character
+                    char c = s[++i];
+                    switch (c) {
+                        case '"': case '\\': case '/': decoded.push_back(c); break;
+                        case 'b': decoded.push_back('\b'); break;
+                        case 'f': decoded.push_back('\f'); break;
+                        case 'n': decoded.push_back('\n'); break;
+                        case 'r': decoded.push_back('\r'); break;
+                        case 't': decoded.push_back('\t'); break;
+                        case 'u': {
+                            int codepoint = parseHex4(s, i + 1);
+                            if (codepoint < 0) {
+                                return false;
+                            }
+                            i += 4;
+                            if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                                if (i + 2 >= s.size() || s[i + 1] != '\\' || s[i + 2] != 'u') {
+                                    return false;
+                                }
+                                int low = parseHex4(s, i + 3);
+                                if (low < 0xDC00 || low > 0xDFFF) {
+                                    return false;
+                                }
+                                i += 6;
+                                codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                            }
+                            appendUtf8(decoded, codepoint);
+                            break;
+                        }
+                        default:
+                            return false;
+                    }
+                }
+                m_buffer.swap(decoded);
+                return true;
+            }
+
+            // the 4 hex digits at @p offset of @p s, -1 if there are not
+            static int
+            parseHex4(const std::string& s, size_t offset)
+            {
+                if (offset + 4 > s.size()) {
+                    return -1;
+                }
+                int value = 0;
+                for (size_t i = offset; i < offset + 4; i++) {
+                    int digit = getHexValue(s[i]);
+                    if (digit < 0) {
+                        return -1;
+                    }
+                    value = value * 16 + digit;
+                }
+                return value;
+            }
+
+            // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?, integers that fit in 64 bits are
+            // passed on as such, like rapidjson does, so "-0" is the number 0
+            bool
+            endNumber()
+            {
+                const std::string& s = m_buffer;
+                size_t i = s[0] == '-' ? 1 : 0;
+                size_t integerBegin = i;
+                while (i < s.size() && isDigit(s[i])) {
+                    i++;
+                }
+                size_t integerEnd = i;
+                if (integerEnd == integerBegin || (s[integerBegin] == '0' && integerEnd - integerBegin > 1)) {
+                    return false;
+                }
+                bool isInteger = i == s.size();
+                if (i < s.size() && s[i] == '.') {
+                    size_t fractionBegin = ++i;
+                    while (i < s.size() && isDigit(s[i])) {
+                        i++;
+                    }
+                    if (i == fractionBegin) {
+                        return false;
+                    }
+                }
+                if (i < s.size() && (s[i] == 'e' || s[i] == 'E')) {
+                    i++;
+                    if (i < s.size() && (s[i] == '+' || s[i] == '-')) {
+                        i++;
+                    }
+                    size_t exponentBegin = i;
+                    while (i < s.size() && isDigit(s[i])) {
+                        i++;
+                    }
+                    if (i == exponentBegin) {
+                        return false;
+                    }
+                }
+                if (i != s.size()) {
+                    return false;
+                }
+
+                if (isInteger && integerBegin == 0) {
+                    errno = 0;
+                    unsigned long long value = std::strtoull(s.c_str(), 0, 10);
+                    if (errno != ERANGE) {
+                        m_handler->Uint64(value);
+                        return true;
+                    }
+                } else if (isInteger) {
+                    errno = 0;
+                    long long value = std::strtoll(s.c_str(), 0, 10);
+                    if (errno != ERANGE) {
+                        m_handler->Int64(value);
+                        return true;
+                    }
+                }
+                m_handler->Double(0);
+                return true;
+            }
+
+            void
+            afterValue()
+            {
+                m_expect = m_containers.empty() ? DONE : COMMA_OR_END;
+            }
+
+        private:
+            ForwardingVisitor m_visitor;
+            unique_ptr<HandlerBase> m_handler;
+            bool m_isValid;
+            Expect m_expect;
+            Token m_token;
+            // the string being read is an object key
+            bool m_isKey;
+            // the string being read has a backslash, it is unescaped once complete
+            bool m_hasEscape;
+            std::string m_buffer;
+            std::string m_decoded;
+            // '[' or '{' for every open container
+            std::vector<char> m_containers;
+        };
+
+        bool
+        parseUpdateInfo(const Block& content, ContentVisitor& visitor)
+        {
+            UpdateInfoHandler handler(visitor);
+            return parse(content, handler);
+        }
+
+        bool
+        parseCatalog(const Block& content, ContentVisitor& visitor)
+        {
+            CatalogHandler handler(visitor);
+            return parse(content, handler);
+        }
+
+        bool
+        isValidJson(const Block& content)
+        {
+            HandlerBase handler;
+            return parse(content, handler);
+        }
+
+        const size_t SegmentedContentParser::MAX_TOKEN_LENGTH;
+
+        SegmentedContentParser::SegmentedContentParser(Schema schema)
+        : m_impl(new Impl(schema))
+        {
+        }
+
+        SegmentedContentParser::~SegmentedContentParser()
+        {
+        }
+
+        bool
+        SegmentedContentParser::feed(const Block& content, ContentVisitor& visitor)
+        {
+            return m_impl->feed(content, visitor);
+        }
+
+        bool
+        SegmentedContentParser::finish()
+        {
+            return m_impl->finish();
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,181 @@
+#ifndef NDNFIT_DSU_CONTENT_PARSER_HPP
+#define NDNFIT_DSU_CONTENT_PARSER_HPP
+
+#include <ndn-cxx/common.hpp>
+#include <ndn-cxx/encoding/block.hpp>
+#include <cassert>
+#include <cstddef>
+#include <stdint.h>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Read-only rapidjson input stream over the value of a Block
+         *
+         * The content is read in place from the packet buffer, it is neither copied nor
+         * required to be NUL-terminated: Peek() returns '\0' past the end.
+         */
+        class BlockInputStream
+        {
+        public:
+            typedef char Ch;
+
+            explicit
+            BlockInputStream(const Block& block)
+            : m_begin(reinterpret_cast<const Ch*>(block.value()))
+            , m_current(m_begin)
+            , m_end(m_begin + block.value_size())
+            {
+            }
+
+            BlockInputStream(const uint8_t* begin, size_t size)
+            : m_begin(reinterpret_cast<const Ch*>(begin))
+            , m_current(m_begin)
+            , m_end(m_begin + size)
+            {
+            }
+
+            Ch
+            Peek() const
+            {
+                return m_current < m_end ? *m_current : '\0';
+            }
+
+            Ch
+            Take()
+            {
+                return m_current < m_end ? *m_current++ : '\0';
+            }
+
+            size_t
+            Tell() const
+            {
+                return static_cast<size_t>(m_current - m_begin);
+            }
+
+            // the stream is read-only, in situ parsing is not supported
+            Ch*
+            PutBegin()
+            {
+                assert(false);
+                return 0;
+            }
+
+            void
+            Put(Ch)
+            {
+                assert(false);
+            }
+
+            size_t
+            PutEnd(Ch*)
+            {
+                assert(false);
+                return 0;
+            }
+
+        private:
+            const Ch* m_begin;
+            const Ch* m_current;
+            const Ch* m_end;
+        };
+
+        /**
+         * @brief Receives the entries of an update_info or catalog packet while it is parsed
+         */
+        class ContentVisitor
+        {
+        public:
+            virtual
+            ~ContentVisitor()
+            {
+            }
+
+            /// an update_info entry, @p timepoint in microseconds
+            virtual void
+            onCatalogEntry(uint64_t timepoint, uint64_t version)
+            {
+            }
+
+            /// a datapoint listed in a catalog, @p timepoint in microseconds
+            virtual void
+            onDatapoint(uint64_t timepoint)
+            {
+            }
+        };
+
+        /**
+         * @brief Parse an update_info packet: [{"timepoint": <uint64>, "version": <uint64>}, ...]
+         *
+         * Entries are handed to @p visitor as soon as they are complete, entries seen before an
+         * error are not taken back.
+         * @return false if the content is not valid JSON or does not follow the schema
+         */
+        bool
+        parseUpdateInfo(const Block& content, ContentVisitor& visitor);
+
+        /**
+         * @brief Parse a catalog packet: [<uint64 timepoint>, ...]
+         *
+         * Datapoints are handed to @p visitor while the array is scanned, no document is built.
+         * @return false if the content is not valid JSON or does not follow the schema
+         */
+        bool
+        parseCatalog(const Block& content, ContentVisitor& visitor);
+
+        /**
+         * @brief Check that the content is well-formed JSON without building a document
+         */
+        bool
+        isValidJson(const Block& content);
+
+        /**
+         * @brief Parses an update_info or catalog object whose content comes in several segments
+         *
+         * The content of the segments is fed in order, as they arrive, and entries are handed to
+         * the visitor as soon as they are complete. Only a token cut by a segment boundary is
+         * kept between two calls, so memory does not grow with the size of the object.
+         *
+         * The content is accepted or rejected as parseUpdateInfo() and parseCatalog() would, with
+         * the same entries, except that a string, number or literal longer than MAX_TOKEN_LENGTH
+         * characters as written makes it invalid.
+         */
+        class SegmentedContentParser : noncopyable
+        {
+        public:
+            enum Schema {
+                UPDATE_INFO,
+                CATALOG
+            };
+
+            static const size_t MAX_TOKEN_LENGTH = 4096;
+
+            explicit
+            SegmentedContentParser(Schema schema);
+
+            ~SegmentedContentParser();
+
+            /**
+             * @brief Parse the content of the next segment, handing its entries to @p visitor
+             * @return false once the content is known not to be valid, later calls do nothing
+             */
+            bool
+            feed(const Block& content, ContentVisitor& visitor);
+
+            /**
+             * @brief The last segment has been fed
+             * @return false if the content is not a complete, valid document
+             */
+            bool
+            finish();
+
+        private:
+            class Impl;
+            unique_ptr<Impl> m_impl;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_CONTENT_PARSER_HPP
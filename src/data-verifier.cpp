@@ -0,0 +1,243 @@
+#include "data-verifier.hpp"
+#include "logger.hpp"
+#include "random-word.hpp"
+
+#include <ndn-cxx/security/validator.hpp>
+
+namespace ndn {
+    namespace dsu {
+
+        DSU_LOG_INIT(DataVerifier);
+
+        static const time::milliseconds CERTIFICATE_INTEREST_LIFETIME(4000);
+        static const int CERTIFICATE_MAX_RETRIES = 2;
+        static const time::seconds CERTIFICATE_CACHE_LIFETIME(3600);
+        // how long a key whose certificate could not be had is not asked for again
+        static const time::seconds CERTIFICATE_HOLDOFF(60);
+
+        DataVerifier::Signer::Signer()
+        : isFetching(false)
+        , nRetries(0)
+        , firstSeq(0)
+        , nextUnbatched(0)
+        {
+        }
+
+        DataVerifier::DataVerifier(boost::asio::io_service& ioService, FaceEndpoint& face, size_t nThreads,
+                                   size_t keyPrefixLength, const AcceptedCallback& onAccepted,
+                                   const RejectedCallback& onRejected, size_t maxBatch)
+        : m_ioService(ioService)
+        , m_face(face)
+        , m_keyPrefixLength(keyPrefixLength)
+        , m_onAccepted(onAccepted)
+        , m_onRejected(onRejected)
+        , m_maxBatch(std::max<size_t>(1, maxBatch))
+        , m_isFlushPosted(false)
+        , m_backlog(0)
+        , m_nCertificateFetches(0)
+        , m_pool(ioService, nThreads)
+        {
+        }
+
+        void
+        DataVerifier::setTrustAnchor(const IdentityCertificate& anchor)
+        {
+            m_trustAnchor = make_shared<PublicKey>(anchor.getPublicKeyInfo());
+        }
+
+        void
+        DataVerifier::verify(const Data& data)
+        {
+            const Signature& signature = data.getSignature();
+            if (!signature.hasKeyLocator() || signature.getKeyLocator().getType() != KeyLocator::KeyLocator_Name) {
+                m_onRejected(data, "not signed by a named key", false);
+                return;
+            }
+            const Name& keyName = signature.getKeyLocator().getName();
+            if (!data.getName().getPrefix(m_keyPrefixLength).isPrefixOf(keyName)) {
+                m_onRejected(data, "signed by " + keyName.toUri() + ", outside its namespace", false);
+                return;
+            }
+
+            Signer& signer = m_signers[keyName];
+            Entry entry = {make_shared<const Data>(data), WAITING};
+            signer.entries.push_back(entry);
+            m_backlog++;
+            if (!signer.isFetching && time::steady_clock::now() >= signer.expiry) {
+                signer.key.reset();
+                fetchCertificate(keyName);
+            }
+            enqueue(keyName, signer);
+        }
+
+        void
+        DataVerifier::enqueue(const Name& keyName, Signer& signer)
+        {
+            if (signer.isFetching) {
+                return;
+            }
+            uint64_t endSeq = signer.firstSeq + signer.entries.size();
+            if (signer.key == nullptr) {
+                for (uint64_t seq = signer.nextUnbatched; seq < endSeq; seq++) {
+                    signer.entries[seq - signer.firstSeq].state = NO_CERTIFICATE;
+                }
+                signer.nextUnbatched = endSeq;
+                deliver(signer);
+                return;
+            }
+            for (uint64_t seq = signer.nextUnbatched; seq < endSeq; seq++) {
+                if (signer.batch == nullptr) {
+                    signer.batch = make_shared<VerificationPool::Batch>();
+                    m_openBatches.push_back(keyName);
+                }
+                VerificationPool::Packet packet = {signer.entries[seq - signer.firstSeq].data, false, seq};
+                signer.batch->push_back(packet);
+                if (signer.batch->size() >= m_maxBatch) {
+                    submit(keyName, signer);
+                }
+            }
+            signer.nextUnbatched = endSeq;
+            if (signer.batch != nullptr && !m_isFlushPosted) {
+                // the packets handled by the handlers already queued share the batch
+                m_isFlushPosted = true;
+                m_ioService.post(bind(&DataVerifier::flushBatches, this));
+            }
+        }
+
+        void
+        DataVerifier::submit(const Name& keyName, Signer& signer)
+        {
+            shared_ptr<VerificationPool::Batch> batch;
+            batch.swap(signer.batch);
+            m_pool.verify(batch, signer.key, bind(&DataVerifier::onVerified, this, keyName, _1));
+        }
+
+        void
+        DataVerifier::flushBatches()
+        {
+            m_isFlushPosted = false;
+            std::vector<Name> keyNames;
+            keyNames.swap(m_openBatches);
+            for (size_t i = 0; i < keyNames.size(); i++) {
+                SignerMap::iterator it = m_signers.find(keyNames[i]);
+                if (it != m_signers.end() && it->second.batch != nullptr) {
+                    submit(it->first, it->second);
+                }
+            }
+        }
+
+        void
+        DataVerifier::onVerified(const Name& keyName, const shared_ptr<VerificationPool::Batch>& batch)
+        {
+            // a key with packets in a batch is never removed
+            Signer& signer = m_signers[keyName];
+            for (VerificationPool::Batch::const_iterator it = batch->begin(); it != batch->end(); ++it) {
+                signer.entries[it->tag - signer.firstSeq].state = it->isValid ? ACCEPTED : BAD_SIGNATURE;
+            }
+            deliver(signer);
+        }
+
+        void
+        DataVerifier::deliver(Signer& signer)
+        {
+            while (!signer.entries.empty() && signer.entries.front().state != WAITING) {
+                Entry entry = signer.entries.front();
+                signer.entries.pop_front();
+                signer.firstSeq++;
+                m_backlog--;
+                if (entry.state == ACCEPTED) {
+                    m_onAccepted(*entry.data);
+                } else if (entry.state == BAD_SIGNATURE) {
+                    m_onRejected(*entry.data, "bad signature", false);
+                } else {
+                    m_onRejected(*entry.data, "no usable certificate", true);
+                }
+            }
+        }
+
+        void
+        DataVerifier::fetchCertificate(const Name& keyName)
+        {
+            m_signers[keyName].isFetching = true;
+            m_nCertificateFetches++;
+            Interest interest(keyName);
+            interest.setInterestLifetime(CERTIFICATE_INTEREST_LIFETIME);
+            interest.setNonce(generateRandomWord());
+            m_face.expressInterest(interest,
+                                   bind(&DataVerifier::onCertificate, this, _1, _2),
+                                   bind(&DataVerifier::onCertificateTimeout, this, _1));
+        }
+
+        void
+        DataVerifier::onCertificate(const Interest& interest, const Data& data)
+        {
+            const Name& keyName = interest.getName();
+            shared_ptr<IdentityCertificate> certificate;
+            try {
+                certificate = make_shared<IdentityCertificate>(data);
+            }
+            catch (const std::exception& e) {
+                onCertificateUnavailable(keyName, std::string("malformed certificate: ") + e.what());
+                return;
+            }
+            if (certificate->isTooEarly() || certificate->isTooLate()) {
+                onCertificateUnavailable(keyName, "certificate not valid now");
+                return;
+            }
+            if (m_trustAnchor != nullptr && !Validator::verifySignature(*certificate, *m_trustAnchor)) {
+                onCertificateUnavailable(keyName, "certificate not signed by the trust anchor");
+                return;
+            }
+
+            Signer& signer = m_signers[keyName];
+            signer.key = make_shared<PublicKey>(certificate->getPublicKeyInfo());
+            signer.isFetching = false;
+            signer.nRetries = 0;
+            signer.expiry = time::steady_clock::now() + CERTIFICATE_CACHE_LIFETIME;
+            DSU_LOG_DEBUG("Fetched certificate " << certificate->getName());
+            enqueue(keyName, signer);
+        }
+
+        void
+        DataVerifier::onCertificateTimeout(const Interest& interest)
+        {
+            Signer& signer = m_signers[interest.getName()];
+            if (signer.nRetries++ < CERTIFICATE_MAX_RETRIES) {
+                Interest retry(interest.getName());
+                retry.setInterestLifetime(CERTIFICATE_INTEREST_LIFETIME);
+                retry.setNonce(generateRandomWord());
+                m_face.expressInterest(retry,
+                                       bind(&DataVerifier::onCertificate, this, _1, _2),
+                                       bind(&DataVerifier::onCertificateTimeout, this, _1));
+                return;
+            }
+            onCertificateUnavailable(interest.getName(), "certificate fetch timed out");
+        }
+
+        void
+        DataVerifier::onCertificateUnavailable(const Name& keyName, const std::string& reason)
+        {
+            DSU_LOG_WARN("Key " << keyName << ": " << reason);
+            Signer& signer = m_signers[keyName];
+            signer.key.reset();
+            signer.isFetching = false;
+            signer.nRetries = 0;
+            signer.expiry = time::steady_clock::now() + CERTIFICATE_HOLDOFF;
+            enqueue(keyName, signer);
+        }
+
+        void
+        DataVerifier::removeKeys(const Name& prefix)
+        {
+            SignerMap::iterator it = m_signers.lower_bound(prefix);
+            while (it != m_signers.end() && prefix.isPrefixOf(it->first)) {
+                if (!it->second.isFetching && it->second.entries.empty()) {
+                    m_signers.erase(it++);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,156 @@
+#ifndef NDNFIT_DSU_DATA_VERIFIER_HPP
+#define NDNFIT_DSU_DATA_VERIFIER_HPP
+
+#include "face-endpoint.hpp"
+#include "verification-pool.hpp"
+
+#include <ndn-cxx/security/identity-certificate.hpp>
+#include <deque>
+#include <map>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Checks the signatures of fetched Data packets before they are stored
+         *
+         * A packet must be signed by a key named under the first @p keyPrefixLength components
+         * of its own name, i.e. by a key of the user it belongs to. The certificate of each key
+         * is fetched through @p face the first time the key is seen, and cached for an hour;
+         * if a trust anchor is set, the certificate must be signed by it. A certificate that
+         * cannot be fetched or is not acceptable is remembered for a minute, and the packets
+         * signed by its key are rejected meanwhile.
+         *
+         * Packets signed by the same key are gathered into one batch for the VerificationPool
+         * (typically the datapoints listed in one catalog), which is handed over once it has
+         * @p maxBatch packets or when the io_service has run the handlers already queued. The
+         * outcome of the packets signed by a key is reported in the order they were passed to
+         * verify(), whichever batch finishes first. A packet rejected for want of a certificate
+         * is reported as transient, it may be accepted once the certificate can be had.
+         */
+        class DataVerifier : noncopyable
+        {
+        public:
+            typedef function<void(const Data& data)> AcceptedCallback;
+            typedef function<void(const Data& data, const std::string& reason, bool isTransient)> RejectedCallback;
+
+            DataVerifier(boost::asio::io_service& ioService, FaceEndpoint& face, size_t nThreads,
+                         size_t keyPrefixLength, const AcceptedCallback& onAccepted,
+                         const RejectedCallback& onRejected, size_t maxBatch = 64);
+
+            /// only accept certificates signed by @p anchor
+            void
+            setTrustAnchor(const IdentityCertificate& anchor);
+
+            void
+            verify(const Data& data);
+
+            /// forget the certificates of the keys under @p prefix, unless packets wait for them
+            void
+            removeKeys(const Name& prefix);
+
+            /// keys whose certificate is cached or being fetched
+            size_t
+            getKeyCount() const
+            {
+                return m_signers.size();
+            }
+
+            /// packets passed to verify() whose outcome has not been reported yet
+            size_t
+            getBacklog() const
+            {
+                return m_backlog;
+            }
+
+            uint64_t
+            getCertificateFetchCount() const
+            {
+                return m_nCertificateFetches;
+            }
+
+        private:
+            enum State {
+                WAITING,
+                ACCEPTED,
+                BAD_SIGNATURE,
+                NO_CERTIFICATE
+            };
+
+            struct Entry
+            {
+                shared_ptr<const Data> data;
+                State state;
+            };
+
+            struct Signer
+            {
+                Signer();
+
+                // null while unknown, and while the certificate is held unavailable
+                shared_ptr<const PublicKey> key;
+                bool isFetching;
+                int nRetries;
+                // the certificate, or its absence, is fetched again from then on
+                time::steady_clock::TimePoint expiry;
+                // packets signed by the key, in the order they came, numbered from firstSeq
+                std::deque<Entry> entries;
+                uint64_t firstSeq;
+                // the entries from this one on are not in a batch yet
+                uint64_t nextUnbatched;
+                // being filled
+                shared_ptr<VerificationPool::Batch> batch;
+            };
+
+            typedef std::map<Name, Signer> SignerMap;
+
+            // batch the packets of @p signer that wait for nothing but a batch
+            void
+            enqueue(const Name& keyName, Signer& signer);
+
+            void
+            submit(const Name& keyName, Signer& signer);
+
+            void
+            flushBatches();
+
+            void
+            onVerified(const Name& keyName, const shared_ptr<VerificationPool::Batch>& batch);
+
+            // report the outcome of the packets at the head of @p signer
+            void
+            deliver(Signer& signer);
+
+            void
+            fetchCertificate(const Name& keyName);
+
+            void
+            onCertificate(const Interest& interest, const Data& data);
+
+            void
+            onCertificateTimeout(const Interest& interest);
+
+            void
+            onCertificateUnavailable(const Name& keyName, const std::string& reason);
+
+        private:
+            boost::asio::io_service& m_ioService;
+            FaceEndpoint& m_face;
+            size_t m_keyPrefixLength;
+            AcceptedCallback m_onAccepted;
+            RejectedCallback m_onRejected;
+            size_t m_maxBatch;
+            shared_ptr<const PublicKey> m_trustAnchor;
+            SignerMap m_signers;
+            // keys with a batch being filled, handed over by flushBatches()
+            std::vector<Name> m_openBatches;
+            bool m_isFlushPosted;
+            size_t m_backlog;
+            uint64_t m_nCertificateFetches;
+            VerificationPool m_pool;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_DATA_VERIFIER_HPP
@@ -0,0 +1,58 @@
+#include "face-endpoint.hpp"
+
+namespace ndn {
+    namespace dsu {
+
+        ShardFaceEndpoint::ShardFaceEndpoint(Face& face, Mailbox& toFace, Mailbox& toShard, const PutCallback& put)
+        : m_face(face)
+        , m_toFace(toFace)
+        , m_toShard(toShard)
+        , m_put(put)
+        {
+        }
+
+        void
+        ShardFaceEndpoint::expressInterest(const Interest& interest, const OnData& onData, const OnTimeout& onTimeout)
+        {
+            m_toFace.post(bind(&ShardFaceEndpoint::expressOnFace, this, interest, onData, onTimeout));
+        }
+
+        void
+        ShardFaceEndpoint::put(const Data& data)
+        {
+            m_toFace.post(bind(&ShardFaceEndpoint::putOnFace, this, data));
+        }
+
+        void
+        ShardFaceEndpoint::expressOnFace(const Interest& interest, const OnData& onData, const OnTimeout& onTimeout)
+        {
+            m_face.expressInterest(interest,
+                                   bind(&ShardFaceEndpoint::onFaceData, this, _1, _2, onData),
+                                   bind(&ShardFaceEndpoint::onFaceTimeout, this, _1, onTimeout));
+        }
+
+        void
+        ShardFaceEndpoint::onFaceData(const Interest& interest, const Data& data, const OnData& onData)
+        {
+            // the copies are handed over, the Face thread does not touch them again
+            m_toShard.post(bind(onData, interest, data));
+        }
+
+        void
+        ShardFaceEndpoint::onFaceTimeout(const Interest& interest, const OnTimeout& onTimeout)
+        {
+            m_toShard.post(bind(onTimeout, interest));
+        }
+
+        void
+        ShardFaceEndpoint::putOnFace(const Data& data)
+        {
+            if (m_put) {
+                m_put(data);
+            } else {
+                m_face.put(data);
+            }
+        }
+
+    } // namespace dsu
+} // namespace ndn
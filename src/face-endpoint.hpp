@@ -0,0 +1,108 @@
+#ifndef NDNFIT_DSU_FACE_ENDPOINT_HPP
+#define NDNFIT_DSU_FACE_ENDPOINT_HPP
+
+#include "mailbox.hpp"
+
+#include <ndn-cxx/face.hpp>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief What a sync engine needs from the Face: express Interests and put replies
+         *
+         * The callbacks of expressInterest() run on the engine's own thread.
+         */
+        class FaceEndpoint : noncopyable
+        {
+        public:
+            /// puts a reply on the Face, on the Face's thread
+            typedef function<void(const Data& data)> PutCallback;
+
+            virtual
+            ~FaceEndpoint()
+            {
+            }
+
+            virtual void
+            expressInterest(const Interest& interest, const OnData& onData, const OnTimeout& onTimeout) = 0;
+
+            virtual void
+            put(const Data& data) = 0;
+        };
+
+        /// an engine running on the thread of the Face; replies go to @p put if given
+        class DirectFaceEndpoint : public FaceEndpoint
+        {
+        public:
+            explicit
+            DirectFaceEndpoint(Face& face, const PutCallback& put = PutCallback())
+            : m_face(face)
+            , m_put(put)
+            {
+            }
+
+            virtual void
+            expressInterest(const Interest& interest, const OnData& onData, const OnTimeout& onTimeout)
+            {
+                m_face.expressInterest(interest, onData, onTimeout);
+            }
+
+            virtual void
+            put(const Data& data)
+            {
+                if (m_put) {
+                    m_put(data);
+                } else {
+                    m_face.put(data);
+                }
+            }
+
+        private:
+            Face& m_face;
+            PutCallback m_put;
+        };
+
+        /**
+         * @brief An engine running on a shard thread of its own
+         *
+         * Interests and replies are posted to the Face thread through @p toFace, which
+         * expresses them or puts them (to @p put if given); Data and timeouts come back
+         * through @p toShard.
+         */
+        class ShardFaceEndpoint : public FaceEndpoint
+        {
+        public:
+            ShardFaceEndpoint(Face& face, Mailbox& toFace, Mailbox& toShard, const PutCallback& put = PutCallback());
+
+            virtual void
+            expressInterest(const Interest& interest, const OnData& onData, const OnTimeout& onTimeout);
+
+            virtual void
+            put(const Data& data);
+
+        private:
+            // on the Face thread
+            void
+            expressOnFace(const Interest& interest, const OnData& onData, const OnTimeout& onTimeout);
+
+            void
+            onFaceData(const Interest& interest, const Data& data, const OnData& onData);
+
+            void
+            onFaceTimeout(const Interest& interest, const OnTimeout& onTimeout);
+
+            void
+            putOnFace(const Data& data);
+
+        private:
+            Face& m_face;
+            Mailbox& m_toFace;
+            Mailbox& m_toShard;
+            PutCallback m_put;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_FACE_ENDPOINT_HPP
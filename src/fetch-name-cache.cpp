@@ -0,0 +1,178 @@
+#include "fetch-name-cache.hpp"
+
+#include "random-word.hpp"
+
+#include <ndn-cxx/encoding/tlv.hpp>
+
+namespace ndn {
+    namespace dsu {
+
+        // naming conventions markers, as written by Name::appendSequenceNumber and friends
+        static const uint8_t TIMESTAMP_MARKER = 0xFC;
+        static const uint8_t VERSION_MARKER = 0xFD;
+        static const uint8_t SEQUENCE_NUMBER_MARKER = 0xFE;
+
+        static size_t
+        sizeOfNonNegativeInteger(uint64_t value)
+        {
+            return value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFF ? 4 : 8;
+        }
+
+        static void
+        appendNonNegativeInteger(std::vector<uint8_t>& buffer, uint64_t value)
+        {
+            for (size_t i = sizeOfNonNegativeInteger(value); i > 0; i--) {
+                buffer.push_back(static_cast<uint8_t>(value >> (8 * (i - 1))));
+            }
+        }
+
+        static size_t
+        sizeOfVarNumber(uint64_t value)
+        {
+            return value < 253 ? 1 : value <= 0xFFFF ? 3 : value <= 0xFFFFFFFF ? 5 : 9;
+        }
+
+        static void
+        appendVarNumber(std::vector<uint8_t>& buffer, uint64_t value)
+        {
+            if (value < 253) {
+                buffer.push_back(static_cast<uint8_t>(value));
+                return;
+            }
+            size_t nBytes = sizeOfVarNumber(value) - 1;
+            buffer.push_back(nBytes == 2 ? 253 : nBytes == 4 ? 254 : 255);
+            for (size_t i = nBytes; i > 0; i--) {
+                buffer.push_back(static_cast<uint8_t>(value >> (8 * (i - 1))));
+            }
+        }
+
+        // a marker followed by a number is never longer than 9 bytes, its length is a single byte
+        static size_t
+        sizeOfMarkedComponent(uint64_t value)
+        {
+            return 3 + sizeOfNonNegativeInteger(value);
+        }
+
+        static void
+        appendMarkedComponent(std::vector<uint8_t>& buffer, uint8_t marker, uint64_t value)
+        {
+            buffer.push_back(tlv::NameComponent);
+            buffer.push_back(static_cast<uint8_t>(1 + sizeOfNonNegativeInteger(value)));
+            buffer.push_back(marker);
+            appendNonNegativeInteger(buffer, value);
+        }
+
+        static std::vector<uint8_t>
+        getComponents(const Name& name)
+        {
+            const Block& wire = name.wireEncode();
+            return std::vector<uint8_t>(wire.value_begin(), wire.value_end());
+        }
+
+        FetchNameCache::FetchNameCache(const Name& commonPrefix, const Name& dataSuffix)
+        : m_commonPrefix(getComponents(commonPrefix))
+        , m_dataSuffix(getComponents(dataSuffix))
+        , m_updateInfoComponent(getComponents(Name().append("update_info")))
+        , m_catalogComponent(getComponents(Name().append("catalog")))
+        {
+            // Selectors { MustBeFresh }
+            m_selectors.push_back(tlv::Selectors);
+            m_selectors.push_back(2);
+            m_selectors.push_back(tlv::MustBeFresh);
+            m_selectors.push_back(0);
+        }
+
+        const std::vector<uint8_t>&
+        FetchNameCache::getUserPrefix(const name::Component& user)
+        {
+            std::map<name::Component, std::vector<uint8_t>>::iterator it = m_userPrefixes.find(user);
+            if (it == m_userPrefixes.end()) {
+                std::vector<uint8_t> prefix(m_commonPrefix);
+                prefix.insert(prefix.end(), user.wire(), user.wire() + user.size());
+                prefix.insert(prefix.end(), m_dataSuffix.begin(), m_dataSuffix.end());
+                it = m_userPrefixes.insert(std::make_pair(user, prefix)).first;
+            }
+            return it->second;
+        }
+
+        void
+        FetchNameCache::removeUser(const name::Component& user)
+        {
+            m_userPrefixes.erase(user);
+        }
+
+        Name
+        FetchNameCache::makeName(const name::Component& user, const FetchKey& key)
+        {
+            const std::vector<uint8_t>& prefix = getUserPrefix(user);
+            // names carry timestamps in microseconds, keys in milliseconds
+            uint64_t timestamp = key.id * 1000;
+            size_t length = prefix.size();
+            switch (key.kind) {
+                case FETCH_UPDATE_INFO:
+                    length += m_updateInfoComponent.size() + sizeOfMarkedComponent(key.id);
+                    break;
+                case FETCH_CATALOG:
+                    length += m_catalogComponent.size() + sizeOfMarkedComponent(timestamp) +
+                              sizeOfMarkedComponent(key.version);
+                    break;
+                default:
+                    length += sizeOfMarkedComponent(timestamp);
+                    break;
+            }
+
+            m_buffer.clear();
+            m_buffer.push_back(tlv::Name);
+            appendVarNumber(m_buffer, length);
+            m_buffer.insert(m_buffer.end(), prefix.begin(), prefix.end());
+            switch (key.kind) {
+                case FETCH_UPDATE_INFO:
+                    m_buffer.insert(m_buffer.end(), m_updateInfoComponent.begin(), m_updateInfoComponent.end());
+                    appendMarkedComponent(m_buffer, SEQUENCE_NUMBER_MARKER, key.id);
+                    break;
+                case FETCH_CATALOG:
+                    m_buffer.insert(m_buffer.end(), m_catalogComponent.begin(), m_catalogComponent.end());
+                    appendMarkedComponent(m_buffer, TIMESTAMP_MARKER, timestamp);
+                    appendMarkedComponent(m_buffer, VERSION_MARKER, key.version);
+                    break;
+                default:
+                    appendMarkedComponent(m_buffer, TIMESTAMP_MARKER, timestamp);
+                    break;
+            }
+            return Name(Block(&m_buffer[0], m_buffer.size()));
+        }
+
+        Interest
+        FetchNameCache::makeInterest(const Name& name, const time::milliseconds& lifetime)
+        {
+            // encoded once if the name was not made by makeName()
+            const Block& nameWire = name.wireEncode();
+            uint64_t lifetimeMs = static_cast<uint64_t>(lifetime.count());
+            // left out when it is the default, as Interest::wireEncode() does
+            bool hasLifetime = lifetime != DEFAULT_INTEREST_LIFETIME;
+            size_t length = nameWire.size() + m_selectors.size() + 6;
+            if (hasLifetime) {
+                length += 2 + sizeOfNonNegativeInteger(lifetimeMs);
+            }
+
+            m_buffer.clear();
+            m_buffer.push_back(tlv::Interest);
+            appendVarNumber(m_buffer, length);
+            m_buffer.insert(m_buffer.end(), nameWire.wire(), nameWire.wire() + nameWire.size());
+            m_buffer.insert(m_buffer.end(), m_selectors.begin(), m_selectors.end());
+            m_buffer.push_back(tlv::Nonce);
+            m_buffer.push_back(4);
+            uint32_t nonce = generateRandomWord();
+            for (size_t i = 0; i < 4; i++) {
+                m_buffer.push_back(static_cast<uint8_t>(nonce >> (8 * i)));
+            }
+            if (hasLifetime) {
+                m_buffer.push_back(tlv::InterestLifetime);
+                m_buffer.push_back(static_cast<uint8_t>(sizeOfNonNegativeInteger(lifetimeMs)));
+                appendNonNegativeInteger(m_buffer, lifetimeMs);
+            }
+            return Interest(Block(&m_buffer[0], m_buffer.size()));
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,70 @@
+#ifndef NDNFIT_DSU_FETCH_NAME_CACHE_HPP
+#define NDNFIT_DSU_FETCH_NAME_CACHE_HPP
+
+#include "pending-fetch-table.hpp"
+
+#include <ndn-cxx/interest.hpp>
+
+#include <map>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Encoder of the names fetched from phones and of the Interests for them
+         *
+         * The components of <common prefix>/<user_id>/<data suffix> are encoded once per user.
+         * A name is written into a buffer reused from one call to the next: the cached prefix,
+         * then the update_info or catalog component and the sequence number, timestamp and
+         * version of the FetchKey. The Name is decoded from that buffer and keeps it as its
+         * encoding, so making an Interest for it does not encode it again.
+         *
+         * makeInterest() assembles the Interest around the encoding of its name the same way:
+         * the selectors are encoded once, only the nonce and the lifetime are written each time.
+         * The result is byte for byte what Interest::wireEncode() gives for the same name,
+         * lifetime and nonce.
+         */
+        class FetchNameCache : noncopyable
+        {
+        public:
+            FetchNameCache(const Name& commonPrefix, const Name& dataSuffix);
+
+            /// the name of @p key, see FetchKey for the layout
+            Name
+            makeName(const name::Component& user, const FetchKey& key);
+
+            /// Interest for @p name with MustBeFresh, a random nonce and @p lifetime
+            Interest
+            makeInterest(const Name& name, const time::milliseconds& lifetime);
+
+            /// forget the prefix of @p user
+            void
+            removeUser(const name::Component& user);
+
+            size_t
+            getUserCount() const
+            {
+                return m_userPrefixes.size();
+            }
+
+        private:
+            const std::vector<uint8_t>&
+            getUserPrefix(const name::Component& user);
+
+        private:
+            // component TLVs before and after the user_id
+            std::vector<uint8_t> m_commonPrefix;
+            std::vector<uint8_t> m_dataSuffix;
+            std::vector<uint8_t> m_updateInfoComponent;
+            std::vector<uint8_t> m_catalogComponent;
+            std::vector<uint8_t> m_selectors;
+            // component TLVs of <common prefix>/<user_id>/<data suffix>
+            std::map<name::Component, std::vector<uint8_t>> m_userPrefixes;
+            std::vector<uint8_t> m_buffer;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_FETCH_NAME_CACHE_HPP
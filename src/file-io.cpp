@@ -0,0 +1,79 @@
+#include "file-io.hpp"
+
+#include <boost/crc.hpp>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ndn {
+    namespace dsu {
+
+        std::string
+        describeErrno(const std::string& what, const std::string& path)
+        {
+            return what + " " + path + ": " + std::strerror(errno);
+        }
+
+        void
+        putUint(std::vector<uint8_t>& buffer, uint64_t value, size_t nBytes)
+        {
+            for (size_t i = 0; i < nBytes; i++) {
+                buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        uint64_t
+        getUint(const uint8_t* data, size_t nBytes)
+        {
+            uint64_t value = 0;
+            for (size_t i = 0; i < nBytes; i++) {
+                value |= static_cast<uint64_t>(data[i]) << (8 * i);
+            }
+            return value;
+        }
+
+        uint32_t
+        checksum(const uint8_t* data, size_t size)
+        {
+            boost::crc_32_type crc;
+            crc.process_bytes(data, size);
+            return crc.checksum();
+        }
+
+        bool
+        writeFile(const std::string& path, const std::vector<uint8_t>& content, bool isSynced,
+                  std::string& error)
+        {
+            int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                error = describeErrno("cannot create", path);
+                return false;
+            }
+            size_t written = 0;
+            while (written < content.size()) {
+                ssize_t n = ::write(fd, &content[written], content.size() - written);
+                if (n < 0 && errno != EINTR) {
+                    error = describeErrno("cannot write", path);
+                    ::close(fd);
+                    ::unlink(path.c_str());
+                    return false;
+                }
+                written += n > 0 ? n : 0;
+            }
+            if (isSynced && ::fsync(fd) != 0) {
+                error = describeErrno("cannot sync", path);
+                ::close(fd);
+                ::unlink(path.c_str());
+                return false;
+            }
+            if (::close(fd) != 0) {
+                error = describeErrno("cannot write", path);
+                ::unlink(path.c_str());
+                return false;
+            }
+            return true;
+        }
+
+    } // namespace dsu
+} // namespace ndn
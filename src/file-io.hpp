@@ -0,0 +1,42 @@
+#ifndef NDNFIT_DSU_FILE_IO_HPP
+#define NDNFIT_DSU_FILE_IO_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace ndn {
+    namespace dsu {
+
+        /// "<what> <path>: <description of errno>"
+        std::string
+        describeErrno(const std::string& what, const std::string& path);
+
+        /// append the @p nBytes low bytes of @p value, least significant first
+        void
+        putUint(std::vector<uint8_t>& buffer, uint64_t value, size_t nBytes);
+
+        /// read a number written by putUint()
+        uint64_t
+        getUint(const uint8_t* data, size_t nBytes);
+
+        /// CRC-32 of @p size bytes at @p data
+        uint32_t
+        checksum(const uint8_t* data, size_t size);
+
+        /**
+         * @brief Write @p content to @p path, replacing the file, and fsync it if @p isSynced
+         *
+         * On failure the descriptor is closed and the file removed, so that no partial file
+         * is left behind; the caller renames a complete file into place.
+         * @return false, with @p error describing the failing call, if the file cannot be written
+         */
+        bool
+        writeFile(const std::string& path, const std::vector<uint8_t>& content, bool isSynced,
+                  std::string& error);
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_FILE_IO_HPP
@@ -0,0 +1,176 @@
+#include "interest-scheduler.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+    namespace dsu {
+
+        InterestScheduler::InterestScheduler(FaceEndpoint& face, size_t maxInFlight,
+                                             double initialWindow, double maxWindow, size_t quantum)
+        : m_face(face)
+        , m_maxInFlight(std::max<size_t>(1, maxInFlight))
+        , m_initialWindow(std::max(1.0, initialWindow))
+        , m_maxWindow(std::max(m_initialWindow, maxWindow))
+        , m_quantum(std::max<size_t>(1, quantum))
+        , m_nQueued(0)
+        , m_nInFlight(0)
+        {
+        }
+
+        void
+        InterestScheduler::express(const name::Component& user, const Interest& interest,
+                                   const DataCallback& onData, const TimeoutCallback& onTimeout)
+        {
+            UserTable::iterator it = m_users.find(user);
+            if (it == m_users.end()) {
+                it = m_users.insert(std::make_pair(user, UserState(m_initialWindow, m_maxWindow))).first;
+            }
+            it->second.isRemoved = false;
+            Request request = {interest, onData, onTimeout};
+            it->second.queue.push_back(request);
+            m_nQueued++;
+            activate(it);
+            dispatch();
+        }
+
+        void
+        InterestScheduler::activate(UserTable::iterator it)
+        {
+            if (!it->second.isActive && it->second.canSend()) {
+                it->second.isActive = true;
+                m_activeUsers.push_back(it);
+            }
+        }
+
+        void
+        InterestScheduler::dispatch()
+        {
+            while (m_nInFlight < m_maxInFlight && !m_activeUsers.empty()) {
+                UserTable::iterator it = m_activeUsers.front();
+                UserState& state = it->second;
+                if (!state.hasTurn) {
+                    state.deficit += m_quantum;
+                    state.hasTurn = true;
+                }
+                while (state.deficit > 0 && state.canSend() && m_nInFlight < m_maxInFlight) {
+                    send(it);
+                    state.deficit--;
+                }
+                if (state.deficit > 0 && state.canSend()) {
+                    // stopped by the global cap, the turn goes on once a reply frees a slot
+                    break;
+                }
+
+                m_activeUsers.pop_front();
+                state.hasTurn = false;
+                if (state.canSend()) {
+                    m_activeUsers.push_back(it);
+                } else {
+                    // nothing more to send for now, a user does not bank unused turns
+                    state.isActive = false;
+                    state.deficit = 0;
+                }
+            }
+        }
+
+        void
+        InterestScheduler::send(UserTable::iterator it)
+        {
+            Request request = it->second.queue.front();
+            it->second.queue.pop_front();
+            m_nQueued--;
+            it->second.nInFlight++;
+            m_nInFlight++;
+
+            time::steady_clock::TimePoint now = time::steady_clock::now();
+            m_face.expressInterest(request.interest,
+                                   bind(&InterestScheduler::onData, this, it->first, _1, _2, now, request.onData),
+                                   bind(&InterestScheduler::onTimeout, this, it->first, _1, now, request.onTimeout));
+        }
+
+        void
+        InterestScheduler::onData(const name::Component& user, const Interest& interest, const Data& data,
+                                  const time::steady_clock::TimePoint& sentAt, const DataCallback& callback)
+        {
+            UserTable::iterator it = m_users.find(user);
+            UserState& state = it->second;
+            state.nInFlight--;
+            m_nInFlight--;
+            if (state.window < state.ssthresh) {
+                state.window += 1;
+            } else {
+                state.window += 1 / state.window;
+            }
+            state.window = std::min(state.window, m_maxWindow);
+            activate(it);
+
+            callback(interest, data, sentAt);
+            eraseIfRemoved(user);
+            dispatch();
+        }
+
+        void
+        InterestScheduler::onTimeout(const name::Component& user, const Interest& interest,
+                                     const time::steady_clock::TimePoint& sentAt, const TimeoutCallback& callback)
+        {
+            UserTable::iterator it = m_users.find(user);
+            UserState& state = it->second;
+            state.nInFlight--;
+            m_nInFlight--;
+            // Interests sent before the last decrease belong to the same loss episode
+            if (sentAt >= state.lastDecrease) {
+                state.window = std::max(1.0, state.window / 2);
+                state.ssthresh = state.window;
+                state.lastDecrease = time::steady_clock::now();
+            }
+            activate(it);
+
+            callback(interest, sentAt);
+            eraseIfRemoved(user);
+            dispatch();
+        }
+
+        void
+        InterestScheduler::removeUser(const name::Component& user)
+        {
+            UserTable::iterator it = m_users.find(user);
+            if (it != m_users.end()) {
+                it->second.isRemoved = true;
+                eraseIfRemoved(user);
+            }
+        }
+
+        void
+        InterestScheduler::eraseIfRemoved(const name::Component& user)
+        {
+            // an idle user is not in the round-robin list, nothing else refers to its entry
+            UserTable::iterator it = m_users.find(user);
+            if (it != m_users.end() && it->second.isRemoved && it->second.queue.empty() &&
+                it->second.nInFlight == 0) {
+                m_users.erase(it);
+            }
+        }
+
+        size_t
+        InterestScheduler::getQueueDepth(const name::Component& user) const
+        {
+            UserTable::const_iterator it = m_users.find(user);
+            return it != m_users.end() ? it->second.queue.size() : 0;
+        }
+
+        size_t
+        InterestScheduler::getInFlight(const name::Component& user) const
+        {
+            UserTable::const_iterator it = m_users.find(user);
+            return it != m_users.end() ? it->second.nInFlight : 0;
+        }
+
+        double
+        InterestScheduler::getWindow(const name::Component& user) const
+        {
+            UserTable::const_iterator it = m_users.find(user);
+            return it != m_users.end() ? it->second.window : m_initialWindow;
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,153 @@
+#ifndef NDNFIT_DSU_INTEREST_SCHEDULER_HPP
+#define NDNFIT_DSU_INTEREST_SCHEDULER_HPP
+
+#include "face-endpoint.hpp"
+
+#include <ndn-cxx/util/time.hpp>
+#include <deque>
+#include <map>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Shares the Face among users when expressing Interests to phones
+         *
+         * Interests are queued per user and expressed under two limits: a congestion window
+         * per user, and a cap on the Interests in flight over all users. Users with queued
+         * Interests are served by deficit round-robin: each turn adds @p quantum Interests to
+         * the user's deficit, so a user with a large backlog gets the same share as everybody
+         * else instead of delaying them.
+         *
+         * The window starts at @p initialWindow, doubles every round trip up to the slow start
+         * threshold, then grows by one per window of replies. A timeout halves it, once per
+         * loss episode.
+         */
+        class InterestScheduler : noncopyable
+        {
+        public:
+            typedef function<void(const Interest& interest, const Data& data,
+                                  const time::steady_clock::TimePoint& sentAt)> DataCallback;
+            typedef function<void(const Interest& interest,
+                                  const time::steady_clock::TimePoint& sentAt)> TimeoutCallback;
+
+            InterestScheduler(FaceEndpoint& face, size_t maxInFlight = 512,
+                              double initialWindow = 4, double maxWindow = 64, size_t quantum = 4);
+
+            /**
+             * @brief Queue @p interest on behalf of @p user
+             *
+             * The callbacks receive the time the Interest was actually expressed.
+             */
+            void
+            express(const name::Component& user, const Interest& interest,
+                    const DataCallback& onData, const TimeoutCallback& onTimeout);
+
+            /// drop the state of @p user, once it has nothing queued or in flight
+            void
+            removeUser(const name::Component& user);
+
+            /// Interests waiting for @p user
+            size_t
+            getQueueDepth(const name::Component& user) const;
+
+            size_t
+            getInFlight(const name::Component& user) const;
+
+            double
+            getWindow(const name::Component& user) const;
+
+            size_t
+            getQueued() const
+            {
+                return m_nQueued;
+            }
+
+            size_t
+            getInFlight() const
+            {
+                return m_nInFlight;
+            }
+
+        private:
+            struct Request
+            {
+                Interest interest;
+                DataCallback onData;
+                TimeoutCallback onTimeout;
+            };
+
+            struct UserState
+            {
+                UserState(double initialWindow, double maxWindow)
+                : window(initialWindow)
+                , ssthresh(maxWindow)
+                , nInFlight(0)
+                , deficit(0)
+                , isActive(false)
+                , hasTurn(false)
+                , isRemoved(false)
+                , lastDecrease(time::steady_clock::TimePoint::min())
+                {
+                }
+
+                bool
+                canSend() const
+                {
+                    return !queue.empty() && nInFlight < static_cast<size_t>(window);
+                }
+
+                std::deque<Request> queue;
+                double window;
+                double ssthresh;
+                size_t nInFlight;
+                size_t deficit;
+                // in the round-robin list
+                bool isActive;
+                // the quantum for the current turn has been granted
+                bool hasTurn;
+                // erased as soon as it is idle
+                bool isRemoved;
+                time::steady_clock::TimePoint lastDecrease;
+            };
+
+            typedef std::map<name::Component, UserState> UserTable;
+
+            void
+            dispatch();
+
+            void
+            send(UserTable::iterator it);
+
+            void
+            activate(UserTable::iterator it);
+
+            void
+            eraseIfRemoved(const name::Component& user);
+
+            void
+            onData(const name::Component& user, const Interest& interest, const Data& data,
+                   const time::steady_clock::TimePoint& sentAt, const DataCallback& callback);
+
+            void
+            onTimeout(const name::Component& user, const Interest& interest,
+                      const time::steady_clock::TimePoint& sentAt, const TimeoutCallback& callback);
+
+        private:
+            FaceEndpoint& m_face;
+            size_t m_maxInFlight;
+            double m_initialWindow;
+            double m_maxWindow;
+            size_t m_quantum;
+
+            UserTable m_users;
+            // users that have queued Interests and room in their window
+            std::deque<UserTable::iterator> m_activeUsers;
+            size_t m_nQueued;
+            size_t m_nInFlight;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_INTEREST_SCHEDULER_HPP
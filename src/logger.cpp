@@ -0,0 +1,285 @@
+#include "logger.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        static const size_t QUEUE_CAPACITY = 1 << 16;
+        // how long the writer sleeps when there is nothing to write
+        static const std::chrono::milliseconds IDLE_INTERVAL(5);
+
+        static const char* const LEVEL_NAMES[] = {"TRACE", "DEBUG", "INFO", "WARN", "ERROR", "NONE"};
+
+        namespace {
+
+            struct Record
+            {
+                std::chrono::system_clock::time_point time;
+                LogLevel level;
+                const char* module;
+                std::string message;
+            };
+
+            /// bounded multi-producer queue after Dmitry Vyukov; only the writer thread pops
+            class RecordQueue
+            {
+            public:
+                RecordQueue()
+                : m_cells(QUEUE_CAPACITY)
+                , m_enqueuePosition(0)
+                , m_dequeuePosition(0)
+                {
+                    for (size_t i = 0; i < m_cells.size(); i++) {
+                        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+                    }
+                }
+
+                bool
+                push(Record& record)
+                {
+                    size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+                    Cell* cell = 0;
+                    while (true) {
+                        cell = &m_cells[position & (QUEUE_CAPACITY - 1)];
+                        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                        intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                        if (difference == 0) {
+                            if (m_enqueuePosition.compare_exchange_weak(position, position + 1,
+                                                                        std::memory_order_relaxed)) {
+                                break;
+                            }
+                        } else if (difference < 0) {
+                            return false;
+                        } else {
+                            position = m_enqueuePosition.load(std::memory_order_relaxed);
+                        }
+                    }
+                    cell->record = std::move(record);
+                    cell->sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+
+                bool
+                pop(Record& record)
+                {
+                    Cell& cell = m_cells[m_dequeuePosition & (QUEUE_CAPACITY - 1)];
+                    if (cell.sequence.load(std::memory_order_acquire) != m_dequeuePosition + 1) {
+                        return false;
+                    }
+                    record = std::move(cell.record);
+                    cell.sequence.store(m_dequeuePosition + QUEUE_CAPACITY, std::memory_order_release);
+                    m_dequeuePosition++;
+                    return true;
+                }
+
+            private:
+                struct Cell
+                {
+                    std::atomic<size_t> sequence;
+                    Record record;
+                };
+
+                std::vector<Cell> m_cells;
+                std::atomic<size_t> m_enqueuePosition;
+                size_t m_dequeuePosition;
+            };
+
+            class Sink
+            {
+            public:
+                Sink()
+                : defaultLevel(LOG_INFO)
+                , m_nDropped(0)
+                , m_isStopping(false)
+                , m_thread(&Sink::run, this)
+                {
+                }
+
+                ~Sink()
+                {
+                    m_isStopping.store(true);
+                    m_thread.join();
+                }
+
+                void
+                push(Record& record)
+                {
+                    if (!m_queue.push(record)) {
+                        m_nDropped.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+
+                void
+                flush()
+                {
+                    std::lock_guard<std::mutex> lock(m_writeMutex);
+                    drain();
+                }
+
+                // module registry, only touched at startup and when levels change
+                std::mutex registryMutex;
+                std::map<std::string, LogModule*> modules;
+                std::map<std::string, LogLevel> levels;
+                LogLevel defaultLevel;
+
+            private:
+                void
+                run()
+                {
+                    while (!m_isStopping.load()) {
+                        bool hasWritten = false;
+                        {
+                            std::lock_guard<std::mutex> lock(m_writeMutex);
+                            hasWritten = drain();
+                        }
+                        if (!hasWritten) {
+                            std::this_thread::sleep_for(IDLE_INTERVAL);
+                        }
+                    }
+                    flush();
+                }
+
+                bool
+                drain()
+                {
+                    Record record;
+                    size_t nWritten = 0;
+                    while (m_queue.pop(record)) {
+                        write(record);
+                        nWritten++;
+                    }
+                    size_t nDropped = m_nDropped.exchange(0, std::memory_order_relaxed);
+                    if (nDropped > 0) {
+                        std::fprintf(stderr, "WARN: [Logging] %zu messages dropped\n", nDropped);
+                    }
+                    if (nWritten > 0 || nDropped > 0) {
+                        std::fflush(stderr);
+                    }
+                    return nWritten > 0;
+                }
+
+                static void
+                write(const Record& record)
+                {
+                    std::chrono::microseconds sinceEpoch =
+                        std::chrono::duration_cast<std::chrono::microseconds>(record.time.time_since_epoch());
+                    std::fprintf(stderr, "%lld.%06lld %s: [%s] ",
+                                 static_cast<long long>(sinceEpoch.count() / 1000000),
+                                 static_cast<long long>(sinceEpoch.count() % 1000000),
+                                 LEVEL_NAMES[record.level], record.module);
+                    std::fwrite(record.message.data(), 1, record.message.size(), stderr);
+                    std::fputc('\n', stderr);
+                }
+
+            private:
+                RecordQueue m_queue;
+                std::atomic<size_t> m_nDropped;
+                std::atomic<bool> m_isStopping;
+                // serializes flush() with the writer thread; never taken by producers
+                std::mutex m_writeMutex;
+                std::thread m_thread;
+            };
+
+        } // namespace
+
+        static Sink&
+        getSink()
+        {
+            static Sink sink;
+            return sink;
+        }
+
+        static LogLevel
+        parseLevel(const std::string& name)
+        {
+            for (int level = LOG_TRACE; level <= LOG_NONE; level++) {
+                std::string levelName = LEVEL_NAMES[level];
+                if (name.size() == levelName.size() &&
+                    std::equal(name.begin(), name.end(), levelName.begin(),
+                               [] (char a, char b) { return std::toupper(a) == b; })) {
+                    return static_cast<LogLevel>(level);
+                }
+            }
+            throw Logging::Error("unknown log level " + name);
+        }
+
+        LogModule::LogModule(const char* name)
+        : m_name(name)
+        , m_level(LOG_INFO)
+        {
+            Sink& sink = getSink();
+            std::lock_guard<std::mutex> lock(sink.registryMutex);
+            std::map<std::string, LogLevel>::iterator it = sink.levels.find(name);
+            m_level.store(it != sink.levels.end() ? it->second : sink.defaultLevel);
+            sink.modules[name] = this;
+        }
+
+        LogModule::~LogModule()
+        {
+            Sink& sink = getSink();
+            std::lock_guard<std::mutex> lock(sink.registryMutex);
+            sink.modules.erase(m_name);
+        }
+
+        void
+        Logging::log(const LogModule& module, LogLevel level, std::string&& message)
+        {
+            Record record;
+            record.time = std::chrono::system_clock::now();
+            record.level = level;
+            record.module = module.getName();
+            record.message = std::move(message);
+            getSink().push(record);
+        }
+
+        void
+        Logging::setLevels(const std::string& config)
+        {
+            LogLevel defaultLevel = LOG_INFO;
+            std::map<std::string, LogLevel> levels;
+            std::istringstream is(config);
+            std::string item;
+            while (std::getline(is, item, ',')) {
+                if (item.empty()) {
+                    continue;
+                }
+                size_t equal = item.find('=');
+                if (equal == std::string::npos) {
+                    throw Error("expected Module=level instead of " + item);
+                }
+                std::string module = item.substr(0, equal);
+                LogLevel level = parseLevel(item.substr(equal + 1));
+                if (module == "*") {
+                    defaultLevel = level;
+                } else {
+                    levels[module] = level;
+                }
+            }
+
+            Sink& sink = getSink();
+            std::lock_guard<std::mutex> lock(sink.registryMutex);
+            sink.defaultLevel = defaultLevel;
+            sink.levels.swap(levels);
+            for (std::map<std::string, LogModule*>::iterator it = sink.modules.begin(); it != sink.modules.end(); ++it) {
+                std::map<std::string, LogLevel>::iterator level = sink.levels.find(it->first);
+                it->second->setLevel(level != sink.levels.end() ? level->second : defaultLevel);
+            }
+        }
+
+        void
+        Logging::flush()
+        {
+            getSink().flush();
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,118 @@
+#ifndef NDNFIT_DSU_LOGGER_HPP
+#define NDNFIT_DSU_LOGGER_HPP
+
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace ndn {
+    namespace dsu {
+
+        enum LogLevel {
+            LOG_TRACE = 0,
+            LOG_DEBUG = 1,
+            LOG_INFO = 2,
+            LOG_WARN = 3,
+            LOG_ERROR = 4,
+            LOG_NONE = 5
+        };
+
+        /**
+         * @brief A named source of log messages, with its own level
+         *
+         * Declared once per translation unit with DSU_LOG_INIT. The level is read with a relaxed
+         * atomic load, so a disabled message costs one comparison and is never formatted.
+         */
+        class LogModule
+        {
+        public:
+            /// @param name must outlive the module, typically a string literal
+            explicit
+            LogModule(const char* name);
+
+            ~LogModule();
+
+            const char*
+            getName() const
+            {
+                return m_name;
+            }
+
+            bool
+            isEnabled(LogLevel level) const
+            {
+                return level >= m_level.load(std::memory_order_relaxed);
+            }
+
+            void
+            setLevel(LogLevel level)
+            {
+                m_level.store(level, std::memory_order_relaxed);
+            }
+
+        private:
+            const char* m_name;
+            std::atomic<int> m_level;
+        };
+
+        /**
+         * @brief Process-wide log sink
+         *
+         * Messages are pushed into a bounded lock-free queue and written to stderr by a
+         * background thread, so logging never blocks the I/O thread on the terminal or a file.
+         * If the queue is full the message is dropped and counted.
+         */
+        class Logging
+        {
+        public:
+            class Error : public std::runtime_error
+            {
+            public:
+                explicit
+                Error(const std::string& what)
+                : std::runtime_error(what)
+                {
+                }
+            };
+
+            static void
+            log(const LogModule& module, LogLevel level, std::string&& message);
+
+            /**
+             * @brief Set module levels from "Module=level,..." where "*" stands for every module
+             *
+             * Levels are trace, debug, info, warn, error and none. Modules not listed keep
+             * the "*" level, which defaults to info.
+             * @throw Error the configuration cannot be parsed
+             */
+            static void
+            setLevels(const std::string& config);
+
+            /// write out every queued message
+            static void
+            flush();
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#define DSU_LOG_INIT(name) \
+    static ::ndn::dsu::LogModule g_logModule(#name)
+
+#define DSU_LOG_TO(module, level, expression) \
+    do { \
+        if ((module).isEnabled(level)) { \
+            std::ostringstream dsuLogStream; \
+            dsuLogStream << expression; \
+            ::ndn::dsu::Logging::log(module, level, dsuLogStream.str()); \
+        } \
+    } while (false)
+
+#define DSU_LOG_TRACE(expression) DSU_LOG_TO(g_logModule, ::ndn::dsu::LOG_TRACE, expression)
+#define DSU_LOG_DEBUG(expression) DSU_LOG_TO(g_logModule, ::ndn::dsu::LOG_DEBUG, expression)
+#define DSU_LOG_INFO(expression) DSU_LOG_TO(g_logModule, ::ndn::dsu::LOG_INFO, expression)
+#define DSU_LOG_WARN(expression) DSU_LOG_TO(g_logModule, ::ndn::dsu::LOG_WARN, expression)
+#define DSU_LOG_ERROR(expression) DSU_LOG_TO(g_logModule, ::ndn::dsu::LOG_ERROR, expression)
+
+#endif // NDNFIT_DSU_LOGGER_HPP
@@ -0,0 +1,42 @@
+#include "mailbox.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+    namespace dsu {
+
+        Mailbox::Mailbox(boost::asio::io_service& receiver, size_t maxBatch)
+        : m_receiver(receiver)
+        , m_maxBatch(std::max<size_t>(1, maxBatch))
+        , m_isWakeupPending(false)
+        {
+        }
+
+        void
+        Mailbox::post(const Function& function)
+        {
+            m_queue.push(function);
+            if (!m_isWakeupPending.exchange(true, std::memory_order_acq_rel)) {
+                m_receiver.post(bind(&Mailbox::drain, this));
+            }
+        }
+
+        void
+        Mailbox::drain()
+        {
+            // an exchange, not a store: it reads the flag set by the last post() and so sees its push
+            m_isWakeupPending.exchange(false, std::memory_order_acq_rel);
+            Function function;
+            size_t nRun = 0;
+            while (nRun < m_maxBatch && m_queue.pop(function)) {
+                function();
+                nRun++;
+            }
+            if (nRun == m_maxBatch && !m_isWakeupPending.exchange(true, std::memory_order_acq_rel)) {
+                // more may be waiting, come back after the other handlers had their turn
+                m_receiver.post(bind(&Mailbox::drain, this));
+            }
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,46 @@
+#ifndef NDNFIT_DSU_MAILBOX_HPP
+#define NDNFIT_DSU_MAILBOX_HPP
+
+#include "spsc-queue.hpp"
+
+#include <boost/asio/io_service.hpp>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Runs functions posted by one thread on the io_service of another
+         *
+         * Functions go through a SpscQueue. The io_service is only woken up when the queue
+         * goes from drained to non-empty, so a burst of posts costs one io_service::post, and
+         * the receiving thread runs up to @p maxBatch functions per wakeup before letting the
+         * rest of its io_service run.
+         */
+        class Mailbox : noncopyable
+        {
+        public:
+            typedef function<void()> Function;
+
+            explicit
+            Mailbox(boost::asio::io_service& receiver, size_t maxBatch = 256);
+
+            /// from the sending thread only
+            void
+            post(const Function& function);
+
+        private:
+            void
+            drain();
+
+        private:
+            boost::asio::io_service& m_receiver;
+            size_t m_maxBatch;
+            SpscQueue<Function> m_queue;
+            // a drain() is posted and has not started yet
+            std::atomic<bool> m_isWakeupPending;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_MAILBOX_HPP
@@ -0,0 +1,200 @@
+#include "metrics.hpp"
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <algorithm>
+
+namespace ndn {
+    namespace dsu {
+
+        static const char* const FETCH_KIND_NAMES[] = {"update_info", "catalog", "datapoint"};
+
+        Histogram::Histogram()
+        : m_count(0)
+        , m_sum(0)
+        , m_max(0)
+        {
+            for (size_t i = 0; i < N_BUCKETS; i++) {
+                m_buckets[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void
+        Histogram::record(const time::nanoseconds& duration)
+        {
+            uint64_t us = duration.count() > 0 ? duration.count() / 1000 : 0;
+            size_t bucket = 0;
+            while (bucket + 1 < N_BUCKETS && (uint64_t(1) << bucket) <= us) {
+                bucket++;
+            }
+            m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            m_sum.fetch_add(us, std::memory_order_relaxed);
+
+            uint64_t max = m_max.load(std::memory_order_relaxed);
+            while (us > max && !m_max.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+            }
+        }
+
+        uint64_t
+        Histogram::getPercentile(double quantile) const
+        {
+            uint64_t count = getCount();
+            if (count == 0) {
+                return 0;
+            }
+            uint64_t rank = static_cast<uint64_t>(quantile * count);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < N_BUCKETS; i++) {
+                seen += m_buckets[i].load(std::memory_order_relaxed);
+                if (seen > rank) {
+                    return uint64_t(1) << i;
+                }
+            }
+            return uint64_t(1) << (N_BUCKETS - 1);
+        }
+
+        double
+        Histogram::getMeanMicroseconds() const
+        {
+            uint64_t count = getCount();
+            return count != 0 ? static_cast<double>(m_sum.load(std::memory_order_relaxed)) / count : 0;
+        }
+
+        Metrics::Metrics()
+        : m_startTime(time::steady_clock::now())
+        {
+        }
+
+        template<typename Writer>
+        static void
+        writeHistogram(Writer& writer, const char* name, const Histogram& histogram)
+        {
+            writer.String(name);
+            writer.StartObject();
+            writer.String("count");
+            writer.Uint64(histogram.getCount());
+            writer.String("mean_us");
+            writer.Double(histogram.getMeanMicroseconds());
+            writer.String("p50_us");
+            writer.Uint64(histogram.getPercentile(0.5));
+            writer.String("p90_us");
+            writer.Uint64(histogram.getPercentile(0.9));
+            writer.String("p99_us");
+            writer.Uint64(histogram.getPercentile(0.99));
+            writer.String("max_us");
+            writer.Uint64(histogram.getMaxMicroseconds());
+            writer.EndObject();
+        }
+
+        static bool
+        isBusier(const Metrics::UserStats& a, const Metrics::UserStats& b)
+        {
+            return a.nPending + a.nQueued > b.nPending + b.nQueued;
+        }
+
+        std::string
+        Metrics::toJson(const Gauges& gauges, std::vector<UserStats> users, size_t maxUsers) const
+        {
+            rapidjson::StringBuffer buffer;
+            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+            writer.StartObject();
+
+            writer.String("uptime_ms");
+            writer.Uint64(time::duration_cast<time::milliseconds>(time::steady_clock::now() - m_startTime).count());
+
+            writer.String("fetches");
+            writer.StartObject();
+            for (size_t i = 0; i < 3; i++) {
+                const FetchMetrics& fetch = m_fetches[i];
+                writer.String(FETCH_KIND_NAMES[i]);
+                writer.StartObject();
+                writer.String("interests_sent");
+                writer.Uint64(fetch.interestsSent.get());
+                writer.String("data_received");
+                writer.Uint64(fetch.dataReceived.get());
+                writer.String("timeouts");
+                writer.Uint64(fetch.timeouts.get());
+                writer.String("retries");
+                writer.Uint64(fetch.retries.get());
+                writeHistogram(writer, "latency", fetch.latency);
+                writer.EndObject();
+            }
+            writer.EndObject();
+            writer.String("interests_merged");
+            writer.Uint64(interestsMerged.get());
+
+            writer.String("repo");
+            writer.StartObject();
+            writer.String("inserts");
+            writer.Uint64(repoInserts.get());
+            writer.String("refused");
+            writer.Uint64(repoRefused.get());
+            writer.String("queries");
+            writer.Uint64(repoQueries.get());
+            writeHistogram(writer, "query_rtt", repoQueryRtt);
+            writer.EndObject();
+
+            writer.String("confirmations_served");
+            writer.Uint64(confirmationsServed.get());
+
+            writer.String("memory");
+            writer.StartObject();
+            writer.String("users_evicted");
+            writer.Uint64(usersEvicted.get());
+            writer.String("users_spilled");
+            writer.Uint64(usersSpilled.get());
+            writer.String("users_reloaded");
+            writer.Uint64(usersReloaded.get());
+            writer.String("pending_expired");
+            writer.Uint64(pendingExpired.get());
+            writer.EndObject();
+
+            writer.String("verification");
+            writer.StartObject();
+            writer.String("verified");
+            writer.Uint64(packetsVerified.get());
+            writer.String("rejected");
+            writer.Uint64(packetsRejected.get());
+            writer.EndObject();
+
+            writer.String("gauges");
+            writer.StartObject();
+            for (size_t i = 0; i < gauges.size(); i++) {
+                writer.String(gauges[i].first.c_str());
+                writer.Uint64(gauges[i].second);
+            }
+            writer.EndObject();
+
+            size_t nUsers = std::min(maxUsers, users.size());
+            std::partial_sort(users.begin(), users.begin() + nUsers, users.end(), &isBusier);
+            writer.String("user_count");
+            writer.Uint64(users.size());
+            writer.String("users");
+            writer.StartObject();
+            for (size_t i = 0; i < nUsers; i++) {
+                writer.String(users[i].user.c_str());
+                writer.StartObject();
+                writer.String("pending");
+                writer.Uint64(users[i].nPending);
+                writer.String("queued");
+                writer.Uint64(users[i].nQueued);
+                writer.String("in_flight");
+                writer.Uint64(users[i].nInFlight);
+                writer.String("window");
+                writer.Double(users[i].window);
+                writer.String("rto_ms");
+                writer.Uint64(users[i].rtoMs);
+                writer.String("memory_bytes");
+                writer.Uint64(users[i].memoryBytes);
+                writer.EndObject();
+            }
+            writer.EndObject();
+
+            writer.EndObject();
+            // the writer escapes NUL, the buffer holds a C string
+            return std::string(buffer.GetString());
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,159 @@
+#ifndef NDNFIT_DSU_METRICS_HPP
+#define NDNFIT_DSU_METRICS_HPP
+
+#include "pending-fetch-table.hpp"
+
+#include <ndn-cxx/util/time.hpp>
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        /// monotonic counter, safe to bump from any thread
+        class Counter
+        {
+        public:
+            Counter()
+            : m_value(0)
+            {
+            }
+
+            void
+            increment(uint64_t n = 1)
+            {
+                m_value.fetch_add(n, std::memory_order_relaxed);
+            }
+
+            uint64_t
+            get() const
+            {
+                return m_value.load(std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<uint64_t> m_value;
+        };
+
+        /**
+         * @brief Latency histogram with power-of-two microsecond buckets
+         *
+         * Bucket i counts samples in [2^(i-1), 2^i) microseconds. Percentiles are reported as
+         * the upper bound of the bucket they fall in, so they are accurate to a factor of two.
+         */
+        class Histogram
+        {
+        public:
+            static const size_t N_BUCKETS = 40;
+
+            Histogram();
+
+            void
+            record(const time::nanoseconds& duration);
+
+            uint64_t
+            getCount() const
+            {
+                return m_count.load(std::memory_order_relaxed);
+            }
+
+            /// @return upper bound in microseconds of the bucket holding the @p quantile sample
+            uint64_t
+            getPercentile(double quantile) const;
+
+            double
+            getMeanMicroseconds() const;
+
+            uint64_t
+            getMaxMicroseconds() const
+            {
+                return m_max.load(std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<uint64_t> m_buckets[N_BUCKETS];
+            std::atomic<uint64_t> m_count;
+            std::atomic<uint64_t> m_sum;
+            std::atomic<uint64_t> m_max;
+        };
+
+        /**
+         * @brief Instrumentation of the DSU, rendered as JSON for the status prefix and the metrics file
+         *
+         * Counters and histograms are plain relaxed atomics, cheap enough to be always on.
+         * Values that already live elsewhere (queue lengths, per-user state) are sampled by the
+         * caller when a report is made and passed to toJson().
+         */
+        class Metrics : noncopyable
+        {
+        public:
+            struct FetchMetrics
+            {
+                Counter interestsSent;
+                Counter dataReceived;
+                Counter timeouts;
+                Counter retries;
+                // from expressing the Interest to receiving the Data
+                Histogram latency;
+            };
+
+            struct UserStats
+            {
+                std::string user;
+                size_t nPending;
+                size_t nQueued;
+                size_t nInFlight;
+                double window;
+                uint64_t rtoMs;
+                // estimated bytes of sync state held for the user
+                size_t memoryBytes;
+            };
+
+            typedef std::vector<std::pair<std::string, uint64_t>> Gauges;
+
+            Metrics();
+
+            FetchMetrics&
+            getFetch(FetchKind kind)
+            {
+                return m_fetches[kind - FETCH_UPDATE_INFO];
+            }
+
+            /**
+             * @param gauges point-in-time values, e.g. queue lengths
+             * @param users per-user state; at most @p maxUsers of them are listed, busiest first
+             */
+            std::string
+            toJson(const Gauges& gauges, std::vector<UserStats> users, size_t maxUsers = SIZE_MAX) const;
+
+        public:
+            // requests for a name that was already being fetched
+            Counter interestsMerged;
+            Counter repoInserts;
+            // packets dropped because every repo connection was full, their objects are fetched again
+            Counter repoRefused;
+            Counter repoQueries;
+            Counter confirmationsServed;
+            Histogram repoQueryRtt;
+            // users dropped from memory, whether or not their state was spilled to disk
+            Counter usersEvicted;
+            Counter usersSpilled;
+            // spilled users brought back by a register Interest
+            Counter usersReloaded;
+            // pending fetches dropped after staying inactive for the TTL
+            Counter pendingExpired;
+            // fetched packets whose signature checked out, and those that were not stored for it
+            Counter packetsVerified;
+            Counter packetsRejected;
+
+        private:
+            FetchMetrics m_fetches[3];
+            time::steady_clock::TimePoint m_startTime;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_METRICS_HPP
@@ -0,0 +1,67 @@
+#include "outstanding-interest-table.hpp"
+
+namespace ndn {
+    namespace dsu {
+
+        OutstandingInterestTable::OutstandingInterestTable(InterestScheduler& scheduler)
+        : m_scheduler(scheduler)
+        {
+        }
+
+        bool
+        OutstandingInterestTable::express(const name::Component& user, const Interest& interest,
+                                          const DataCallback& onData, const TimeoutCallback& onTimeout)
+        {
+            Waiter waiter = {onData, onTimeout};
+            std::map<Name, Entry>::iterator it = m_entries.find(interest.getName());
+            if (it != m_entries.end()) {
+                it->second.push_back(waiter);
+                return false;
+            }
+            m_entries[interest.getName()].push_back(waiter);
+            m_scheduler.express(user, interest,
+                                bind(&OutstandingInterestTable::onData, this, _1, _2, _3),
+                                bind(&OutstandingInterestTable::onTimeout, this, _1, _2));
+            return true;
+        }
+
+        size_t
+        OutstandingInterestTable::getWaiterCount(const Name& name) const
+        {
+            std::map<Name, Entry>::const_iterator it = m_entries.find(name);
+            return it != m_entries.end() ? it->second.size() : 0;
+        }
+
+        void
+        OutstandingInterestTable::onData(const Interest& interest, const Data& data,
+                                         const time::steady_clock::TimePoint& sentAt)
+        {
+            std::map<Name, Entry>::iterator it = m_entries.find(interest.getName());
+            if (it == m_entries.end()) {
+                return;
+            }
+            Entry waiters;
+            waiters.swap(it->second);
+            m_entries.erase(it);
+            for (size_t i = 0; i < waiters.size(); i++) {
+                waiters[i].onData(interest, data, sentAt);
+            }
+        }
+
+        void
+        OutstandingInterestTable::onTimeout(const Interest& interest, const time::steady_clock::TimePoint& sentAt)
+        {
+            std::map<Name, Entry>::iterator it = m_entries.find(interest.getName());
+            if (it == m_entries.end()) {
+                return;
+            }
+            Entry waiters;
+            waiters.swap(it->second);
+            m_entries.erase(it);
+            for (size_t i = 0; i < waiters.size(); i++) {
+                waiters[i].onTimeout(interest, sentAt);
+            }
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,79 @@
+#ifndef NDNFIT_DSU_OUTSTANDING_INTEREST_TABLE_HPP
+#define NDNFIT_DSU_OUTSTANDING_INTEREST_TABLE_HPP
+
+#include "interest-scheduler.hpp"
+
+#include <map>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief The fetches that are queued in the InterestScheduler or in flight, by name
+         *
+         * A request for a name that is already outstanding does not express a second Interest:
+         * it is merged into the outstanding one and waits for the same outcome. The Data or the
+         * timeout is delivered to the callbacks of every request, in the order they came in.
+         *
+         * An entry is removed before its callbacks run, so they can express the name again; the
+         * requests made from the other callbacks are then merged into that new Interest.
+         */
+        class OutstandingInterestTable : noncopyable
+        {
+        public:
+            typedef InterestScheduler::DataCallback DataCallback;
+            typedef InterestScheduler::TimeoutCallback TimeoutCallback;
+
+            explicit
+            OutstandingInterestTable(InterestScheduler& scheduler);
+
+            /**
+             * @brief Queue @p interest in the scheduler, unless one with the same name is outstanding
+             * @return false if the request was merged into an outstanding Interest
+             */
+            bool
+            express(const name::Component& user, const Interest& interest,
+                    const DataCallback& onData, const TimeoutCallback& onTimeout);
+
+            bool
+            contains(const Name& name) const
+            {
+                return m_entries.count(name) > 0;
+            }
+
+            /// requests waiting for @p name, 0 if it is not outstanding
+            size_t
+            getWaiterCount(const Name& name) const;
+
+            size_t
+            size() const
+            {
+                return m_entries.size();
+            }
+
+        private:
+            struct Waiter
+            {
+                DataCallback onData;
+                TimeoutCallback onTimeout;
+            };
+
+            // the request that expressed the Interest first, then those merged into it
+            typedef std::vector<Waiter> Entry;
+
+            void
+            onData(const Interest& interest, const Data& data, const time::steady_clock::TimePoint& sentAt);
+
+            void
+            onTimeout(const Interest& interest, const time::steady_clock::TimePoint& sentAt);
+
+        private:
+            InterestScheduler& m_scheduler;
+            std::map<Name, Entry> m_entries;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_OUTSTANDING_INTEREST_TABLE_HPP
@@ -0,0 +1,273 @@
+#include "pending-fetch-table.hpp"
+
+namespace ndn {
+    namespace dsu {
+
+        static const size_t INITIAL_CAPACITY = 8;
+
+        // finalizer of splitmix64, spreads sequential ids and timestamps over the table
+        static inline uint64_t
+        mix(uint64_t x)
+        {
+            x ^= x >> 30;
+            x *= 0xbf58476d1ce4e5b9ULL;
+            x ^= x >> 27;
+            x *= 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+            return x;
+        }
+
+        static inline size_t
+        hashKey(const FetchKey& key)
+        {
+            return static_cast<size_t>(mix(key.id ^ mix(key.version + (static_cast<uint64_t>(key.kind) << 56))));
+        }
+
+        PendingFetchSet::PendingFetchSet()
+        : m_size(0)
+        {
+        }
+
+        size_t
+        PendingFetchSet::probe(const FetchKey& key) const
+        {
+            size_t mask = m_slots.size() - 1;
+            size_t i = hashKey(key) & mask;
+            while (m_slots[i].kind != EMPTY &&
+                   !(m_slots[i].kind == key.kind && m_slots[i].id == key.id && m_slots[i].version == key.version)) {
+                i = (i + 1) & mask;
+            }
+            return i;
+        }
+
+        int*
+        PendingFetchSet::find(const FetchKey& key)
+        {
+            if (m_size == 0) {
+                return 0;
+            }
+            size_t i = probe(key);
+            return m_slots[i].kind == EMPTY ? 0 : &m_slots[i].retries;
+        }
+
+        int&
+        PendingFetchSet::insert(const FetchKey& key, uint32_t now)
+        {
+            // keep the load factor at or below 3/4
+            if ((m_size + 1) * 4 > m_slots.size() * 3) {
+                grow();
+            }
+            size_t i = probe(key);
+            if (m_slots[i].kind == EMPTY) {
+                m_slots[i].id = key.id;
+                m_slots[i].version = key.version;
+                m_slots[i].retries = 0;
+                m_slots[i].kind = static_cast<uint8_t>(key.kind);
+                m_size++;
+            }
+            m_slots[i].insertedAt = now;
+            return m_slots[i].retries;
+        }
+
+        void
+        PendingFetchSet::collectExpired(uint32_t cutoff, std::vector<FetchKey>& keys) const
+        {
+            for (size_t i = 0; i < m_slots.size(); i++) {
+                if (m_slots[i].kind != EMPTY && m_slots[i].insertedAt < cutoff) {
+                    keys.push_back(FetchKey(static_cast<FetchKind>(m_slots[i].kind), m_slots[i].id,
+                                            m_slots[i].version));
+                }
+            }
+        }
+
+        bool
+        PendingFetchSet::erase(const FetchKey& key)
+        {
+            if (m_size == 0) {
+                return false;
+            }
+            size_t mask = m_slots.size() - 1;
+            size_t hole = probe(key);
+            if (m_slots[hole].kind == EMPTY) {
+                return false;
+            }
+
+            // backward-shift the following entries so that no tombstone is needed
+            for (size_t i = (hole + 1) & mask; m_slots[i].kind != EMPTY; i = (i + 1) & mask) {
+                FetchKey moved(static_cast<FetchKind>(m_slots[i].kind), m_slots[i].id, m_slots[i].version);
+                size_t home = hashKey(moved) & mask;
+                // move the entry unless its home lies cyclically in (hole, i]
+                bool isInRange = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+                if (!isInRange) {
+                    m_slots[hole] = m_slots[i];
+                    hole = i;
+                }
+            }
+            m_slots[hole].kind = EMPTY;
+            m_size--;
+
+            if (m_size == 0) {
+                std::vector<Slot>().swap(m_slots);
+            }
+            return true;
+        }
+
+        void
+        PendingFetchSet::grow()
+        {
+            std::vector<Slot> old;
+            old.swap(m_slots);
+            Slot empty = Slot();
+            m_slots.assign(old.empty() ? INITIAL_CAPACITY : old.size() * 2, empty);
+
+            for (size_t i = 0; i < old.size(); i++) {
+                if (old[i].kind != EMPTY) {
+                    FetchKey key(static_cast<FetchKind>(old[i].kind), old[i].id, old[i].version);
+                    m_slots[probe(key)] = old[i];
+                }
+            }
+        }
+
+        PendingFetchTable::PendingFetchTable()
+        : m_nUsers(0)
+        {
+        }
+
+        size_t
+        PendingFetchTable::hashUser(const name::Component& user)
+        {
+            // FNV-1a over the user_id bytes
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            for (size_t i = 0; i < user.value_size(); i++) {
+                hash = (hash ^ user.value()[i]) * 0x100000001b3ULL;
+            }
+            return static_cast<size_t>(mix(hash));
+        }
+
+        size_t
+        PendingFetchTable::probe(const name::Component& user, size_t hash) const
+        {
+            size_t mask = m_index.size() - 1;
+            size_t i = hash & mask;
+            while (m_index[i] != 0) {
+                const User& entry = m_users[m_index[i] - 1];
+                if (entry.hash == hash && entry.id == user) {
+                    break;
+                }
+                i = (i + 1) & mask;
+            }
+            return i;
+        }
+
+        const PendingFetchSet*
+        PendingFetchTable::findUser(const name::Component& user) const
+        {
+            if (m_nUsers == 0) {
+                return 0;
+            }
+            size_t i = probe(user, hashUser(user));
+            return m_index[i] == 0 ? 0 : &m_users[m_index[i] - 1].pending;
+        }
+
+        PendingFetchSet&
+        PendingFetchTable::addUser(const name::Component& user)
+        {
+            if ((m_nUsers + 1) * 4 > m_index.size() * 3) {
+                growIndex();
+            }
+
+            size_t hash = hashUser(user);
+            size_t i = probe(user, hash);
+            if (m_index[i] != 0) {
+                return m_users[m_index[i] - 1].pending;
+            }
+
+            uint32_t position;
+            if (!m_freeUsers.empty()) {
+                position = m_freeUsers.back();
+                m_freeUsers.pop_back();
+            } else {
+                position = static_cast<uint32_t>(m_users.size());
+                m_users.push_back(User());
+            }
+            User& entry = m_users[position];
+            entry.id = user;
+            entry.hash = hash;
+            entry.isUsed = true;
+            m_index[i] = position + 1;
+            m_nUsers++;
+            return entry.pending;
+        }
+
+        void
+        PendingFetchTable::removeUser(const name::Component& user)
+        {
+            if (m_nUsers == 0) {
+                return;
+            }
+            size_t mask = m_index.size() - 1;
+            size_t hole = probe(user, hashUser(user));
+            if (m_index[hole] == 0) {
+                return;
+            }
+
+            uint32_t position = m_index[hole] - 1;
+            m_users[position] = User();
+            m_freeUsers.push_back(position);
+            m_nUsers--;
+
+            for (size_t i = (hole + 1) & mask; m_index[i] != 0; i = (i + 1) & mask) {
+                size_t home = m_users[m_index[i] - 1].hash & mask;
+                bool isInRange = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+                if (!isInRange) {
+                    m_index[hole] = m_index[i];
+                    hole = i;
+                }
+            }
+            m_index[hole] = 0;
+        }
+
+        void
+        PendingFetchTable::growIndex()
+        {
+            m_index.assign(m_index.empty() ? INITIAL_CAPACITY : m_index.size() * 2, 0);
+            size_t mask = m_index.size() - 1;
+            for (size_t position = 0; position < m_users.size(); position++) {
+                if (!m_users[position].isUsed) {
+                    continue;
+                }
+                size_t i = m_users[position].hash & mask;
+                while (m_index[i] != 0) {
+                    i = (i + 1) & mask;
+                }
+                m_index[i] = static_cast<uint32_t>(position + 1);
+            }
+        }
+
+        size_t
+        PendingFetchTable::size() const
+        {
+            size_t total = 0;
+            for (size_t i = 0; i < m_users.size(); i++) {
+                total += m_users[i].pending.size();
+            }
+            return total;
+        }
+
+        size_t
+        PendingFetchTable::getMemoryUsage() const
+        {
+            size_t total = m_users.capacity() * sizeof(User) +
+                           m_freeUsers.capacity() * sizeof(uint32_t) +
+                           m_index.capacity() * sizeof(uint32_t);
+            for (size_t i = 0; i < m_users.size(); i++) {
+                total += m_users[i].pending.getMemoryUsage();
+                if (m_users[i].isUsed) {
+                    total += m_users[i].id.size();
+                }
+            }
+            return total;
+        }
+
+    } // namespace dsu
+} // namespace ndn
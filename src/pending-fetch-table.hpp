@@ -0,0 +1,246 @@
+#ifndef NDNFIT_DSU_PENDING_FETCH_TABLE_HPP
+#define NDNFIT_DSU_PENDING_FETCH_TABLE_HPP
+
+#include <ndn-cxx/name.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace ndn {
+    namespace dsu {
+
+        enum FetchKind {
+            FETCH_UPDATE_INFO = 1,
+            FETCH_CATALOG = 2,
+            FETCH_DATAPOINT = 3
+        };
+
+        /**
+         * @brief What is being fetched for a user, without the name prefix all of them share
+         *
+         * update_info: id is the sequence number; catalog: id is the timestamp in milliseconds
+         * and version its version; datapoint: id is the timestamp in milliseconds.
+         */
+        struct FetchKey
+        {
+            FetchKey()
+            : kind(FETCH_DATAPOINT)
+            , id(0)
+            , version(0)
+            {
+            }
+
+            FetchKey(FetchKind kind, uint64_t id, uint64_t version = 0)
+            : kind(kind)
+            , id(id)
+            , version(version)
+            {
+            }
+
+            bool
+            operator==(const FetchKey& other) const
+            {
+                return kind == other.kind && id == other.id && version == other.version;
+            }
+
+            FetchKind kind;
+            uint64_t id;
+            uint64_t version;
+        };
+
+        /**
+         * @brief Open-addressing set of one user's pending fetches with a retry counter each
+         *
+         * Slots are stored inline in a single array (linear probing, backward-shift deletion),
+         * so an entry costs 32 bytes and no per-entry allocation. Every entry also records when
+         * it was inserted, in seconds of a clock chosen by the caller, so that fetches that never
+         * complete can be expired.
+         */
+        class PendingFetchSet
+        {
+        public:
+            PendingFetchSet();
+
+            /// @return the retry counter of @p key, or 0 if it is not pending;
+            ///         the pointer is valid until the next insert
+            int*
+            find(const FetchKey& key);
+
+            /// insert @p key with a zero retry counter if absent; either way it counts as inserted at @p now
+            /// @return the retry counter of @p key
+            int&
+            insert(const FetchKey& key, uint32_t now = 0);
+
+            /// append to @p keys the entries inserted before @p cutoff
+            void
+            collectExpired(uint32_t cutoff, std::vector<FetchKey>& keys) const;
+
+            bool
+            erase(const FetchKey& key);
+
+            size_t
+            size() const
+            {
+                return m_size;
+            }
+
+            size_t
+            getMemoryUsage() const
+            {
+                return m_slots.capacity() * sizeof(Slot);
+            }
+
+            /// call @p f(const FetchKey&, int retries) on every entry; @p f must not modify the set
+            template<typename Function>
+            void
+            forEach(Function f) const
+            {
+                for (size_t i = 0; i < m_slots.size(); i++) {
+                    if (m_slots[i].kind != EMPTY) {
+                        f(FetchKey(static_cast<FetchKind>(m_slots[i].kind), m_slots[i].id, m_slots[i].version),
+                          m_slots[i].retries);
+                    }
+                }
+            }
+
+            /// call @p f(const FetchKey&, uint32_t insertedAt) on every entry; @p f must not modify the set
+            template<typename Function>
+            void
+            forEachInsertion(Function f) const
+            {
+                for (size_t i = 0; i < m_slots.size(); i++) {
+                    if (m_slots[i].kind != EMPTY) {
+                        f(FetchKey(static_cast<FetchKind>(m_slots[i].kind), m_slots[i].id, m_slots[i].version),
+                          m_slots[i].insertedAt);
+                    }
+                }
+            }
+
+        private:
+            struct Slot
+            {
+                uint64_t id;
+                uint64_t version;
+                int32_t retries;
+                uint32_t insertedAt;
+                uint8_t kind;
+            };
+
+            static const uint8_t EMPTY = 0;
+
+            size_t
+            probe(const FetchKey& key) const;
+
+            void
+            grow();
+
+        private:
+            std::vector<Slot> m_slots;
+            size_t m_size;
+        };
+
+        /**
+         * @brief Pending fetches of all users, replacing std::map<name::Component, std::map<Name, int>>
+         *
+         * Users are kept in a pool indexed by an open-addressing table over the user_id bytes;
+         * freed pool entries are reused by the next new user. References to a user's set are
+         * valid until the next addUser or removeUser.
+         */
+        class PendingFetchTable
+        {
+        public:
+            PendingFetchTable();
+
+            bool
+            hasUser(const name::Component& user) const
+            {
+                return findUser(user) != 0;
+            }
+
+            /// @return the pending set of @p user, creating an empty one if needed
+            PendingFetchSet&
+            addUser(const name::Component& user);
+
+            void
+            removeUser(const name::Component& user);
+
+            /// @return the pending set of @p user, or 0 if the user is unknown
+            PendingFetchSet*
+            getUser(const name::Component& user)
+            {
+                return const_cast<PendingFetchSet*>(findUser(user));
+            }
+
+            const PendingFetchSet*
+            getUser(const name::Component& user) const
+            {
+                return findUser(user);
+            }
+
+            size_t
+            getUserCount() const
+            {
+                return m_nUsers;
+            }
+
+            /// total number of pending fetches over all users
+            size_t
+            size() const;
+
+            /// approximate heap bytes held by the table
+            size_t
+            getMemoryUsage() const;
+
+            /// call @p f(const name::Component& user, const PendingFetchSet&) on every user
+            template<typename Function>
+            void
+            forEachUser(Function f) const
+            {
+                for (size_t i = 0; i < m_users.size(); i++) {
+                    if (m_users[i].isUsed) {
+                        f(m_users[i].id, m_users[i].pending);
+                    }
+                }
+            }
+
+        private:
+            struct User
+            {
+                User()
+                : hash(0)
+                , isUsed(false)
+                {
+                }
+
+                name::Component id;
+                size_t hash;
+                bool isUsed;
+                PendingFetchSet pending;
+            };
+
+            static size_t
+            hashUser(const name::Component& user);
+
+            const PendingFetchSet*
+            findUser(const name::Component& user) const;
+
+            /// @return the index slot of @p user, or of the empty slot where it would go
+            size_t
+            probe(const name::Component& user, size_t hash) const;
+
+            void
+            growIndex();
+
+        private:
+            std::vector<User> m_users;
+            std::vector<uint32_t> m_freeUsers;
+            // user pool index + 1, 0 marks an empty slot
+            std::vector<uint32_t> m_index;
+            size_t m_nUsers;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_PENDING_FETCH_TABLE_HPP
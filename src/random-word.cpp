@@ -0,0 +1,16 @@
+#include "random-word.hpp"
+
+#include <random>
+
+namespace ndn {
+    namespace dsu {
+
+        uint32_t
+        generateRandomWord()
+        {
+            static thread_local std::mt19937 generator(std::random_device{}());
+            return static_cast<uint32_t>(generator());
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,21 @@
+#ifndef NDNFIT_DSU_RANDOM_WORD_HPP
+#define NDNFIT_DSU_RANDOM_WORD_HPP
+
+#include <stdint.h>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Random number from a generator owned by the calling thread
+         *
+         * ndn::random::generateWord32() shares one generator without locking, so it is only
+         * safe on a single thread; engines running on shard threads use this instead.
+         */
+        uint32_t
+        generateRandomWord();
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_RANDOM_WORD_HPP
@@ -0,0 +1,370 @@
+#include "repo-client.hpp"
+#include "logger.hpp"
+
+#include <ndn-cxx/encoding/tlv.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/write.hpp>
+#include <algorithm>
+#include <tuple>
+
+namespace ndn {
+    namespace dsu {
+
+        DSU_LOG_INIT(RepoClient);
+
+        static const time::milliseconds INITIAL_BACKOFF(100);
+        static const time::milliseconds MAX_BACKOFF(30000);
+        // buffers in one gathered write, kept under the usual IOV_MAX
+        static const size_t MAX_BATCH_PACKETS = 1024;
+
+        RepoConnection::RepoConnection(boost::asio::io_service& ioService, Scheduler& scheduler,
+                                       const std::string& host, const std::string& port,
+                                       const ReceiveCallback& onReceive, const function<void()>& onWritable,
+                                       size_t queueLimit, size_t maxBatchBytes, const time::milliseconds& batchDelay)
+        : m_ioService(ioService)
+        , m_scheduler(scheduler)
+        , m_host(host)
+        , m_port(port)
+        , m_onReceive(onReceive)
+        , m_onWritable(onWritable)
+        , m_queueLimit(std::max<size_t>(1, queueLimit))
+        , m_maxBatchBytes(std::max<size_t>(1, maxBatchBytes))
+        , m_batchDelay(batchDelay)
+        , m_resolver(ioService)
+        , m_socket(ioService)
+        , m_state(DISCONNECTED)
+        , m_isWriting(false)
+        , m_wasSaturated(false)
+        , m_backoff(INITIAL_BACKOFF)
+        , m_isFlushScheduled(false)
+        , m_queuedBytes(0)
+        , m_nWrites(0)
+        , m_nWritten(0)
+        , m_inputBuffer(MAX_NDN_PACKET_SIZE)
+        , m_inputBufferSize(0)
+        {
+        }
+
+        RepoConnection::~RepoConnection()
+        {
+            m_scheduler.cancelEvent(m_reconnectEvent);
+            m_scheduler.cancelEvent(m_flushEvent);
+            boost::system::error_code error;
+            m_socket.close(error);
+        }
+
+        void
+        RepoConnection::connect()
+        {
+            if (m_state != DISCONNECTED) {
+                return;
+            }
+            m_state = RESOLVING;
+            boost::asio::ip::tcp::resolver::query query(m_host, m_port);
+            m_resolver.async_resolve(query, bind(&RepoConnection::onResolved, this, _1, _2));
+        }
+
+        void
+        RepoConnection::onResolved(const boost::system::error_code& error,
+                                   boost::asio::ip::tcp::resolver::iterator endpoint)
+        {
+            if (error) {
+                fail("cannot resolve: " + error.message());
+                return;
+            }
+            m_state = CONNECTING;
+            boost::asio::async_connect(m_socket, endpoint, bind(&RepoConnection::onConnected, this, _1));
+        }
+
+        void
+        RepoConnection::onConnected(const boost::system::error_code& error)
+        {
+            if (error) {
+                fail("cannot connect: " + error.message());
+                return;
+            }
+            DSU_LOG_INFO("Connected to repo " << getEndpoint());
+            m_state = CONNECTED;
+            m_backoff = INITIAL_BACKOFF;
+            m_inputBufferSize = 0;
+            receive();
+            write();
+            m_onWritable();
+        }
+
+        bool
+        RepoConnection::send(const Block& wire, const WrittenCallback& onWritten)
+        {
+            if (isFull()) {
+                return false;
+            }
+            Packet packet = {wire, onWritten};
+            m_queue.push_back(packet);
+            m_queuedBytes += wire.size();
+            if (isSaturated()) {
+                m_wasSaturated = true;
+            }
+            if (m_queuedBytes >= m_maxBatchBytes || m_batchDelay <= time::milliseconds::zero()) {
+                write();
+            } else if (!m_isFlushScheduled && !m_isWriting) {
+                // wait for the packets produced along with this one
+                m_isFlushScheduled = true;
+                m_flushEvent = m_scheduler.scheduleEvent(m_batchDelay, bind(&RepoConnection::onFlushTimer, this));
+            }
+            return true;
+        }
+
+        void
+        RepoConnection::onFlushTimer()
+        {
+            m_isFlushScheduled = false;
+            write();
+        }
+
+        void
+        RepoConnection::write()
+        {
+            if (m_state != CONNECTED || m_isWriting || m_queue.empty()) {
+                return;
+            }
+            if (m_isFlushScheduled) {
+                m_isFlushScheduled = false;
+                m_scheduler.cancelEvent(m_flushEvent);
+            }
+            m_isWriting = true;
+            // the packets keep their wire encoding, the batch only points into it
+            size_t nBytes = 0;
+            m_batch.clear();
+            for (std::deque<Packet>::const_iterator it = m_queue.begin();
+                 it != m_queue.end() && m_batch.size() < MAX_BATCH_PACKETS; ++it) {
+                if (!m_batch.empty() && nBytes + it->wire.size() > m_maxBatchBytes) {
+                    break;
+                }
+                m_batch.push_back(boost::asio::buffer(it->wire.wire(), it->wire.size()));
+                nBytes += it->wire.size();
+            }
+            boost::asio::async_write(m_socket, m_batch, bind(&RepoConnection::onWritten, this, _1, _2));
+        }
+
+        void
+        RepoConnection::onWritten(const boost::system::error_code& error, size_t nBytes)
+        {
+            m_isWriting = false;
+            if (error) {
+                // the batch stays at the head of the queue and is written again after reconnecting
+                fail("write error: " + error.message());
+                return;
+            }
+            m_nWrites++;
+            m_nWritten += m_batch.size();
+            std::vector<WrittenCallback> callbacks;
+            for (size_t i = 0; i < m_batch.size(); i++) {
+                if (m_queue.front().onWritten) {
+                    callbacks.push_back(m_queue.front().onWritten);
+                }
+                m_queuedBytes -= m_queue.front().wire.size();
+                m_queue.pop_front();
+            }
+            m_batch.clear();
+            // what was queued meanwhile has waited long enough
+            write();
+            for (size_t i = 0; i < callbacks.size(); i++) {
+                callbacks[i]();
+            }
+
+            if (m_wasSaturated && m_queue.size() <= m_queueLimit / 2) {
+                m_wasSaturated = false;
+                m_onWritable();
+            }
+        }
+
+        void
+        RepoConnection::receive()
+        {
+            m_socket.async_receive(boost::asio::buffer(&m_inputBuffer[m_inputBufferSize],
+                                                       m_inputBuffer.size() - m_inputBufferSize),
+                                   bind(&RepoConnection::onReceived, this, _1, _2));
+        }
+
+        void
+        RepoConnection::onReceived(const boost::system::error_code& error, size_t nBytes)
+        {
+            if (error) {
+                if (error != boost::asio::error::operation_aborted) {
+                    fail("read error: " + error.message());
+                }
+                return;
+            }
+            m_inputBufferSize += nBytes;
+
+            size_t offset = 0;
+            while (offset < m_inputBufferSize) {
+                bool isOk = false;
+                Block element;
+                std::tie(isOk, element) = Block::fromBuffer(&m_inputBuffer[offset], m_inputBufferSize - offset);
+                if (!isOk) {
+                    break;
+                }
+                offset += element.size();
+                m_onReceive(element);
+            }
+
+            if (offset == 0 && m_inputBufferSize == m_inputBuffer.size()) {
+                fail("received a packet larger than MAX_NDN_PACKET_SIZE");
+                return;
+            }
+            if (offset > 0) {
+                std::copy(m_inputBuffer.begin() + offset, m_inputBuffer.begin() + m_inputBufferSize,
+                          m_inputBuffer.begin());
+                m_inputBufferSize -= offset;
+            }
+            receive();
+        }
+
+        void
+        RepoConnection::fail(const std::string& reason)
+        {
+            if (m_state == DISCONNECTED) {
+                return;
+            }
+            DSU_LOG_ERROR("Repo " << getEndpoint() << " " << reason
+                          << ", reconnecting in " << m_backoff.count() << " ms");
+
+            boost::system::error_code error;
+            m_socket.close(error);
+            m_state = DISCONNECTED;
+            m_isWriting = false;
+
+            m_reconnectEvent = m_scheduler.scheduleEvent(m_backoff, bind(&RepoConnection::connect, this));
+            m_backoff = std::min(m_backoff * 2, MAX_BACKOFF);
+        }
+
+        RepoClient::RepoClient(boost::asio::io_service& ioService, Scheduler& scheduler,
+                               const std::vector<Endpoint>& endpoints, size_t connectionsPerEndpoint,
+                               DispatchPolicy policy, size_t queueLimit, const ReceiveCallback& onReceive,
+                               size_t maxBatchBytes, const time::milliseconds& batchDelay)
+        : m_policy(policy)
+        , m_next(0)
+        , m_wasSaturated(true)
+        {
+            for (size_t i = 0; i < endpoints.size(); i++) {
+                for (size_t j = 0; j < std::max<size_t>(1, connectionsPerEndpoint); j++) {
+                    m_connections.push_back(make_shared<RepoConnection>(ref(ioService), ref(scheduler),
+                                                                        endpoints[i].host, endpoints[i].port,
+                                                                        onReceive,
+                                                                        bind(&RepoClient::onConnectionWritable, this),
+                                                                        queueLimit, maxBatchBytes, batchDelay));
+                }
+            }
+            if (m_connections.empty()) {
+                throw std::invalid_argument("no repo endpoint");
+            }
+            for (size_t i = 0; i < m_connections.size(); i++) {
+                m_connections[i]->connect();
+            }
+        }
+
+        RepoClient::Endpoint
+        RepoClient::parseEndpoint(const std::string& endpoint)
+        {
+            Endpoint result;
+            size_t colon = endpoint.rfind(':');
+            if (colon == std::string::npos) {
+                result.host = endpoint;
+                result.port = "7376";
+            } else {
+                result.host = endpoint.substr(0, colon);
+                result.port = endpoint.substr(colon + 1);
+            }
+            return result;
+        }
+
+        RepoConnection&
+        RepoClient::pick()
+        {
+            size_t nConnections = m_connections.size();
+            RepoConnection* best = 0;
+            if (m_policy == ROUND_ROBIN) {
+                for (size_t i = 0; i < nConnections && best == 0; i++) {
+                    RepoConnection& connection = *m_connections[(m_next + i) % nConnections];
+                    if (connection.isConnected() && !connection.isSaturated()) {
+                        best = &connection;
+                        m_next = (m_next + i + 1) % nConnections;
+                    }
+                }
+            }
+            // least loaded among the connections that are up and not full, otherwise among all of them
+            for (int pass = 0; pass < 2 && best == 0; pass++) {
+                for (size_t i = 0; i < nConnections; i++) {
+                    RepoConnection& connection = *m_connections[i];
+                    if ((pass == 1 || (connection.isConnected() && !connection.isFull())) &&
+                        (best == 0 || connection.getQueueSize() < best->getQueueSize())) {
+                        best = &connection;
+                    }
+                }
+            }
+            return *best;
+        }
+
+        bool
+        RepoClient::send(const Block& wire, const WrittenCallback& onWritten)
+        {
+            bool isQueued = pick().send(wire, onWritten);
+            if (isSaturated()) {
+                m_wasSaturated = true;
+            }
+            return isQueued;
+        }
+
+        bool
+        RepoClient::isSaturated() const
+        {
+            for (size_t i = 0; i < m_connections.size(); i++) {
+                if (m_connections[i]->isConnected() && !m_connections[i]->isSaturated()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        size_t
+        RepoClient::getQueueSize() const
+        {
+            size_t total = 0;
+            for (size_t i = 0; i < m_connections.size(); i++) {
+                total += m_connections[i]->getQueueSize();
+            }
+            return total;
+        }
+
+        uint64_t
+        RepoClient::getWriteCount() const
+        {
+            uint64_t total = 0;
+            for (size_t i = 0; i < m_connections.size(); i++) {
+                total += m_connections[i]->getWriteCount();
+            }
+            return total;
+        }
+
+        uint64_t
+        RepoClient::getWrittenCount() const
+        {
+            uint64_t total = 0;
+            for (size_t i = 0; i < m_connections.size(); i++) {
+                total += m_connections[i]->getWrittenCount();
+            }
+            return total;
+        }
+
+        void
+        RepoClient::onConnectionWritable()
+        {
+            if (m_wasSaturated && !isSaturated()) {
+                m_wasSaturated = false;
+                this->onWritable();
+            }
+        }
+
+    } // namespace dsu
+} // namespace ndn
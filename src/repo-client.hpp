@@ -0,0 +1,243 @@
+#ifndef NDNFIT_DSU_REPO_CLIENT_HPP
+#define NDNFIT_DSU_REPO_CLIENT_HPP
+
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+#include <ndn-cxx/util/signal.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief One TCP connection to a repo, with a write-behind queue and automatic reconnect
+         *
+         * Packets handed to send() are queued as they are, without being encoded again, and
+         * written in order, many at a time: a single gathered write takes the queued packets
+         * up to @p maxBatchBytes. The queue is written as soon as it holds that much, when the
+         * previous write completes, or @p batchDelay after the first packet was queued, so that
+         * packets produced together share a write. The written callback of a packet is called
+         * once its whole batch has been written to the socket.
+         *
+         * If the connection fails, the socket is closed and a reconnect is attempted after an
+         * exponentially growing delay; packets still queued, including the batch being written,
+         * are sent once it is back.
+         *
+         * The connection is saturated once @p queueLimit packets are queued, which leaves room
+         * for the replies to Interests already in flight; at twice that, send() refuses packets.
+         */
+        class RepoConnection : noncopyable
+        {
+        public:
+            typedef function<void(const Block& wire)> ReceiveCallback;
+            /// the packet has been written to the socket
+            typedef function<void()> WrittenCallback;
+
+            RepoConnection(boost::asio::io_service& ioService, Scheduler& scheduler,
+                           const std::string& host, const std::string& port,
+                           const ReceiveCallback& onReceive, const function<void()>& onWritable,
+                           size_t queueLimit, size_t maxBatchBytes, const time::milliseconds& batchDelay);
+
+            ~RepoConnection();
+
+            void
+            connect();
+
+            /// @return false if the queue is full, the packet was not queued
+            bool
+            send(const Block& wire, const WrittenCallback& onWritten = WrittenCallback());
+
+            bool
+            isConnected() const
+            {
+                return m_state == CONNECTED;
+            }
+
+            /// the queue has reached its limit, the caller should stop producing packets
+            bool
+            isSaturated() const
+            {
+                return m_queue.size() >= m_queueLimit;
+            }
+
+            /// the queue takes no more packets
+            bool
+            isFull() const
+            {
+                return m_queue.size() >= 2 * m_queueLimit;
+            }
+
+            size_t
+            getQueueSize() const
+            {
+                return m_queue.size();
+            }
+
+            std::string
+            getEndpoint() const
+            {
+                return m_host + ":" + m_port;
+            }
+
+            /// socket writes completed so far
+            uint64_t
+            getWriteCount() const
+            {
+                return m_nWrites;
+            }
+
+            /// packets written so far
+            uint64_t
+            getWrittenCount() const
+            {
+                return m_nWritten;
+            }
+
+        private:
+            enum State {
+                DISCONNECTED,
+                RESOLVING,
+                CONNECTING,
+                CONNECTED
+            };
+
+            void
+            onResolved(const boost::system::error_code& error,
+                       boost::asio::ip::tcp::resolver::iterator endpoint);
+
+            void
+            onConnected(const boost::system::error_code& error);
+
+            void
+            onFlushTimer();
+
+            void
+            write();
+
+            void
+            onWritten(const boost::system::error_code& error, size_t nBytes);
+
+            void
+            receive();
+
+            void
+            onReceived(const boost::system::error_code& error, size_t nBytes);
+
+            void
+            fail(const std::string& reason);
+
+        private:
+            boost::asio::io_service& m_ioService;
+            Scheduler& m_scheduler;
+            std::string m_host;
+            std::string m_port;
+            ReceiveCallback m_onReceive;
+            // called when the connection comes up, and when a full queue has drained to half
+            function<void()> m_onWritable;
+            size_t m_queueLimit;
+            size_t m_maxBatchBytes;
+            time::milliseconds m_batchDelay;
+
+            boost::asio::ip::tcp::resolver m_resolver;
+            boost::asio::ip::tcp::socket m_socket;
+            State m_state;
+            bool m_isWriting;
+            bool m_wasSaturated;
+            time::milliseconds m_backoff;
+            scheduler::EventId m_reconnectEvent;
+            scheduler::EventId m_flushEvent;
+            bool m_isFlushScheduled;
+
+            struct Packet
+            {
+                Block wire;
+                WrittenCallback onWritten;
+            };
+
+            std::deque<Packet> m_queue;
+            // bytes of the packets in m_queue
+            size_t m_queuedBytes;
+            // the batch being written, from the head of m_queue
+            std::vector<boost::asio::const_buffer> m_batch;
+            uint64_t m_nWrites;
+            uint64_t m_nWritten;
+            std::vector<uint8_t> m_inputBuffer;
+            size_t m_inputBufferSize;
+        };
+
+        /**
+         * @brief Pool of repo connections, possibly to several repos
+         *
+         * Packets are spread over the connections that are up, either round-robin or to the
+         * one with the shortest queue. The pool reports saturation when no connection is up
+         * with room in its queue, and emits onWritable when that changes, so that the fetch
+         * logic can pause and resume. A send is refused only when every connection is full.
+         */
+        class RepoClient : noncopyable
+        {
+        public:
+            enum DispatchPolicy {
+                ROUND_ROBIN,
+                LEAST_LOADED
+            };
+
+            struct Endpoint
+            {
+                std::string host;
+                std::string port;
+            };
+
+            typedef RepoConnection::ReceiveCallback ReceiveCallback;
+            typedef RepoConnection::WrittenCallback WrittenCallback;
+
+            RepoClient(boost::asio::io_service& ioService, Scheduler& scheduler,
+                       const std::vector<Endpoint>& endpoints, size_t connectionsPerEndpoint,
+                       DispatchPolicy policy, size_t queueLimit, const ReceiveCallback& onReceive,
+                       size_t maxBatchBytes = 65536,
+                       const time::milliseconds& batchDelay = time::milliseconds(2));
+
+            /// parse "host:port"; the port defaults to 7376
+            static Endpoint
+            parseEndpoint(const std::string& endpoint);
+
+            /// @return false if every connection is full, the packet was not queued
+            bool
+            send(const Block& wire, const WrittenCallback& onWritten = WrittenCallback());
+
+            bool
+            isSaturated() const;
+
+            size_t
+            getQueueSize() const;
+
+            uint64_t
+            getWriteCount() const;
+
+            uint64_t
+            getWrittenCount() const;
+
+        public:
+            /// a saturated pool can take packets again
+            util::signal::Signal<RepoClient> onWritable;
+
+        private:
+            RepoConnection&
+            pick();
+
+            void
+            onConnectionWritable();
+
+        private:
+            std::vector<shared_ptr<RepoConnection>> m_connections;
+            DispatchPolicy m_policy;
+            size_t m_next;
+            bool m_wasSaturated;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_REPO_CLIENT_HPP
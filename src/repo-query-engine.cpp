@@ -0,0 +1,129 @@
+#include "repo-query-engine.hpp"
+#include "random-word.hpp"
+
+namespace ndn {
+    namespace dsu {
+
+        RepoQueryEngine::RepoQueryEngine(RepoClient& repo, Scheduler& scheduler,
+                                         size_t maxInFlight, const time::milliseconds& timeout,
+                                         int maxRetries)
+        : m_repo(repo)
+        , m_scheduler(scheduler)
+        , m_maxInFlight(maxInFlight)
+        , m_timeout(timeout)
+        , m_maxRetries(maxRetries)
+        , m_nInFlight(0)
+        {
+        }
+
+        RepoQueryEngine::~RepoQueryEngine()
+        {
+            for (QueryTable::iterator it = m_table.begin(); it != m_table.end(); ++it) {
+                if (it->second.isInFlight) {
+                    m_scheduler.cancelEvent(it->second.timeoutEvent);
+                }
+            }
+        }
+
+        void
+        RepoQueryEngine::query(const std::vector<Name>& names, const ResultCallback& callback, bool isUrgent)
+        {
+            for (size_t i = 0; i < names.size(); i++) {
+                std::pair<QueryTable::iterator, bool> result = m_table.insert(std::make_pair(names[i], Query()));
+                result.first->second.callbacks.push_back(callback);
+                if (isUrgent && !result.first->second.isInFlight) {
+                    // a stale copy left further back in the FIFO is skipped by dispatch()
+                    m_queue.push_front(names[i]);
+                } else if (result.second) {
+                    m_queue.push_back(names[i]);
+                }
+            }
+            dispatch();
+        }
+
+        bool
+        RepoQueryEngine::onData(const Data& data)
+        {
+            // the repo may answer with a longer name than the one asked for
+            const Name& name = data.getName();
+            QueryTable::iterator it = m_table.end();
+            for (size_t length = name.size(); length > 0 && it == m_table.end(); length--) {
+                it = m_table.find(name.getPrefix(length));
+            }
+            if (it == m_table.end() || !it->second.isInFlight) {
+                return false;
+            }
+
+            if (it->second.nRetries == 0) {
+                this->afterRttMeasurement(time::steady_clock::now() - it->second.sentAt);
+            }
+            finish(it, data.getContent().value_size() != 0 ? STORED : MISSING);
+            dispatch();
+            return true;
+        }
+
+        void
+        RepoQueryEngine::dispatch()
+        {
+            while (m_nInFlight < m_maxInFlight && !m_queue.empty() && !m_repo.isSaturated()) {
+                QueryTable::iterator it = m_table.find(m_queue.front());
+                m_queue.pop_front();
+                if (it == m_table.end() || it->second.isInFlight) {
+                    continue;
+                }
+                it->second.isInFlight = true;
+                m_nInFlight++;
+                send(it);
+            }
+        }
+
+        void
+        RepoQueryEngine::send(QueryTable::iterator it)
+        {
+            Interest interest(it->first);
+            interest.setInterestLifetime(m_timeout);
+            interest.setNonce(generateRandomWord());
+            // refused by full repo connections, it times out and is sent again
+            m_repo.send(interest.wireEncode());
+            it->second.sentAt = time::steady_clock::now();
+            it->second.timeoutEvent = m_scheduler.scheduleEvent(m_timeout,
+                                                                bind(&RepoQueryEngine::onTimeout, this, it->first));
+        }
+
+        void
+        RepoQueryEngine::onTimeout(const Name& name)
+        {
+            QueryTable::iterator it = m_table.find(name);
+            if (it == m_table.end() || !it->second.isInFlight) {
+                return;
+            }
+
+            if (it->second.nRetries < m_maxRetries) {
+                it->second.nRetries++;
+                send(it);
+                return;
+            }
+
+            finish(it, LOST);
+            dispatch();
+        }
+
+        void
+        RepoQueryEngine::finish(QueryTable::iterator it, Result result)
+        {
+            m_scheduler.cancelEvent(it->second.timeoutEvent);
+            m_nInFlight--;
+
+            // callbacks may issue new queries, so take the entry out of the table first
+            Name name = it->first;
+            std::vector<ResultCallback> callbacks;
+            callbacks.swap(it->second.callbacks);
+            m_table.erase(it);
+
+            for (size_t i = 0; i < callbacks.size(); i++) {
+                callbacks[i](name, result);
+            }
+        }
+
+    } // namespace dsu
+} // namespace ndn
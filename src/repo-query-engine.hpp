@@ -0,0 +1,127 @@
+#ifndef NDNFIT_DSU_REPO_QUERY_ENGINE_HPP
+#define NDNFIT_DSU_REPO_QUERY_ENGINE_HPP
+
+#include "repo-client.hpp"
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/interest.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+#include <ndn-cxx/util/signal.hpp>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Asks the repo whether datapoints are already stored
+         *
+         * Every query is an Interest sent over the repo connections. The repo answers with
+         * Data under the same name, with empty content if it does not have the packet. Queries
+         * are kept in a table keyed by name, so replies are matched to the query that asked
+         * for them. At most @p maxInFlight queries are outstanding; the rest wait in a FIFO,
+         * which is not drained while the repo connections are saturated.
+         * A query without a reply is sent again after a timeout. When its retries run out it
+         * is reported as LOST, so the caller can fetch the datapoint from the phone anyway.
+         */
+        class RepoQueryEngine : noncopyable
+        {
+        public:
+            enum Result {
+                STORED,
+                MISSING,
+                LOST
+            };
+
+            typedef function<void(const Name& name, Result result)> ResultCallback;
+
+            RepoQueryEngine(RepoClient& repo, Scheduler& scheduler,
+                            size_t maxInFlight = 64,
+                            const time::milliseconds& timeout = time::milliseconds(2000),
+                            int maxRetries = 2);
+
+            ~RepoQueryEngine();
+
+            /**
+             * @brief Queue existence checks for a batch of names, e.g. all datapoints of a catalog
+             *
+             * The batch is admitted in one go, up to the in-flight limit, without waiting for replies.
+             * A name that is already queued or outstanding is not sent twice; @p callback is added
+             * to its waiters instead.
+             *
+             * @param isUrgent put the names at the head of the FIFO, for queries a consumer is waiting on
+             */
+            void
+            query(const std::vector<Name>& names, const ResultCallback& callback, bool isUrgent = false);
+
+            /**
+             * @brief Match a Data packet received from the repo against outstanding queries
+             * @return false if no query was waiting for it
+             */
+            bool
+            onData(const Data& data);
+
+            /// send queued queries, e.g. after the repo connections have drained
+            void
+            dispatch();
+
+            size_t
+            getInFlight() const
+            {
+                return m_nInFlight;
+            }
+
+            size_t
+            getQueued() const
+            {
+                return m_queue.size();
+            }
+
+        public:
+            /// round-trip time of a query answered on its first transmission
+            util::signal::Signal<RepoQueryEngine, time::nanoseconds> afterRttMeasurement;
+
+        private:
+            struct Query
+            {
+                Query()
+                : nRetries(0)
+                , isInFlight(false)
+                {
+                }
+
+                std::vector<ResultCallback> callbacks;
+                int nRetries;
+                bool isInFlight;
+                time::steady_clock::TimePoint sentAt;
+                scheduler::EventId timeoutEvent;
+            };
+
+            typedef std::map<Name, Query> QueryTable;
+
+            void
+            send(QueryTable::iterator it);
+
+            void
+            onTimeout(const Name& name);
+
+            void
+            finish(QueryTable::iterator it, Result result);
+
+        private:
+            RepoClient& m_repo;
+            Scheduler& m_scheduler;
+            size_t m_maxInFlight;
+            time::milliseconds m_timeout;
+            int m_maxRetries;
+
+            QueryTable m_table;
+            std::deque<Name> m_queue;
+            size_t m_nInFlight;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_REPO_QUERY_ENGINE_HPP
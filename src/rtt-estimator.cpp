@@ -0,0 +1,72 @@
+#include "rtt-estimator.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+    namespace dsu {
+
+        // RFC 6298 section 2
+        static const double ALPHA = 1.0 / 8;
+        static const double BETA = 1.0 / 4;
+        static const int K = 4;
+        // clock granularity
+        static const time::milliseconds G(1);
+
+        RttEstimator::RttEstimator(const time::milliseconds& initialRto, const time::milliseconds& minRto,
+                                   const time::milliseconds& maxRto)
+        : m_initialRto(initialRto)
+        , m_minRto(minRto)
+        , m_maxRto(std::max(minRto, maxRto))
+        , m_hasSamples(false)
+        , m_srtt(0)
+        , m_rttVar(0)
+        , m_rto(initialRto)
+        , m_nBackoffs(0)
+        , m_lastBackoff(time::steady_clock::TimePoint::min())
+        {
+        }
+
+        void
+        RttEstimator::addMeasurement(const time::nanoseconds& rtt)
+        {
+            if (!m_hasSamples) {
+                m_srtt = rtt;
+                m_rttVar = rtt / 2;
+                m_hasSamples = true;
+            } else {
+                time::nanoseconds delta = m_srtt > rtt ? m_srtt - rtt : rtt - m_srtt;
+                m_rttVar = time::duration_cast<time::nanoseconds>((1 - BETA) * m_rttVar + BETA * delta);
+                m_srtt = time::duration_cast<time::nanoseconds>((1 - ALPHA) * m_srtt + ALPHA * rtt);
+            }
+            m_nBackoffs = 0;
+            m_rto = computeRto();
+        }
+
+        void
+        RttEstimator::onTimeout(const time::steady_clock::TimePoint& sentAt)
+        {
+            if (sentAt < m_lastBackoff) {
+                return;
+            }
+            m_rto = std::min(m_rto * 2, m_maxRto);
+            m_nBackoffs++;
+            m_lastBackoff = time::steady_clock::now();
+        }
+
+        void
+        RttEstimator::resetBackoff()
+        {
+            m_nBackoffs = 0;
+            m_rto = m_hasSamples ? computeRto() : m_initialRto;
+        }
+
+        time::milliseconds
+        RttEstimator::computeRto() const
+        {
+            time::nanoseconds rto = m_srtt + std::max<time::nanoseconds>(G, K * m_rttVar);
+            time::milliseconds rtoMs = time::duration_cast<time::milliseconds>(rto);
+            return std::min(std::max(rtoMs, m_minRto), m_maxRto);
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,84 @@
+#ifndef NDNFIT_DSU_RTT_ESTIMATOR_HPP
+#define NDNFIT_DSU_RTT_ESTIMATOR_HPP
+
+#include <ndn-cxx/util/time.hpp>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Round-trip time and retransmission timeout of one phone, after RFC 6298
+         *
+         * RTT samples are only taken from Interests that were not retransmitted (Karn's
+         * algorithm). Every timeout doubles the RTO, up to @p maxRto; timeouts of Interests
+         * sent before the last backoff belong to the same episode and do not double it again,
+         * so a whole window timing out at once counts once. The number of back-to-back
+         * backoffs tells how long the phone has been silent.
+         */
+        class RttEstimator
+        {
+        public:
+            explicit
+            RttEstimator(const time::milliseconds& initialRto = time::milliseconds(1000),
+                         const time::milliseconds& minRto = time::milliseconds(200),
+                         const time::milliseconds& maxRto = time::milliseconds(60000));
+
+            void
+            addMeasurement(const time::nanoseconds& rtt);
+
+            /// @param sentAt when the Interest that timed out was expressed
+            void
+            onTimeout(const time::steady_clock::TimePoint& sentAt);
+
+            /// forget the backoff, e.g. when the phone shows up again
+            void
+            resetBackoff();
+
+            /// Interest lifetime to use now
+            time::milliseconds
+            getRto() const
+            {
+                return m_rto;
+            }
+
+            bool
+            hasSamples() const
+            {
+                return m_hasSamples;
+            }
+
+            time::nanoseconds
+            getSmoothedRtt() const
+            {
+                return m_srtt;
+            }
+
+            /// backoffs since the last RTT sample
+            int
+            getBackoffCount() const
+            {
+                return m_nBackoffs;
+            }
+
+        private:
+            time::milliseconds
+            computeRto() const;
+
+        private:
+            time::milliseconds m_initialRto;
+            time::milliseconds m_minRto;
+            time::milliseconds m_maxRto;
+
+            bool m_hasSamples;
+            time::nanoseconds m_srtt;
+            time::nanoseconds m_rttVar;
+            time::milliseconds m_rto;
+
+            int m_nBackoffs;
+            time::steady_clock::TimePoint m_lastBackoff;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_RTT_ESTIMATOR_HPP
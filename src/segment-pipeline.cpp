@@ -0,0 +1,157 @@
+#include "segment-pipeline.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+    namespace dsu {
+
+        SegmentPipeline::SegmentPipeline(OutstandingInterestTable& interests, const name::Component& user,
+                                         size_t window, time::milliseconds lifetime, int maxRetries,
+                                         const SegmentCallback& onSegment, const CompleteCallback& onComplete,
+                                         const ErrorCallback& onError)
+        : m_interests(interests)
+        , m_user(user)
+        , m_window(std::max<size_t>(1, window))
+        , m_lifetime(lifetime)
+        , m_maxRetries(maxRetries)
+        , m_onSegment(onSegment)
+        , m_onComplete(onComplete)
+        , m_onError(onError)
+        , m_highestReceived(0)
+        , m_nextToExpress(0)
+        , m_nextToDeliver(0)
+        , m_lastSegment(0)
+        , m_hasLastSegment(false)
+        , m_nOutstanding(0)
+        , m_isFailed(false)
+        , m_isDone(false)
+        {
+        }
+
+        void
+        SegmentPipeline::start(const Data& segment)
+        {
+            // the owner may drop its reference from a callback
+            shared_ptr<SegmentPipeline> self = shared_from_this();
+            m_prefix = segment.getName().getPrefix(-1);
+            m_highestReceived = segment.getName().get(-1).toSegment();
+            m_received[m_highestReceived] = segment;
+            updateLastSegment(segment);
+            deliver();
+            fill();
+        }
+
+        void
+        SegmentPipeline::fill()
+        {
+            // nothing below the next segment to deliver is asked for, the segment start() was given included
+            m_nextToExpress = std::max(m_nextToExpress, m_nextToDeliver);
+            while (!m_isDone && !m_isFailed && m_nOutstanding < m_window && !isPastEnd(m_nextToExpress) &&
+                   m_nextToExpress < m_nextToDeliver + m_window) {
+                uint64_t segmentNo = m_nextToExpress++;
+                if (m_received.count(segmentNo) == 0) {
+                    express(segmentNo);
+                }
+            }
+        }
+
+        void
+        SegmentPipeline::express(uint64_t segmentNo)
+        {
+            Interest interest(Name(m_prefix).appendSegment(segmentNo));
+            interest.setInterestLifetime(m_lifetime);
+            interest.setMustBeFresh(true);
+            m_nOutstanding++;
+            // if another pipeline fetches the same object, this waits for its Interest's outcome
+            m_interests.express(m_user, interest,
+                                bind(&SegmentPipeline::onData, shared_from_this(), segmentNo, _2),
+                                bind(&SegmentPipeline::onTimeout, shared_from_this(), segmentNo));
+        }
+
+        void
+        SegmentPipeline::onData(uint64_t segmentNo, const Data& data)
+        {
+            m_nOutstanding--;
+            if (!m_isDone && !m_isFailed && segmentNo >= m_nextToDeliver && !isPastEnd(segmentNo)) {
+                m_highestReceived = std::max(m_highestReceived, segmentNo);
+                m_received[segmentNo] = data;
+                updateLastSegment(data);
+                deliver();
+            }
+            if (m_isFailed) {
+                fail();
+            } else {
+                fill();
+            }
+        }
+
+        void
+        SegmentPipeline::onTimeout(uint64_t segmentNo)
+        {
+            m_nOutstanding--;
+            // an Interest past the last segment, sent before the last segment was known, is not retried
+            if (!m_isDone && !m_isFailed && !isPastEnd(segmentNo)) {
+                if (++m_retries[segmentNo] <= m_maxRetries) {
+                    express(segmentNo);
+                } else if (!m_hasLastSegment && segmentNo > m_highestReceived) {
+                    // no such segment, the phone did not say where the object ends
+                    m_lastSegment = m_highestReceived;
+                    m_hasLastSegment = true;
+                    deliver();
+                } else {
+                    m_isFailed = true;
+                }
+            }
+            if (m_isFailed) {
+                fail();
+            } else {
+                fill();
+            }
+        }
+
+        void
+        SegmentPipeline::deliver()
+        {
+            shared_ptr<SegmentPipeline> self = shared_from_this();
+            while (!m_isDone) {
+                if (isPastEnd(m_nextToDeliver)) {
+                    m_isDone = true;
+                    m_received.clear();
+                    m_onComplete();
+                    return;
+                }
+                std::map<uint64_t, Data>::iterator it = m_received.find(m_nextToDeliver);
+                if (it == m_received.end()) {
+                    return;
+                }
+                Data segment = it->second;
+                m_received.erase(it);
+                m_retries.erase(m_nextToDeliver);
+                m_nextToDeliver++;
+                m_onSegment(segment);
+            }
+        }
+
+        void
+        SegmentPipeline::updateLastSegment(const Data& data)
+        {
+            const name::Component& finalBlockId = data.getFinalBlockId();
+            if (!finalBlockId.empty() && finalBlockId.isSegment()) {
+                m_lastSegment = finalBlockId.toSegment();
+                m_hasLastSegment = true;
+            }
+        }
+
+        void
+        SegmentPipeline::fail()
+        {
+            m_isFailed = true;
+            if (m_nOutstanding == 0 && !m_isDone) {
+                m_isDone = true;
+                m_received.clear();
+                m_onError();
+            }
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,104 @@
+#ifndef NDNFIT_DSU_SEGMENT_PIPELINE_HPP
+#define NDNFIT_DSU_SEGMENT_PIPELINE_HPP
+
+#include "outstanding-interest-table.hpp"
+
+#include <map>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Fetches the segments of an object once one of them has arrived
+         *
+         * Up to @p window segment Interests are outstanding at a time, through the same
+         * OutstandingInterestTable as every other fetch from the phone. Segments are handed to
+         * onSegment in order: one that arrives early waits in a reorder buffer, and no segment
+         * more than @p window past the next one to deliver is asked for, so at most @p window
+         * segments are held whatever the size of the object. The last segment is known from the
+         * FinalBlockId of any segment.
+         *
+         * A segment is asked again after a timeout, up to @p maxRetries times; then the fetch
+         * fails, once the Interests still outstanding have returned. Without a FinalBlockId, a
+         * segment past the highest one received that times out for good marks the end of the
+         * object instead: the segments up to the highest one received complete it.
+         *
+         * Two pipelines fetching the same object share the Interests they both ask for. The
+         * pipeline keeps itself alive while it has Interests outstanding.
+         */
+        class SegmentPipeline : public enable_shared_from_this<SegmentPipeline>, noncopyable
+        {
+        public:
+            /// the next segment, in order
+            typedef function<void(const Data& segment)> SegmentCallback;
+            typedef function<void()> CompleteCallback;
+            typedef function<void()> ErrorCallback;
+
+            SegmentPipeline(OutstandingInterestTable& interests, const name::Component& user,
+                            size_t window, time::milliseconds lifetime, int maxRetries,
+                            const SegmentCallback& onSegment, const CompleteCallback& onComplete,
+                            const ErrorCallback& onError);
+
+            /// @param segment the segment that has already been received, its name ends with a segment number
+            void
+            start(const Data& segment);
+
+        private:
+            void
+            fill();
+
+            void
+            onData(uint64_t segmentNo, const Data& data);
+
+            void
+            onTimeout(uint64_t segmentNo);
+
+            void
+            express(uint64_t segmentNo);
+
+            /// hand over the segments that are now in order
+            void
+            deliver();
+
+            void
+            updateLastSegment(const Data& data);
+
+            bool
+            isPastEnd(uint64_t segmentNo) const
+            {
+                return m_hasLastSegment && segmentNo > m_lastSegment;
+            }
+
+            void
+            fail();
+
+        private:
+            OutstandingInterestTable& m_interests;
+            name::Component m_user;
+            size_t m_window;
+            time::milliseconds m_lifetime;
+            int m_maxRetries;
+            SegmentCallback m_onSegment;
+            CompleteCallback m_onComplete;
+            ErrorCallback m_onError;
+
+            // the object's name, without the segment number
+            Name m_prefix;
+            uint64_t m_highestReceived;
+            uint64_t m_nextToExpress;
+            uint64_t m_nextToDeliver;
+            uint64_t m_lastSegment;
+            bool m_hasLastSegment;
+            size_t m_nOutstanding;
+            bool m_isFailed;
+            // complete, or failed and reported
+            bool m_isDone;
+            // received ahead of m_nextToDeliver
+            std::map<uint64_t, Data> m_received;
+            std::map<uint64_t, int> m_retries;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_SEGMENT_PIPELINE_HPP
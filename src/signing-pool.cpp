@@ -0,0 +1,64 @@
+#include "signing-pool.hpp"
+#include "logger.hpp"
+
+namespace ndn {
+    namespace dsu {
+
+        DSU_LOG_INIT(SigningPool);
+
+        SigningPool::SigningPool(boost::asio::io_service& ioService, KeyChain& keyChain,
+                                 size_t nThreads, size_t maxBatch)
+        : m_workers(ioService, nThreads, maxBatch,
+                    bind(&SigningPool::makeSigner, ref(keyChain), nThreads > 0),
+                    &SigningPool::deliver)
+        {
+        }
+
+        void
+        SigningPool::sign(const shared_ptr<Data>& data, const security::SigningInfo& signingInfo,
+                          const SignedCallback& callback)
+        {
+            Job job;
+            job.data = data;
+            job.signingInfo = signingInfo;
+            job.callback = callback;
+            m_workers.post(job);
+        }
+
+        WorkerPool<SigningPool::Job>::Processor
+        SigningPool::makeSigner(KeyChain& keyChain, bool isWorker)
+        {
+            if (!isWorker) {
+                return bind(&SigningPool::signBatch, ref(keyChain), _1);
+            }
+            // KeyChain is not thread-safe, every worker opens its own
+            shared_ptr<KeyChain> workerKeyChain = make_shared<KeyChain>();
+            return [workerKeyChain] (Batch& batch) { signBatch(*workerKeyChain, batch); };
+        }
+
+        void
+        SigningPool::signBatch(KeyChain& keyChain, Batch& batch)
+        {
+            for (Batch::iterator it = batch.begin(); it != batch.end(); ++it) {
+                try {
+                    keyChain.sign(*it->data, it->signingInfo);
+                }
+                catch (const std::exception& e) {
+                    DSU_LOG_ERROR("Cannot sign " << it->data->getName() << ": " << e.what());
+                    it->data.reset();
+                }
+            }
+        }
+
+        void
+        SigningPool::deliver(Batch& batch)
+        {
+            for (Batch::iterator it = batch.begin(); it != batch.end(); ++it) {
+                if (it->data != nullptr) {
+                    it->callback(it->data);
+                }
+            }
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,67 @@
+#ifndef NDNFIT_DSU_SIGNING_POOL_HPP
+#define NDNFIT_DSU_SIGNING_POOL_HPP
+
+#include "worker-pool.hpp"
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-info.hpp>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Signs reply Data packets on worker threads
+         *
+         * sign() only queues the packet. Each worker owns its own KeyChain, takes up to
+         * @p maxBatch queued packets at a time, signs them, and posts the whole batch back to
+         * @p ioService, where the callbacks run (typically to Face::put the packet). With zero
+         * threads the packet is signed with @p keyChain and the callback invoked before sign()
+         * returns.
+         */
+        class SigningPool : noncopyable
+        {
+        public:
+            typedef function<void(const shared_ptr<Data>& data)> SignedCallback;
+
+            SigningPool(boost::asio::io_service& ioService, KeyChain& keyChain,
+                        size_t nThreads, size_t maxBatch = 32);
+
+            void
+            sign(const shared_ptr<Data>& data, const security::SigningInfo& signingInfo,
+                 const SignedCallback& callback);
+
+            size_t
+            getThreadCount() const
+            {
+                return m_workers.getThreadCount();
+            }
+
+        private:
+            struct Job
+            {
+                shared_ptr<Data> data;
+                security::SigningInfo signingInfo;
+                SignedCallback callback;
+            };
+
+            typedef WorkerPool<Job>::Batch Batch;
+
+            /// signs with @p keyChain on the calling thread, or with a KeyChain of its own on a worker
+            static WorkerPool<Job>::Processor
+            makeSigner(KeyChain& keyChain, bool isWorker);
+
+            static void
+            signBatch(KeyChain& keyChain, Batch& batch);
+
+            static void
+            deliver(Batch& batch);
+
+        private:
+            WorkerPool<Job> m_workers;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_SIGNING_POOL_HPP
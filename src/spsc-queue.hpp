@@ -0,0 +1,105 @@
+#ifndef NDNFIT_DSU_SPSC_QUEUE_HPP
+#define NDNFIT_DSU_SPSC_QUEUE_HPP
+
+#include <ndn-cxx/common.hpp>
+
+#include <atomic>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Unbounded lock-free queue between exactly one producer thread and one consumer thread
+         *
+         * Items are stored in chunks of @p ChunkSize slots. The producer publishes a slot by
+         * advancing the chunk's write count, and links a new chunk once one is full; the
+         * consumer frees a chunk once it has read all of it. Neither side ever waits for the
+         * other, so a slow consumer cannot block the producer.
+         */
+        template<typename T, size_t ChunkSize = 256>
+        class SpscQueue : noncopyable
+        {
+        public:
+            SpscQueue()
+            : m_head(new Chunk)
+            , m_headIndex(0)
+            , m_tail(m_head)
+            , m_tailIndex(0)
+            {
+            }
+
+            ~SpscQueue()
+            {
+                while (m_head != nullptr) {
+                    Chunk* next = m_head->next.load(std::memory_order_relaxed);
+                    delete m_head;
+                    m_head = next;
+                }
+            }
+
+            /// on the producer thread
+            void
+            push(const T& item)
+            {
+                if (m_tailIndex == ChunkSize) {
+                    Chunk* chunk = new Chunk;
+                    m_tail->next.store(chunk, std::memory_order_release);
+                    m_tail = chunk;
+                    m_tailIndex = 0;
+                }
+                m_tail->items[m_tailIndex] = item;
+                m_tail->nWritten.store(++m_tailIndex, std::memory_order_release);
+            }
+
+            /// on the consumer thread
+            /// @return false if the queue is empty
+            bool
+            pop(T& item)
+            {
+                if (m_headIndex == ChunkSize) {
+                    Chunk* next = m_head->next.load(std::memory_order_acquire);
+                    if (next == nullptr) {
+                        return false;
+                    }
+                    // the producer moved to the next chunk before linking it
+                    delete m_head;
+                    m_head = next;
+                    m_headIndex = 0;
+                }
+                if (m_headIndex == m_head->nWritten.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                item = m_head->items[m_headIndex];
+                // release what the item holds now rather than when the chunk is freed
+                m_head->items[m_headIndex] = T();
+                m_headIndex++;
+                return true;
+            }
+
+        private:
+            struct Chunk
+            {
+                Chunk()
+                : nWritten(0)
+                , next(nullptr)
+                {
+                }
+
+                T items[ChunkSize];
+                std::atomic<size_t> nWritten;
+                std::atomic<Chunk*> next;
+            };
+
+        private:
+            // consumer side
+            Chunk* m_head;
+            size_t m_headIndex;
+            // producer side
+            Chunk* m_tail;
+            size_t m_tailIndex;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_SPSC_QUEUE_HPP
@@ -0,0 +1,101 @@
+#include "stored-name-index.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+    namespace dsu {
+
+        size_t
+        StoredNameIndex::EntryHash::operator()(const Entry& entry) const
+        {
+            uint64_t hash = entry.key.id * 0x9e3779b97f4a7c15ULL;
+            hash ^= (entry.key.version + (static_cast<uint64_t>(entry.user) << 8) + entry.key.kind) * 0xc2b2ae3d27d4eb4fULL;
+            return static_cast<size_t>(hash ^ (hash >> 29));
+        }
+
+        StoredNameIndex::StoredNameIndex(size_t capacity)
+        : m_capacity(std::max<size_t>(1, capacity))
+        , m_nHits(0)
+        , m_nMisses(0)
+        {
+            m_entries.reserve(m_capacity);
+        }
+
+        bool
+        StoredNameIndex::findUser(const name::Component& user, bool create, uint32_t& index)
+        {
+            UserIndex::iterator it = m_userIndex.find(user);
+            if (it == m_userIndex.end()) {
+                if (!create) {
+                    return false;
+                }
+                UserSlot slot;
+                slot.nEntries = 0;
+                if (!m_freeIndices.empty()) {
+                    slot.index = m_freeIndices.back();
+                    m_freeIndices.pop_back();
+                } else {
+                    slot.index = static_cast<uint32_t>(m_users.size());
+                    m_users.push_back(m_userIndex.end());
+                }
+                it = m_userIndex.insert(std::make_pair(user, slot)).first;
+                m_users[slot.index] = it;
+            }
+            index = it->second.index;
+            return true;
+        }
+
+        void
+        StoredNameIndex::evictLeastRecentlyUsed()
+        {
+            const Entry& entry = m_lru.back();
+            UserIndex::iterator user = m_users[entry.user];
+            if (--user->second.nEntries == 0) {
+                m_freeIndices.push_back(entry.user);
+                m_userIndex.erase(user);
+            }
+            m_entries.erase(entry);
+            m_lru.pop_back();
+        }
+
+        void
+        StoredNameIndex::insert(const name::Component& user, const FetchKey& key)
+        {
+            Entry entry;
+            findUser(user, true, entry.user);
+            entry.key = key;
+
+            EntryTable::iterator it = m_entries.find(entry);
+            if (it != m_entries.end()) {
+                m_lru.splice(m_lru.begin(), m_lru, it->second);
+                return;
+            }
+            // the user is counted first, so that evicting its own last entry keeps it
+            m_users[entry.user]->second.nEntries++;
+            if (m_lru.size() >= m_capacity) {
+                evictLeastRecentlyUsed();
+            }
+            m_lru.push_front(entry);
+            m_entries.insert(std::make_pair(entry, m_lru.begin()));
+        }
+
+        bool
+        StoredNameIndex::contains(const name::Component& user, const FetchKey& key)
+        {
+            Entry entry;
+            EntryTable::iterator it = m_entries.end();
+            if (findUser(user, false, entry.user)) {
+                entry.key = key;
+                it = m_entries.find(entry);
+            }
+            if (it == m_entries.end()) {
+                m_nMisses++;
+                return false;
+            }
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+            m_nHits++;
+            return true;
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,114 @@
+#ifndef NDNFIT_DSU_STORED_NAME_INDEX_HPP
+#define NDNFIT_DSU_STORED_NAME_INDEX_HPP
+
+#include "pending-fetch-table.hpp"
+
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Bounded set of the packets known to be stored in the repo
+         *
+         * Filled with what the DSU itself writes to the repo and with positive answers
+         * from it, so that confirm Interests for recently synced data can be answered
+         * without asking the repo. Once @p capacity entries are held, the least recently
+         * used one is forgotten; a miss only means the repo has to be asked, never that
+         * the packet is absent. A user is forgotten with its last entry.
+         */
+        class StoredNameIndex : noncopyable
+        {
+        public:
+            explicit
+            StoredNameIndex(size_t capacity = 262144);
+
+            void
+            insert(const name::Component& user, const FetchKey& key);
+
+            /// look @p key up, making it the most recently used entry if found
+            bool
+            contains(const name::Component& user, const FetchKey& key);
+
+            size_t
+            size() const
+            {
+                return m_lru.size();
+            }
+
+            /// users with entries
+            size_t
+            getUserCount() const
+            {
+                return m_userIndex.size();
+            }
+
+            size_t
+            getHitCount() const
+            {
+                return m_nHits;
+            }
+
+            size_t
+            getMissCount() const
+            {
+                return m_nMisses;
+            }
+
+        private:
+            struct Entry
+            {
+                bool
+                operator==(const Entry& other) const
+                {
+                    return user == other.user && key == other.key;
+                }
+
+                uint32_t user;
+                FetchKey key;
+            };
+
+            struct EntryHash
+            {
+                size_t
+                operator()(const Entry& entry) const;
+            };
+
+            typedef std::list<Entry> LruList;
+            typedef std::unordered_map<Entry, LruList::iterator, EntryHash> EntryTable;
+
+            struct UserSlot
+            {
+                uint32_t index;
+                size_t nEntries;
+            };
+
+            typedef std::map<name::Component, UserSlot> UserIndex;
+
+            /// @return a small number standing for @p user, allocated if @p create is set
+            bool
+            findUser(const name::Component& user, bool create, uint32_t& index);
+
+            void
+            evictLeastRecentlyUsed();
+
+        private:
+            size_t m_capacity;
+            UserIndex m_userIndex;
+            // user of each allocated number, numbers of forgotten users are reused
+            std::vector<UserIndex::iterator> m_users;
+            std::vector<uint32_t> m_freeIndices;
+            // most recently used at the front
+            LruList m_lru;
+            EntryTable m_entries;
+            size_t m_nHits;
+            size_t m_nMisses;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_STORED_NAME_INDEX_HPP
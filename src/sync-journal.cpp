@@ -0,0 +1,310 @@
+#include "sync-journal.hpp"
+#include "file-io.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn {
+    namespace dsu {
+
+        DSU_LOG_INIT(SyncJournal);
+
+        static const char MAGIC[] = "NDSUJNL1";
+        static const size_t INITIAL_CAPACITY = 1 << 20;
+        // payload length, CRC, type
+        static const size_t RECORD_HEADER_SIZE = 4 + 4 + 1;
+
+        SyncJournal::SyncJournal(const std::string& path, size_t nShards)
+        : m_path(path)
+        , m_nShards(nShards)
+        , m_fd(-1)
+        , m_mapping(0)
+        , m_capacity(0)
+        , m_end(HEADER_SIZE)
+        , m_nAppended(0)
+        , m_nDropped(0)
+        {
+            open();
+        }
+
+        SyncJournal::~SyncJournal()
+        {
+            close();
+        }
+
+        void
+        SyncJournal::open()
+        {
+            m_fd = ::open(m_path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (m_fd < 0) {
+                throw Error(describeErrno("cannot open journal", m_path));
+            }
+
+            struct stat status;
+            bool isNew = false;
+            try {
+                if (::fstat(m_fd, &status) != 0) {
+                    throw Error(describeErrno("cannot stat journal", m_path));
+                }
+                isNew = status.st_size == 0;
+                map(std::max(INITIAL_CAPACITY, static_cast<size_t>(status.st_size)));
+            }
+            catch (const Error&) {
+                close();
+                throw;
+            }
+
+            if (isNew) {
+                std::memcpy(m_mapping, MAGIC, HEADER_SIZE);
+            } else if (std::memcmp(m_mapping, MAGIC, HEADER_SIZE) != 0) {
+                close();
+                throw Error(m_path + " is not a ndnfit-dsu journal");
+            }
+            // journals written before the number of shards was recorded are taken as they are
+            int64_t nShards = -1;
+            m_end = scan(0, 0, 0, 0, &nShards);
+            if (nShards < 0) {
+                append(RECORD_SHARDS, name::Component(), 0, m_nShards);
+            } else if (static_cast<size_t>(nShards) != m_nShards) {
+                close();
+                throw Error(m_path + " was written with --shards " + std::to_string(nShards) +
+                            ", its users would be restored by the wrong shards; restart with --shards " +
+                            std::to_string(nShards) + " or move the journals and spill directories away");
+            }
+            m_nDropped = 0;
+        }
+
+        void
+        SyncJournal::close()
+        {
+            if (m_mapping != 0) {
+                ::msync(m_mapping, m_capacity, MS_SYNC);
+                ::munmap(m_mapping, m_capacity);
+                m_mapping = 0;
+            }
+            if (m_fd >= 0) {
+                ::close(m_fd);
+                m_fd = -1;
+            }
+        }
+
+        void
+        SyncJournal::map(size_t capacity)
+        {
+            if (m_mapping != 0) {
+                ::munmap(m_mapping, m_capacity);
+                m_mapping = 0;
+            }
+            // the file is extended with zeros, which scan() reads as the end of the journal
+            if (::ftruncate(m_fd, capacity) != 0) {
+                throw Error(describeErrno("cannot resize journal", m_path));
+            }
+            void* mapping = ::mmap(0, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+            if (mapping == MAP_FAILED) {
+                throw Error(describeErrno("cannot map journal", m_path));
+            }
+            m_mapping = static_cast<uint8_t*>(mapping);
+            m_capacity = capacity;
+        }
+
+        void
+        SyncJournal::encode(std::vector<uint8_t>& buffer, RecordType type, const name::Component& user,
+                            const FetchKey* key, uint64_t number)
+        {
+            buffer.clear();
+            putUint(buffer, 0, 4);
+            putUint(buffer, 0, 4);
+            putUint(buffer, type, 1);
+            putUint(buffer, user.value_size(), 2);
+            buffer.insert(buffer.end(), user.value(), user.value() + user.value_size());
+            if (key != 0) {
+                putUint(buffer, key->kind, 1);
+                putUint(buffer, key->id, 8);
+                putUint(buffer, key->version, 8);
+                if (type == RECORD_PENDING_ADD) {
+                    putUint(buffer, number, 4);
+                }
+            } else if (type == RECORD_PROGRESS || type == RECORD_SHARDS) {
+                putUint(buffer, number, 8);
+            }
+
+            uint32_t payloadLength = static_cast<uint32_t>(buffer.size() - RECORD_HEADER_SIZE);
+            uint32_t crc = checksum(&buffer[8], buffer.size() - 8);
+            for (size_t i = 0; i < 4; i++) {
+                buffer[i] = static_cast<uint8_t>(payloadLength >> (8 * i));
+                buffer[4 + i] = static_cast<uint8_t>(crc >> (8 * i));
+            }
+        }
+
+        void
+        SyncJournal::append(RecordType type, const name::Component& user, const FetchKey* key, uint64_t number)
+        {
+            if (m_mapping == 0) {
+                // the journal could not be reopened or grown; the next compaction tries again
+                if (m_nDropped++ == 0) {
+                    DSU_LOG_ERROR("Journal " << m_path << " is not open, records are dropped until it is compacted");
+                }
+                return;
+            }
+            encode(m_buffer, type, user, key, number);
+            if (m_end + m_buffer.size() > m_capacity) {
+                map(std::max(m_capacity * 2, m_end + m_buffer.size()));
+            }
+            // write the body before the length, so a torn record never looks complete
+            std::memcpy(m_mapping + m_end + 4, &m_buffer[4], m_buffer.size() - 4);
+            std::memcpy(m_mapping + m_end, &m_buffer[0], 4);
+            m_end += m_buffer.size();
+            m_nAppended++;
+        }
+
+        void
+        SyncJournal::addUser(const name::Component& user)
+        {
+            append(RECORD_USER, user, 0, 0);
+        }
+
+        void
+        SyncJournal::setProgress(const name::Component& user, uint64_t nextSeqNo)
+        {
+            append(RECORD_PROGRESS, user, 0, nextSeqNo);
+        }
+
+        void
+        SyncJournal::removeUser(const name::Component& user)
+        {
+            append(RECORD_USER_REMOVE, user, 0, 0);
+        }
+
+        void
+        SyncJournal::addPending(const name::Component& user, const FetchKey& key, uint32_t insertedAt)
+        {
+            append(RECORD_PENDING_ADD, user, &key, insertedAt);
+        }
+
+        void
+        SyncJournal::removePending(const name::Component& user, const FetchKey& key)
+        {
+            append(RECORD_PENDING_REMOVE, user, &key, 0);
+        }
+
+        size_t
+        SyncJournal::scan(PendingFetchTable* pending, ProgressMap* progress, size_t* nRecords, uint32_t now,
+                          int64_t* nShards) const
+        {
+            size_t position = HEADER_SIZE;
+            while (position + RECORD_HEADER_SIZE + 2 <= m_capacity) {
+                const uint8_t* record = m_mapping + position;
+                size_t payloadLength = getUint(record, 4);
+                if (payloadLength < 2 || position + RECORD_HEADER_SIZE + payloadLength > m_capacity ||
+                    getUint(record + 4, 4) != checksum(record + 8, payloadLength + 1)) {
+                    break;
+                }
+
+                RecordType type = static_cast<RecordType>(record[8]);
+                const uint8_t* payload = record + RECORD_HEADER_SIZE;
+                size_t userLength = getUint(payload, 2);
+                if (2 + userLength > payloadLength) {
+                    break;
+                }
+                const uint8_t* fields = payload + 2 + userLength;
+                size_t fieldsLength = payloadLength - 2 - userLength;
+
+                if (nShards != 0 && type == RECORD_SHARDS && fieldsLength >= 8) {
+                    *nShards = static_cast<int64_t>(getUint(fields, 8));
+                }
+                if (pending != 0) {
+                    name::Component user(payload + 2, userLength);
+                    if (type == RECORD_USER) {
+                        pending->addUser(user);
+                    } else if (type == RECORD_USER_REMOVE) {
+                        pending->removeUser(user);
+                        progress->erase(user);
+                    } else if (type == RECORD_PROGRESS && fieldsLength >= 8) {
+                        (*progress)[user] = getUint(fields, 8);
+                    } else if ((type == RECORD_PENDING_ADD || type == RECORD_PENDING_REMOVE) && fieldsLength >= 17) {
+                        FetchKey key(static_cast<FetchKind>(fields[0]), getUint(fields + 1, 8), getUint(fields + 9, 8));
+                        if (type == RECORD_PENDING_ADD) {
+                            // journals written before insertion times were recorded have none
+                            uint32_t insertedAt = fieldsLength >= 21 ? static_cast<uint32_t>(getUint(fields + 17, 4)) : now;
+                            pending->addUser(user).insert(key, insertedAt) = 0;
+                        } else if (pending->getUser(user) != 0) {
+                            pending->getUser(user)->erase(key);
+                        }
+                    }
+                }
+                if (nRecords != 0) {
+                    (*nRecords)++;
+                }
+                position += RECORD_HEADER_SIZE + payloadLength;
+            }
+            return position;
+        }
+
+        size_t
+        SyncJournal::load(PendingFetchTable& pending, ProgressMap& progress, uint32_t now) const
+        {
+            size_t nRecords = 0;
+            scan(&pending, &progress, &nRecords, now);
+            return nRecords;
+        }
+
+        void
+        SyncJournal::compact(const PendingFetchTable& pending, const ProgressMap& progress)
+        {
+            std::vector<uint8_t> snapshot(MAGIC, MAGIC + HEADER_SIZE);
+            std::vector<uint8_t>& buffer = m_buffer;
+            encode(buffer, RECORD_SHARDS, name::Component(), 0, m_nShards);
+            snapshot.insert(snapshot.end(), buffer.begin(), buffer.end());
+            pending.forEachUser([&] (const name::Component& user, const PendingFetchSet& entries) {
+                encode(buffer, RECORD_USER, user, 0, 0);
+                snapshot.insert(snapshot.end(), buffer.begin(), buffer.end());
+                entries.forEachInsertion([&] (const FetchKey& key, uint32_t insertedAt) {
+                    if (key.kind != FETCH_UPDATE_INFO) {
+                        encode(buffer, RECORD_PENDING_ADD, user, &key, insertedAt);
+                        snapshot.insert(snapshot.end(), buffer.begin(), buffer.end());
+                    }
+                });
+            });
+            for (ProgressMap::const_iterator it = progress.begin(); it != progress.end(); ++it) {
+                encode(buffer, RECORD_PROGRESS, it->first, 0, it->second);
+                snapshot.insert(snapshot.end(), buffer.begin(), buffer.end());
+            }
+
+            std::string temporaryPath = m_path + ".tmp";
+            std::string reason;
+            if (!writeFile(temporaryPath, snapshot, true, reason)) {
+                throw Error(reason);
+            }
+
+            // if either open() throws, the journal is left closed: append() and flush() do nothing
+            // and the next compaction, which writes the whole state again, tries to reopen it
+            close();
+            if (::rename(temporaryPath.c_str(), m_path.c_str()) != 0) {
+                Error error(describeErrno("cannot replace journal with", temporaryPath));
+                ::unlink(temporaryPath.c_str());
+                // keep appending to the old journal
+                open();
+                throw error;
+            }
+            open();
+            m_nAppended = 0;
+        }
+
+        void
+        SyncJournal::flush()
+        {
+            if (m_mapping == 0) {
+                DSU_LOG_ERROR("Journal " << m_path << " is not open, " << m_nDropped << " records dropped so far");
+                return;
+            }
+            ::msync(m_mapping, m_capacity, MS_ASYNC);
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,161 @@
+#ifndef NDNFIT_DSU_SYNC_JOURNAL_HPP
+#define NDNFIT_DSU_SYNC_JOURNAL_HPP
+
+#include "pending-fetch-table.hpp"
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Append-only, memory-mapped journal of per-user sync progress
+         *
+         * Records which users are known, the next update_info sequence number each of them
+         * needs, and the catalog/datapoint fetches still pending. Records are written into a
+         * shared file mapping, so they survive a crash of the process as soon as append
+         * returns; flush() asks the kernel to write them to disk. Every record carries a CRC,
+         * and replay stops at the first torn or missing one.
+         *
+         * compact() replaces the journal with a snapshot of the current state, written to a
+         * temporary file and renamed over the journal. If the journal cannot be opened again
+         * afterwards, or cannot be grown, it stays closed: records are dropped, with an error
+         * logged, until a later compaction opens it.
+         *
+         * The journal also records how many shards the users are split among, since a user
+         * restored by the wrong shard would never hear from its phone again.
+         */
+        class SyncJournal : noncopyable
+        {
+        public:
+            class Error : public std::runtime_error
+            {
+            public:
+                explicit
+                Error(const std::string& what)
+                : std::runtime_error(what)
+                {
+                }
+            };
+
+            /// map user_id to the first update_info sequence number not fetched yet
+            typedef std::map<name::Component, uint64_t> ProgressMap;
+
+            /**
+             * @brief Open or create the journal at @p path
+             * @param nShards number of shards whose journals the users are split among, 0 if
+             *                they are not split; a journal that does not record it yet gets it
+             * @throw Error the file cannot be opened or mapped, is not a journal, or was written
+             *              with another number of shards
+             */
+            SyncJournal(const std::string& path, size_t nShards);
+
+            ~SyncJournal();
+
+            /**
+             * @brief Rebuild the state recorded in the journal
+             *
+             * Users and their pending catalog/datapoint fetches are added to @p pending, each
+             * with the time it was recorded with; records written without one count as
+             * inserted at @p now.
+             * @return the number of records replayed
+             */
+            size_t
+            load(PendingFetchTable& pending, ProgressMap& progress, uint32_t now) const;
+
+            void
+            addUser(const name::Component& user);
+
+            void
+            setProgress(const name::Component& user, uint64_t nextSeqNo);
+
+            /// forget @p user and everything recorded about it, e.g. once it has been spilled
+            void
+            removeUser(const name::Component& user);
+
+            /// @p insertedAt is in the clock of PendingFetchSet::insert(), which must be the wall clock
+            void
+            addPending(const name::Component& user, const FetchKey& key, uint32_t insertedAt);
+
+            void
+            removePending(const name::Component& user, const FetchKey& key);
+
+            /**
+             * @brief Rewrite the journal so that it only holds the given state
+             *
+             * update_info entries of @p pending are not recorded; @p progress covers them.
+             */
+            void
+            compact(const PendingFetchTable& pending, const ProgressMap& progress);
+
+            /// schedule the mapped pages to be written to disk
+            void
+            flush();
+
+            /// bytes of records in the journal
+            size_t
+            getSize() const
+            {
+                return m_end - HEADER_SIZE;
+            }
+
+            /// records appended since the last compaction
+            size_t
+            getRecordsSinceCompaction() const
+            {
+                return m_nAppended;
+            }
+
+        private:
+            enum RecordType {
+                RECORD_USER = 1,
+                RECORD_PROGRESS = 2,
+                RECORD_PENDING_ADD = 3,
+                RECORD_PENDING_REMOVE = 4,
+                RECORD_USER_REMOVE = 5,
+                RECORD_SHARDS = 6
+            };
+
+            static const size_t HEADER_SIZE = 8;
+
+            void
+            open();
+
+            void
+            close();
+
+            void
+            map(size_t capacity);
+
+            void
+            append(RecordType type, const name::Component& user, const FetchKey* key, uint64_t number);
+
+            static void
+            encode(std::vector<uint8_t>& buffer, RecordType type, const name::Component& user,
+                   const FetchKey* key, uint64_t number);
+
+            /// @return the end of the last valid record
+            size_t
+            scan(PendingFetchTable* pending, ProgressMap* progress, size_t* nRecords, uint32_t now,
+                 int64_t* nShards = 0) const;
+
+        private:
+            std::string m_path;
+            size_t m_nShards;
+            int m_fd;
+            uint8_t* m_mapping;
+            size_t m_capacity;
+            size_t m_end;
+            size_t m_nAppended;
+            // records dropped while the journal is not open
+            size_t m_nDropped;
+            std::vector<uint8_t> m_buffer;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_SYNC_JOURNAL_HPP
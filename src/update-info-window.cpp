@@ -0,0 +1,110 @@
+#include "update-info-window.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+    namespace dsu {
+
+        UpdateInfoWindow::UpdateInfoWindow(uint64_t firstSeqNo, double initialWindow, double maxWindow)
+        : m_window(std::max(1.0, initialWindow))
+        , m_ssthresh(maxWindow)
+        , m_maxWindow(std::max(1.0, maxWindow))
+        , m_nextExpected(firstSeqNo)
+        , m_nextToSend(firstSeqNo)
+        , m_highestReceived(0)
+        , m_recoveryPoint(firstSeqNo)
+        , m_isAtEnd(false)
+        , m_nProbeTimeouts(0)
+        {
+        }
+
+        bool
+        UpdateInfoWindow::hasProbeInFlight() const
+        {
+            return !m_inFlight.empty() && *m_inFlight.rbegin() > m_highestReceived;
+        }
+
+        std::vector<uint64_t>
+        UpdateInfoWindow::fill()
+        {
+            std::vector<uint64_t> toSend;
+            // at the end of the stream only one Interest past the last received seqNo is kept
+            if (m_isAtEnd && hasProbeInFlight()) {
+                return toSend;
+            }
+
+            size_t limit = m_isAtEnd ? m_inFlight.size() + 1 : static_cast<size_t>(m_window);
+            while (m_inFlight.size() < limit) {
+                if (isReceived(m_nextToSend) || m_inFlight.count(m_nextToSend) > 0) {
+                    m_nextToSend++;
+                    continue;
+                }
+                m_inFlight.insert(m_nextToSend);
+                toSend.push_back(m_nextToSend);
+                m_nextToSend++;
+            }
+            return toSend;
+        }
+
+        bool
+        UpdateInfoWindow::onData(uint64_t seqNo)
+        {
+            if (m_inFlight.erase(seqNo) == 0 || isReceived(seqNo)) {
+                return false;
+            }
+
+            if (seqNo == m_nextExpected) {
+                m_nextExpected++;
+                while (!m_received.empty() && *m_received.begin() == m_nextExpected) {
+                    m_received.erase(m_received.begin());
+                    m_nextExpected++;
+                }
+            } else {
+                m_received.insert(seqNo);
+            }
+            m_highestReceived = std::max(m_highestReceived, seqNo);
+
+            // the phone published something new, leave probing mode and slow start again
+            m_isAtEnd = false;
+            m_nProbeTimeouts = 0;
+            if (m_window < m_ssthresh) {
+                m_window += 1;
+            } else {
+                m_window += 1 / m_window;
+            }
+            m_window = std::min(m_window, m_maxWindow);
+            return true;
+        }
+
+        UpdateInfoWindow::TimeoutAction
+        UpdateInfoWindow::onTimeout(uint64_t seqNo)
+        {
+            if (m_inFlight.count(seqNo) == 0) {
+                return IGNORE;
+            }
+
+            if (seqNo < m_highestReceived) {
+                // a hole below Data we already have: a real loss
+                if (seqNo >= m_recoveryPoint) {
+                    m_window = std::max(1.0, m_window / 2);
+                    m_ssthresh = std::max(2.0, m_window);
+                    m_recoveryPoint = m_nextToSend;
+                }
+                return RETRANSMIT;
+            }
+
+            // nothing has been published at seqNo yet
+            m_isAtEnd = true;
+            m_window = 1;
+            if (seqNo == *m_inFlight.upper_bound(m_highestReceived)) {
+                // keep polling the first missing seqNo
+                m_nProbeTimeouts++;
+                return PROBE;
+            }
+            m_inFlight.erase(seqNo);
+            m_nextToSend = std::min(m_nextToSend, seqNo);
+            return DROP;
+        }
+
+    } // namespace dsu
+} // namespace ndn
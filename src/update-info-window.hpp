@@ -0,0 +1,127 @@
+#ifndef NDNFIT_DSU_UPDATE_INFO_WINDOW_HPP
+#define NDNFIT_DSU_UPDATE_INFO_WINDOW_HPP
+
+#include <cstddef>
+#include <set>
+#include <vector>
+#include <stdint.h>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Look-ahead window over one user's update_info sequence numbers
+         *
+         * Keeps several update_info Interests in flight instead of asking for seqNo+1 only
+         * after seqNo arrived. The window grows additively on every Data and is halved once
+         * per loss episode (a timeout below the highest received seqNo). A timeout above the
+         * highest received seqNo means the phone has not produced that packet yet: the window
+         * then falls back to a single probe Interest until new Data shows up. Probe timeouts
+         * say nothing about the path to the phone, so they are counted apart from losses.
+         */
+        class UpdateInfoWindow
+        {
+        public:
+            enum TimeoutAction {
+                /// express the same Interest again
+                RETRANSMIT,
+                /// express the end-of-stream probe again, the phone has nothing new yet
+                PROBE,
+                /// speculative Interest past the end of the stream, forget it
+                DROP,
+                /// the sequence number is not in flight
+                IGNORE
+            };
+
+            explicit
+            UpdateInfoWindow(uint64_t firstSeqNo = 1, double initialWindow = 2, double maxWindow = 32);
+
+            /**
+             * @brief Return the sequence numbers that should be expressed now
+             *
+             * The returned numbers are marked as in flight.
+             */
+            std::vector<uint64_t>
+            fill();
+
+            /**
+             * @brief Record the arrival of @p seqNo
+             * @return false if @p seqNo was not in flight (duplicate or unsolicited Data)
+             */
+            bool
+            onData(uint64_t seqNo);
+
+            TimeoutAction
+            onTimeout(uint64_t seqNo);
+
+            /// lowest sequence number that has not been received yet
+            uint64_t
+            getNextExpected() const
+            {
+                return m_nextExpected;
+            }
+
+            bool
+            isAtEndOfStream() const
+            {
+                return m_isAtEnd;
+            }
+
+            size_t
+            getInFlight() const
+            {
+                return m_inFlight.size();
+            }
+
+            double
+            getWindow() const
+            {
+                return m_window;
+            }
+
+            /// probe timeouts since the last Data
+            int
+            getProbeTimeoutCount() const
+            {
+                return m_nProbeTimeouts;
+            }
+
+            /// forget the probe timeouts, e.g. when the phone registers again
+            void
+            resetProbeTimeouts()
+            {
+                m_nProbeTimeouts = 0;
+            }
+
+        private:
+            bool
+            isReceived(uint64_t seqNo) const
+            {
+                return seqNo < m_nextExpected || m_received.count(seqNo) > 0;
+            }
+
+            bool
+            hasProbeInFlight() const;
+
+        private:
+            double m_window;
+            double m_ssthresh;
+            double m_maxWindow;
+
+            uint64_t m_nextExpected;
+            uint64_t m_nextToSend;
+            uint64_t m_highestReceived;
+            // seqNo sent when the last decrease happened; losses below it belong to the same episode
+            uint64_t m_recoveryPoint;
+            bool m_isAtEnd;
+            int m_nProbeTimeouts;
+
+            std::set<uint64_t> m_inFlight;
+            // received out of order, all above m_nextExpected
+            std::set<uint64_t> m_received;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_UPDATE_INFO_WINDOW_HPP
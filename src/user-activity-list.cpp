@@ -0,0 +1,31 @@
+#include "user-activity-list.hpp"
+
+namespace ndn {
+    namespace dsu {
+
+        void
+        UserActivityList::touch(const name::Component& user, const time::steady_clock::TimePoint& now)
+        {
+            std::map<name::Component, EntryList::iterator>::iterator it = m_index.find(user);
+            if (it == m_index.end()) {
+                Entry entry = {user, now};
+                m_entries.push_front(entry);
+                m_index.insert(std::make_pair(user, m_entries.begin()));
+                return;
+            }
+            it->second->lastActive = now;
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+        }
+
+        void
+        UserActivityList::remove(const name::Component& user)
+        {
+            std::map<name::Component, EntryList::iterator>::iterator it = m_index.find(user);
+            if (it != m_index.end()) {
+                m_entries.erase(it->second);
+                m_index.erase(it);
+            }
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,73 @@
+#ifndef NDNFIT_DSU_USER_ACTIVITY_LIST_HPP
+#define NDNFIT_DSU_USER_ACTIVITY_LIST_HPP
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+#include <list>
+#include <map>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Known users, ordered by the last time their phone was heard from
+         *
+         * The least recently active user is the first one to evict when memory runs short
+         * or when it has been idle for too long.
+         */
+        class UserActivityList : noncopyable
+        {
+        public:
+            /// make @p user the most recently active one, adding it if needed
+            void
+            touch(const name::Component& user, const time::steady_clock::TimePoint& now);
+
+            void
+            remove(const name::Component& user);
+
+            bool
+            empty() const
+            {
+                return m_entries.empty();
+            }
+
+            size_t
+            size() const
+            {
+                return m_entries.size();
+            }
+
+            /// the list must not be empty
+            const name::Component&
+            getLeastRecentUser() const
+            {
+                return m_entries.back().user;
+            }
+
+            /// the list must not be empty
+            const time::steady_clock::TimePoint&
+            getLeastRecentTime() const
+            {
+                return m_entries.back().lastActive;
+            }
+
+        private:
+            struct Entry
+            {
+                name::Component user;
+                time::steady_clock::TimePoint lastActive;
+            };
+
+            typedef std::list<Entry> EntryList;
+
+        private:
+            // most recently active at the front
+            EntryList m_entries;
+            std::map<name::Component, EntryList::iterator> m_index;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_USER_ACTIVITY_LIST_HPP
@@ -0,0 +1,214 @@
+#include "user-spill-store.hpp"
+#include "file-io.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn {
+    namespace dsu {
+
+        static const char MAGIC[] = "NDSUSPL2";
+        // files without insertion times
+        static const char MAGIC_V1[] = "NDSUSPL1";
+        static const size_t MAGIC_SIZE = 8;
+        static const std::string FILE_SUFFIX = ".spill";
+        // magic, next sequence number, entry count
+        static const size_t HEADER_SIZE = MAGIC_SIZE + 8 + 4;
+        // kind, id, version, insertion time
+        static const size_t ENTRY_SIZE = 1 + 8 + 8 + 4;
+        static const size_t ENTRY_SIZE_V1 = 1 + 8 + 8;
+        static const size_t CRC_SIZE = 4;
+
+        static bool
+        isSpillFile(const std::string& fileName)
+        {
+            return fileName.size() > FILE_SUFFIX.size() &&
+                   fileName.compare(fileName.size() - FILE_SUFFIX.size(), FILE_SUFFIX.size(), FILE_SUFFIX) == 0;
+        }
+
+        UserSpillStore::UserSpillStore(const std::string& directory)
+        : m_directory(directory)
+        , m_nUsers(0)
+        {
+            if (::mkdir(m_directory.c_str(), 0755) != 0 && errno != EEXIST) {
+                throw Error(describeErrno("cannot create spill directory", m_directory));
+            }
+            DIR* dir = ::opendir(m_directory.c_str());
+            if (dir == 0) {
+                throw Error(describeErrno("cannot open spill directory", m_directory));
+            }
+            while (struct dirent* entry = ::readdir(dir)) {
+                if (isSpillFile(entry->d_name)) {
+                    m_nUsers++;
+                }
+            }
+            ::closedir(dir);
+        }
+
+        std::string
+        UserSpillStore::makePath(const name::Component& user) const
+        {
+            // user_ids are arbitrary bytes, the file is named after their hex encoding
+            static const char DIGITS[] = "0123456789abcdef";
+            std::string path = m_directory + "/";
+            for (size_t i = 0; i < user.value_size(); i++) {
+                path += DIGITS[user.value()[i] >> 4];
+                path += DIGITS[user.value()[i] & 0x0f];
+            }
+            return path + FILE_SUFFIX;
+        }
+
+        void
+        UserSpillStore::save(const name::Component& user, const PendingFetchSet& pending, uint64_t nextSeqNo)
+        {
+            std::vector<uint8_t> buffer(MAGIC, MAGIC + MAGIC_SIZE);
+            putUint(buffer, nextSeqNo, 8);
+            putUint(buffer, 0, 4);
+            uint32_t nEntries = 0;
+            pending.forEachInsertion([&] (const FetchKey& key, uint32_t insertedAt) {
+                if (key.kind != FETCH_UPDATE_INFO) {
+                    putUint(buffer, key.kind, 1);
+                    putUint(buffer, key.id, 8);
+                    putUint(buffer, key.version, 8);
+                    putUint(buffer, insertedAt, 4);
+                    nEntries++;
+                }
+            });
+            for (size_t i = 0; i < 4; i++) {
+                buffer[MAGIC_SIZE + 8 + i] = static_cast<uint8_t>(nEntries >> (8 * i));
+            }
+            putUint(buffer, checksum(&buffer[0], buffer.size()), CRC_SIZE);
+            putState(user, buffer);
+        }
+
+        void
+        UserSpillStore::putState(const name::Component& user, const std::vector<uint8_t>& buffer)
+        {
+            std::string path = makePath(user);
+            std::string temporaryPath = path + ".tmp";
+            std::string reason;
+            if (!writeFile(temporaryPath, buffer, false, reason)) {
+                throw Error(reason);
+            }
+
+            bool isNew = ::access(path.c_str(), F_OK) != 0;
+            if (::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+                ::unlink(temporaryPath.c_str());
+                throw Error(describeErrno("cannot rename to", path));
+            }
+            if (isNew) {
+                m_nUsers++;
+            }
+        }
+
+        bool
+        UserSpillStore::takeState(const name::Component& user, std::vector<uint8_t>& buffer)
+        {
+            std::string path = makePath(user);
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return false;
+            }
+            uint8_t chunk[4096];
+            ssize_t n;
+            while ((n = ::read(fd, chunk, sizeof(chunk))) != 0) {
+                if (n < 0 && errno != EINTR) {
+                    break;
+                }
+                buffer.insert(buffer.end(), chunk, chunk + (n > 0 ? n : 0));
+            }
+            ::close(fd);
+            if (::unlink(path.c_str()) == 0) {
+                m_nUsers--;
+            }
+            // the file is gone either way, a user whose file cannot be read syncs again from the start
+            return n == 0;
+        }
+
+        bool
+        UserSpillStore::take(const name::Component& user, std::vector<Entry>& entries, uint64_t& nextSeqNo,
+                             uint32_t now)
+        {
+            std::vector<uint8_t> buffer;
+            return takeState(user, buffer) && parseState(buffer, entries, nextSeqNo, now);
+        }
+
+        bool
+        UserSpillStore::parseState(const std::vector<uint8_t>& buffer, std::vector<Entry>& entries,
+                                   uint64_t& nextSeqNo, uint32_t now)
+        {
+            if (buffer.size() < HEADER_SIZE + CRC_SIZE ||
+                getUint(&buffer[buffer.size() - CRC_SIZE], CRC_SIZE) != checksum(&buffer[0], buffer.size() - CRC_SIZE)) {
+                return false;
+            }
+            size_t entrySize = ENTRY_SIZE;
+            if (std::memcmp(&buffer[0], MAGIC_V1, MAGIC_SIZE) == 0) {
+                entrySize = ENTRY_SIZE_V1;
+            } else if (std::memcmp(&buffer[0], MAGIC, MAGIC_SIZE) != 0) {
+                return false;
+            }
+            size_t nEntries = getUint(&buffer[MAGIC_SIZE + 8], 4);
+            if (buffer.size() != HEADER_SIZE + nEntries * entrySize + CRC_SIZE) {
+                return false;
+            }
+
+            nextSeqNo = getUint(&buffer[MAGIC_SIZE], 8);
+            for (size_t i = 0; i < nEntries; i++) {
+                const uint8_t* field = &buffer[HEADER_SIZE + i * entrySize];
+                Entry entry;
+                entry.key = FetchKey(static_cast<FetchKind>(field[0]), getUint(field + 1, 8), getUint(field + 9, 8));
+                entry.insertedAt = entrySize == ENTRY_SIZE ? static_cast<uint32_t>(getUint(field + 17, 4)) : now;
+                entries.push_back(entry);
+            }
+            return true;
+        }
+
+        static int
+        getHexDigit(char c)
+        {
+            if (c >= '0' && c <= '9') {
+                return c - '0';
+            }
+            if (c >= 'a' && c <= 'f') {
+                return c - 'a' + 10;
+            }
+            return -1;
+        }
+
+        std::vector<name::Component>
+        UserSpillStore::listUsers() const
+        {
+            std::vector<name::Component> users;
+            DIR* dir = ::opendir(m_directory.c_str());
+            if (dir == 0) {
+                return users;
+            }
+            while (struct dirent* entry = ::readdir(dir)) {
+                std::string fileName(entry->d_name);
+                if (!isSpillFile(fileName)) {
+                    continue;
+                }
+                // the reverse of makePath
+                size_t nDigits = fileName.size() - FILE_SUFFIX.size();
+                std::vector<uint8_t> value;
+                bool isValid = nDigits % 2 == 0;
+                for (size_t i = 0; isValid && i < nDigits; i += 2) {
+                    int high = getHexDigit(fileName[i]);
+                    int low = getHexDigit(fileName[i + 1]);
+                    isValid = high >= 0 && low >= 0;
+                    value.push_back(static_cast<uint8_t>(high << 4 | low));
+                }
+                if (isValid) {
+                    users.push_back(name::Component(value.data(), value.size()));
+                }
+            }
+            ::closedir(dir);
+            return users;
+        }
+
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,117 @@
+#ifndef NDNFIT_DSU_USER_SPILL_STORE_HPP
+#define NDNFIT_DSU_USER_SPILL_STORE_HPP
+
+#include "pending-fetch-table.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Sync state of the users evicted from memory, one file per user in a directory
+         *
+         * A file holds the next update_info sequence number the user needs and its pending
+         * catalog/datapoint fetches with the time each was inserted at, followed by a CRC. It is written to a temporary file and
+         * renamed over the previous one, so it is either complete or absent; like the journal,
+         * it survives a crash of the process but is not synced to disk. The file is removed
+         * when the user is brought back into memory.
+         */
+        class UserSpillStore : noncopyable
+        {
+        public:
+            class Error : public std::runtime_error
+            {
+            public:
+                explicit
+                Error(const std::string& what)
+                : std::runtime_error(what)
+                {
+                }
+            };
+
+            /// a pending fetch read back, with its time in the clock of PendingFetchSet::insert()
+            struct Entry
+            {
+                FetchKey key;
+                uint32_t insertedAt;
+            };
+
+            /**
+             * @brief Use @p directory, creating it if needed
+             * @throw Error the directory cannot be created or read
+             */
+            explicit
+            UserSpillStore(const std::string& directory);
+
+            /**
+             * @brief Write the state of @p user, replacing what was spilled before
+             *
+             * update_info entries of @p pending are not written; @p nextSeqNo covers them.
+             * Insertion times are written as they are, so the clock of @p pending must be the
+             * wall clock for them to mean anything once read back.
+             * @throw Error the file cannot be written
+             */
+            void
+            save(const name::Component& user, const PendingFetchSet& pending, uint64_t nextSeqNo);
+
+            /**
+             * @brief Read the state of @p user and remove its file
+             *
+             * The pending fetches are appended to @p entries; those of files written before
+             * insertion times were recorded count as inserted at @p now.
+             * @return false if @p user was not spilled, or its file is damaged
+             */
+            bool
+            take(const name::Component& user, std::vector<Entry>& entries, uint64_t& nextSeqNo, uint32_t now);
+
+            /**
+             * @brief Read the file of @p user as it is and remove it, to hand the user over
+             * @return false if @p user was not spilled
+             */
+            bool
+            takeState(const name::Component& user, std::vector<uint8_t>& state);
+
+            /**
+             * @brief Write @p state, read by takeState() elsewhere, as the file of @p user
+             *
+             * It is checked when the user is taken.
+             * @throw Error the file cannot be written
+             */
+            void
+            putState(const name::Component& user, const std::vector<uint8_t>& state);
+
+            /**
+             * @brief Decode @p state, read by takeState(), as take() does
+             * @return false if it is damaged
+             */
+            static bool
+            parseState(const std::vector<uint8_t>& state, std::vector<Entry>& entries, uint64_t& nextSeqNo,
+                       uint32_t now);
+
+            /// the users that have a file, read from the directory
+            std::vector<name::Component>
+            listUsers() const;
+
+            /// users currently spilled
+            size_t
+            size() const
+            {
+                return m_nUsers;
+            }
+
+        private:
+            std::string
+            makePath(const name::Component& user) const;
+
+        private:
+            std::string m_directory;
+            size_t m_nUsers;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_USER_SPILL_STORE_HPP
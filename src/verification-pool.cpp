@@ -0,0 +1,65 @@
+#include "verification-pool.hpp"
+#include "logger.hpp"
+
+#include <ndn-cxx/security/validator.hpp>
+
+namespace ndn {
+    namespace dsu {
+
+        DSU_LOG_INIT(VerificationPool);
+
+        VerificationPool::VerificationPool(boost::asio::io_service& ioService, size_t nThreads)
+        : m_workers(ioService, nThreads, 1, &VerificationPool::makeVerifier, &VerificationPool::deliver)
+        {
+        }
+
+        void
+        VerificationPool::verify(const shared_ptr<Batch>& batch, const shared_ptr<const PublicKey>& key,
+                                 const VerifiedCallback& callback)
+        {
+            Job job;
+            job.batch = batch;
+            job.key = key;
+            job.callback = callback;
+            m_workers.post(job);
+        }
+
+        void
+        VerificationPool::verifyBatch(Batch& batch, const PublicKey& key)
+        {
+            for (Batch::iterator it = batch.begin(); it != batch.end(); ++it) {
+                try {
+                    it->isValid = Validator::verifySignature(*it->data, key);
+                }
+                catch (const std::exception& e) {
+                    DSU_LOG_DEBUG("Cannot verify " << it->data->getName() << ": " << e.what());
+                    it->isValid = false;
+                }
+            }
+        }
+
+        WorkerPool<VerificationPool::Job>::Processor
+        VerificationPool::makeVerifier()
+        {
+            // the key is only read, workers share it
+            return &VerificationPool::verifyJobs;
+        }
+
+        void
+        VerificationPool::verifyJobs(Jobs& jobs)
+        {
+            for (Jobs::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+                verifyBatch(*it->batch, *it->key);
+            }
+        }
+
+        void
+        VerificationPool::deliver(Jobs& jobs)
+        {
+            for (Jobs::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+                it->callback(it->batch);
+            }
+        }
+
+    } // namespace dsu
+} // namespace ndn
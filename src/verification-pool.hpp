@@ -0,0 +1,78 @@
+#ifndef NDNFIT_DSU_VERIFICATION_POOL_HPP
+#define NDNFIT_DSU_VERIFICATION_POOL_HPP
+
+#include "worker-pool.hpp"
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/security/public-key.hpp>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Verifies signatures of fetched Data packets on worker threads
+         *
+         * verify() only queues a batch of packets signed by the same key. A worker takes the
+         * batch, checks every signature against the key, and posts the batch back to
+         * @p ioService, where the callback runs. With zero threads the batch is verified and the
+         * callback invoked before verify() returns.
+         */
+        class VerificationPool : noncopyable
+        {
+        public:
+            struct Packet
+            {
+                shared_ptr<const Data> data;
+                // set by the worker
+                bool isValid;
+                // for the caller to find the packet again
+                uint64_t tag;
+            };
+
+            typedef std::vector<Packet> Batch;
+            typedef function<void(const shared_ptr<Batch>& batch)> VerifiedCallback;
+
+            VerificationPool(boost::asio::io_service& ioService, size_t nThreads);
+
+            void
+            verify(const shared_ptr<Batch>& batch, const shared_ptr<const PublicKey>& key,
+                   const VerifiedCallback& callback);
+
+            /// verify @p batch on the calling thread
+            static void
+            verifyBatch(Batch& batch, const PublicKey& key);
+
+            size_t
+            getThreadCount() const
+            {
+                return m_workers.getThreadCount();
+            }
+
+        private:
+            struct Job
+            {
+                shared_ptr<Batch> batch;
+                shared_ptr<const PublicKey> key;
+                VerifiedCallback callback;
+            };
+
+            // a job already holds a batch of packets, workers take one job at a time
+            typedef WorkerPool<Job>::Batch Jobs;
+
+            static WorkerPool<Job>::Processor
+            makeVerifier();
+
+            static void
+            verifyJobs(Jobs& jobs);
+
+            static void
+            deliver(Jobs& jobs);
+
+        private:
+            WorkerPool<Job> m_workers;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_VERIFICATION_POOL_HPP
@@ -0,0 +1,131 @@
+#ifndef NDNFIT_DSU_WORKER_POOL_HPP
+#define NDNFIT_DSU_WORKER_POOL_HPP
+
+#include <ndn-cxx/common.hpp>
+#include <boost/asio/io_service.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+
+        /**
+         * @brief Runs jobs on worker threads and hands them back to an io_service in batches
+         *
+         * post() only queues the job. A worker takes up to @p maxBatch queued jobs at a time,
+         * runs them through its processor, and posts the whole batch back to @p ioService,
+         * where @p deliver runs. Every worker makes its own processor, on its own thread, with
+         * @p makeProcessor, so that what is not thread-safe (a KeyChain) is not shared. With
+         * zero threads a single processor is made up front, and the job is processed and
+         * delivered before post() returns.
+         *
+         * @p deliver may run after the pool is gone, it must not refer to its owner.
+         */
+        template<typename Job>
+        class WorkerPool : noncopyable
+        {
+        public:
+            typedef std::vector<Job> Batch;
+            typedef function<void(Batch& batch)> Processor;
+            typedef function<Processor()> ProcessorFactory;
+            typedef function<void(Batch& batch)> DeliverCallback;
+
+            WorkerPool(boost::asio::io_service& ioService, size_t nThreads, size_t maxBatch,
+                       const ProcessorFactory& makeProcessor, const DeliverCallback& deliver)
+            : m_ioService(ioService)
+            , m_maxBatch(std::max<size_t>(1, maxBatch))
+            , m_makeProcessor(makeProcessor)
+            , m_deliver(deliver)
+            , m_isStopping(false)
+            {
+                if (nThreads == 0) {
+                    m_processor = m_makeProcessor();
+                }
+                for (size_t i = 0; i < nThreads; i++) {
+                    m_threads.push_back(std::thread(&WorkerPool::work, this));
+                }
+            }
+
+            ~WorkerPool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_isStopping = true;
+                }
+                m_condition.notify_all();
+                for (size_t i = 0; i < m_threads.size(); i++) {
+                    m_threads[i].join();
+                }
+            }
+
+            void
+            post(const Job& job)
+            {
+                if (m_threads.empty()) {
+                    Batch batch(1, job);
+                    m_processor(batch);
+                    m_deliver(batch);
+                    return;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_queue.push_back(job);
+                }
+                m_condition.notify_one();
+            }
+
+            size_t
+            getThreadCount() const
+            {
+                return m_threads.size();
+            }
+
+        private:
+            void
+            work()
+            {
+                Processor processor = m_makeProcessor();
+
+                while (true) {
+                    shared_ptr<Batch> batch = make_shared<Batch>();
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_condition.wait(lock, [this] { return m_isStopping || !m_queue.empty(); });
+                        if (m_isStopping) {
+                            return;
+                        }
+                        size_t nJobs = std::min(m_queue.size(), m_maxBatch);
+                        batch->assign(m_queue.begin(), m_queue.begin() + nJobs);
+                        m_queue.erase(m_queue.begin(), m_queue.begin() + nJobs);
+                    }
+
+                    processor(*batch);
+                    DeliverCallback deliver = m_deliver;
+                    m_ioService.post([deliver, batch] { deliver(*batch); });
+                }
+            }
+
+        private:
+            boost::asio::io_service& m_ioService;
+            size_t m_maxBatch;
+            ProcessorFactory m_makeProcessor;
+            DeliverCallback m_deliver;
+            // used when there are no worker threads
+            Processor m_processor;
+
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            std::deque<Job> m_queue;
+            bool m_isStopping;
+            std::vector<std::thread> m_threads;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_WORKER_POOL_HPP
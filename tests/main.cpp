@@ -0,0 +1,4 @@
+#define BOOST_TEST_DYN_LINK 1
+#define BOOST_TEST_MODULE ndnfit-dsu Tests
+
+#include <boost/test/unit_test.hpp>
@@ -0,0 +1,127 @@
+/**
+ * ConsistentHashRing: every instance computes the same owner from the same members, in
+ * whatever order they are listed, and a member joining or leaving moves only the users it
+ * takes or gives up, a minority of them.
+ */
+
+#include "consistent-hash-ring.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            static const size_t N_USERS = 10000;
+
+            static std::vector<name::Component>
+            makeUsers()
+            {
+                std::vector<name::Component> users;
+                for (size_t i = 0; i < N_USERS; i++) {
+                    users.push_back(name::Component("user" + std::to_string(i)));
+                }
+                return users;
+            }
+
+            static std::vector<std::string>
+            getOwners(const ConsistentHashRing& ring, const std::vector<name::Component>& users)
+            {
+                std::vector<std::string> owners;
+                for (size_t i = 0; i < users.size(); i++) {
+                    owners.push_back(ring.getOwner(users[i]));
+                }
+                return owners;
+            }
+
+            BOOST_AUTO_TEST_SUITE(TestConsistentHashRing)
+
+            BOOST_AUTO_TEST_CASE(MemberOrder)
+            {
+                std::vector<name::Component> users = makeUsers();
+                std::vector<std::string> members = {"dsu-a", "dsu-b", "dsu-c", "dsu-d"};
+                ConsistentHashRing ring(members);
+                std::vector<std::string> owners = getOwners(ring, users);
+
+                // every order of the members file, with a member listed twice
+                std::sort(members.begin(), members.end());
+                do {
+                    std::vector<std::string> listed = members;
+                    listed.push_back(members[1]);
+                    ConsistentHashRing other(listed);
+                    BOOST_REQUIRE(other.getMembers() == ring.getMembers());
+                    BOOST_REQUIRE(getOwners(other, users) == owners);
+                } while (std::next_permutation(members.begin(), members.end()));
+
+                // everybody gets a share
+                std::map<std::string, size_t> shares;
+                for (size_t i = 0; i < owners.size(); i++) {
+                    shares[owners[i]]++;
+                }
+                BOOST_REQUIRE_EQUAL(shares.size(), 4);
+                for (std::map<std::string, size_t>::iterator it = shares.begin(); it != shares.end(); ++it) {
+                    BOOST_CHECK_GT(it->second, N_USERS / 8);
+                    BOOST_CHECK(ring.isOwner(it->first, users[0]) == (owners[0] == it->first));
+                }
+                BOOST_CHECK(ring.hasMember("dsu-a"));
+                BOOST_CHECK(!ring.hasMember("dsu-e"));
+            }
+
+            BOOST_AUTO_TEST_CASE(Join)
+            {
+                std::vector<name::Component> users = makeUsers();
+                std::vector<std::string> before = getOwners(ConsistentHashRing({"dsu-a", "dsu-b", "dsu-c"}), users);
+                std::vector<std::string> after = getOwners(ConsistentHashRing({"dsu-a", "dsu-b", "dsu-c", "dsu-d"}),
+                                                           users);
+
+                // the users that move all go to the new member, and the others stay
+                size_t nMoved = 0;
+                for (size_t i = 0; i < users.size(); i++) {
+                    if (after[i] != before[i]) {
+                        BOOST_REQUIRE_EQUAL(after[i], "dsu-d");
+                        nMoved++;
+                    }
+                }
+                // about a quarter
+                BOOST_CHECK_GT(nMoved, N_USERS / 8);
+                BOOST_CHECK_LT(nMoved, N_USERS * 3 / 8);
+            }
+
+            BOOST_AUTO_TEST_CASE(Leave)
+            {
+                std::vector<name::Component> users = makeUsers();
+                std::vector<std::string> before = getOwners(ConsistentHashRing({"dsu-a", "dsu-b", "dsu-c"}), users);
+                std::vector<std::string> after = getOwners(ConsistentHashRing({"dsu-a", "dsu-c"}), users);
+
+                // only the users of the member that left move
+                size_t nMoved = 0;
+                for (size_t i = 0; i < users.size(); i++) {
+                    if (before[i] == "dsu-b") {
+                        BOOST_REQUIRE_NE(after[i], "dsu-b");
+                        nMoved++;
+                    } else {
+                        BOOST_REQUIRE_EQUAL(after[i], before[i]);
+                    }
+                }
+                // about a third
+                BOOST_CHECK_GT(nMoved, N_USERS / 6);
+                BOOST_CHECK_LT(nMoved, N_USERS / 2);
+
+                // down to one member, which owns everybody
+                ConsistentHashRing single({"dsu-c"});
+                for (size_t i = 0; i < users.size(); i++) {
+                    BOOST_REQUIRE(single.isOwner("dsu-c", users[i]));
+                }
+                ConsistentHashRing empty({});
+                BOOST_CHECK(!empty.isOwner("dsu-c", users[0]));
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,230 @@
+/**
+ * SegmentedContentParser against parseCatalog() and parseUpdateInfo(): every document is
+ * split in two at every byte offset, and fed one byte at a time, and must be accepted or
+ * rejected as the single-packet parser does, with the same entries.
+ */
+
+#include "content-parser.hpp"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            typedef SegmentedContentParser::Schema Schema;
+
+            class RecordingVisitor : public ContentVisitor
+            {
+            public:
+                virtual void
+                onCatalogEntry(uint64_t timepoint, uint64_t version)
+                {
+                    entries.push_back(std::make_pair(timepoint, version));
+                }
+
+                virtual void
+                onDatapoint(uint64_t timepoint)
+                {
+                    entries.push_back(std::make_pair(timepoint, 0));
+                }
+
+                std::vector<std::pair<uint64_t, uint64_t>> entries;
+            };
+
+            static Block
+            makeContent(const std::string& document, size_t begin, size_t end)
+            {
+                return makeBinaryBlock(tlv::Content, reinterpret_cast<const uint8_t*>(document.data()) + begin,
+                                       end - begin);
+            }
+
+            static bool
+            parseWhole(Schema schema, const std::string& document, RecordingVisitor& visitor)
+            {
+                Block content = makeContent(document, 0, document.size());
+                if (schema == SegmentedContentParser::CATALOG) {
+                    return parseCatalog(content, visitor);
+                }
+                return parseUpdateInfo(content, visitor);
+            }
+
+            // feed @p document cut at the given offsets, in order
+            static bool
+            parseSegments(Schema schema, const std::string& document, const std::vector<size_t>& cuts,
+                          RecordingVisitor& visitor)
+            {
+                SegmentedContentParser parser(schema);
+                size_t begin = 0;
+                for (size_t i = 0; i <= cuts.size(); i++) {
+                    size_t end = i < cuts.size() ? cuts[i] : document.size();
+                    if (!parser.feed(makeContent(document, begin, end), visitor)) {
+                        return false;
+                    }
+                    begin = end;
+                }
+                return parser.finish();
+            }
+
+            static void
+            checkSplits(Schema schema, const std::string& document, bool isValid,
+                        const std::vector<std::pair<uint64_t, uint64_t>>& entries)
+            {
+                for (size_t offset = 0; offset <= document.size(); offset++) {
+                    RecordingVisitor visitor;
+                    bool isSplitValid = parseSegments(schema, document, std::vector<size_t>(1, offset), visitor);
+                    BOOST_CHECK_MESSAGE(isSplitValid == isValid, document.substr(0, 80) << " split at " << offset);
+                    if (isValid && isSplitValid) {
+                        BOOST_CHECK_MESSAGE(visitor.entries == entries, document.substr(0, 80) << " split at " << offset);
+                    }
+                }
+
+                std::vector<size_t> everyByte;
+                for (size_t offset = 1; offset < document.size(); offset++) {
+                    everyByte.push_back(offset);
+                }
+                RecordingVisitor visitor;
+                bool isSplitValid = parseSegments(schema, document, everyByte, visitor);
+                BOOST_CHECK_MESSAGE(isSplitValid == isValid, document.substr(0, 80) << " fed byte by byte");
+                if (isValid && isSplitValid) {
+                    BOOST_CHECK_MESSAGE(visitor.entries == entries, document.substr(0, 80) << " fed byte by byte");
+                }
+            }
+
+            static void
+            checkSameAsWhole(Schema schema, const std::string& document)
+            {
+                RecordingVisitor visitor;
+                bool isValid = parseWhole(schema, document, visitor);
+                checkSplits(schema, document, isValid, visitor.entries);
+            }
+
+            BOOST_AUTO_TEST_SUITE(TestContentParser)
+
+            BOOST_AUTO_TEST_CASE(Catalog)
+            {
+                static const char* DOCUMENTS[] = {
+                    "[]",
+                    "[1456000000000000]",
+                    " [ 1456000000000000 ,\n\t1456000001000000 , 0 ]\r\n",
+                    "[18446744073709551615]",
+                    "[18446744073709551616]",
+                    "[-0]",
+                    "[-1]",
+                    "[0, -9223372036854775808]",
+                    "[-9223372036854775809]",
+                    "[1.5]",
+                    "[1e3]",
+                    "[1E+3, 2]",
+                    "[01]",
+                    "[1.]",
+                    "[-]",
+                    "[1,]",
+                    "[,1]",
+                    "[1 2]",
+                    "[1",
+                    "[",
+                    "",
+                    " ",
+                    "1",
+                    "[1]x",
+                    "[1] [2]",
+                    "[true]",
+                    "[null]",
+                    "[nul]",
+                    "[\"1\"]",
+                    "[[1]]",
+                    "{}",
+                    "[{}]",
+                };
+                for (size_t i = 0; i < sizeof(DOCUMENTS) / sizeof(DOCUMENTS[0]); i++) {
+                    checkSameAsWhole(SegmentedContentParser::CATALOG, DOCUMENTS[i]);
+                }
+            }
+
+            BOOST_AUTO_TEST_CASE(UpdateInfo)
+            {
+                static const char* DOCUMENTS[] = {
+                    "[]",
+                    "[{\"timepoint\": 1456000000000000, \"version\": 1456000000000001}]",
+                    "[ {\"version\":2,\"timepoint\":1} ,\n {\"timepoint\":3,\"version\":4} ]",
+                    // unknown members of every kind are skipped
+                    "[{\"timepoint\":1,\"note\":\"x\",\"flag\":true,\"none\":null,\"ratio\":-1.5e-3,\"version\":2}]",
+                    // escapes, in values and keys
+                    "[{\"note\":\"a \\\"quoted\\\" \\\\ back\\/slash\\b\\f\\n\\r\\t\",\"timepoint\":1,\"version\":2}]",
+                    "[{\"note\":\"\\u00e9\\u20AC\\ud83d\\ude00\\u0000\",\"timepoint\":1,\"version\":2}]",
+                    "[{\"time\\u0070oint\":1,\"\\u0076ersion\":2}]",
+                    "[{\"timepoint\\\"\":7,\"timepoint\":1,\"version\":2}]",
+                    "[{\"timepoint\":1,\"version\":2,\"\\\\\":\"\\\\\"}]",
+                    "[{\"timepoint\":1,\"version\":2,\"note\":\"\\x\"}]",
+                    "[{\"timepoint\":1,\"version\":2,\"note\":\"\\u12\"}]",
+                    "[{\"timepoint\":1,\"version\":2,\"note\":\"\\u12g4\"}]",
+                    "[{\"timepoint\":1,\"version\":2,\"note\":\"\\ud800\"}]",
+                    "[{\"timepoint\":1,\"version\":2,\"note\":\"\\ud800\\u0041\"}]",
+                    "[{\"timepoint\":1,\"version\":2,\"note\":\"a\tb\"}]",
+                    "[{\"timepoint\":1,\"version\":2,\"note\":\"a\\",
+                    // negative numbers
+                    "[{\"timepoint\":-1,\"version\":2}]",
+                    "[{\"timepoint\":-0,\"version\":2}]",
+                    "[{\"timepoint\":1,\"version\":-9223372036854775808}]",
+                    "[{\"timepoint\":1,\"version\":2,\"offset\":-42}]",
+                    // schema violations
+                    "[{\"timepoint\":1}]",
+                    "[{\"timepoint\":1,\"version\":\"2\"}]",
+                    "[{\"timepoint\":1,\"version\":2,\"nested\":{}}]",
+                    "[{\"timepoint\":1,\"version\":2,\"list\":[1]}]",
+                    "[1]",
+                    "{\"timepoint\":1,\"version\":2}",
+                    // syntax errors
+                    "[{\"timepoint\":1,\"version\":2,}]",
+                    "[{\"timepoint\" 1,\"version\":2}]",
+                    "[{timepoint:1,\"version\":2}]",
+                    "[{\"timepoint\":1,\"version\":2}",
+                    "[{\"timepoint\":1,\"version\":2]}",
+                };
+                for (size_t i = 0; i < sizeof(DOCUMENTS) / sizeof(DOCUMENTS[0]); i++) {
+                    checkSameAsWhole(SegmentedContentParser::UPDATE_INFO, DOCUMENTS[i]);
+                }
+            }
+
+            BOOST_AUTO_TEST_CASE(LongTokens)
+            {
+                const size_t MAX_TOKEN_LENGTH = SegmentedContentParser::MAX_TOKEN_LENGTH;
+                std::vector<std::pair<uint64_t, uint64_t>> entries(1, std::make_pair(1, 2));
+
+                // a string as written, quotes aside, or a number, up to the limit is buffered
+                std::string longest(MAX_TOKEN_LENGTH, 'x');
+                checkSameAsWhole(SegmentedContentParser::UPDATE_INFO,
+                                 "[{\"timepoint\":1,\"version\":2,\"note\":\"" + longest + "\"}]");
+                checkSameAsWhole(SegmentedContentParser::UPDATE_INFO,
+                                 "[{\"timepoint\":1,\"version\":2,\"" + longest + "\":0}]");
+                checkSameAsWhole(SegmentedContentParser::UPDATE_INFO,
+                                 "[{\"timepoint\":1,\"version\":2,\"note\":\"\\n" + longest.substr(2) + "\"}]");
+                checkSameAsWhole(SegmentedContentParser::UPDATE_INFO,
+                                 "[{\"timepoint\":1,\"version\":2,\"ratio\":1." +
+                                 std::string(MAX_TOKEN_LENGTH - 2, '5') + "}]");
+
+                // one more character is refused, wherever the document is cut
+                std::vector<std::string> documents;
+                documents.push_back("[{\"timepoint\":1,\"version\":2,\"note\":\"" + longest + "x\"}]");
+                documents.push_back("[{\"timepoint\":1,\"version\":2,\"" + longest + "x\":0}]");
+                documents.push_back("[{\"timepoint\":1,\"version\":2,\"note\":\"\\n" + longest.substr(1) + "\"}]");
+                documents.push_back("[{\"timepoint\":1,\"version\":2,\"ratio\":1." +
+                                    std::string(MAX_TOKEN_LENGTH - 1, '5') + "}]");
+                for (size_t i = 0; i < documents.size(); i++) {
+                    RecordingVisitor visitor;
+                    BOOST_REQUIRE(parseWhole(SegmentedContentParser::UPDATE_INFO, documents[i], visitor));
+                    BOOST_REQUIRE(visitor.entries == entries);
+                    checkSplits(SegmentedContentParser::UPDATE_INFO, documents[i], false, entries);
+                }
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
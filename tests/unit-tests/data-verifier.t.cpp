@@ -0,0 +1,246 @@
+/**
+ * DataVerifier: the certificate of a key is fetched once and then taken from the cache, a
+ * rejected packet is reported as transient only when its certificate could not be had, and
+ * the outcome of the packets of a key is reported in the order they were passed in, however
+ * the worker threads finish their batches.
+ */
+
+#include "data-verifier.hpp"
+#include "fake-face-endpoint.hpp"
+
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            class VerifierFixture
+            {
+            public:
+                struct Outcome
+                {
+                    Name name;
+                    bool isAccepted;
+                    std::string reason;
+                    bool isTransient;
+                };
+
+                VerifierFixture()
+                : directory(boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path("ndnfit-dsu-verifier-%%%%-%%%%"))
+                , keyChain("pib-sqlite3:" + directory.string(), "tpm-file:" + (directory / "ndnsec-tpm-file").string())
+                , alice(keyChain.createIdentity(Name("/alice")))
+                , bob(keyChain.createIdentity(Name("/bob")))
+                {
+                }
+
+                ~VerifierFixture()
+                {
+                    boost::filesystem::remove_all(directory);
+                }
+
+                // a verifier of the packets whose key is under their first name component
+                shared_ptr<DataVerifier>
+                makeVerifier(size_t nThreads, size_t maxBatch = 64)
+                {
+                    return make_shared<DataVerifier>(ref(ioService), ref(face), nThreads, 1,
+                                                     [this] (const Data& data) {
+                                                         Outcome outcome = {data.getName(), true, "", false};
+                                                         outcomes.push_back(outcome);
+                                                     },
+                                                     [this] (const Data& data, const std::string& reason,
+                                                             bool isTransient) {
+                                                         Outcome outcome = {data.getName(), false, reason, isTransient};
+                                                         outcomes.push_back(outcome);
+                                                     },
+                                                     maxBatch);
+                }
+
+                Data
+                makeData(const Name& name, const Name& certName)
+                {
+                    Data data(name);
+                    data.setContent(reinterpret_cast<const uint8_t*>("datapoint"), 9);
+                    keyChain.sign(data, security::signingByCertificate(certName));
+                    return data;
+                }
+
+                // answer the oldest certificate Interest with @p certName
+                void
+                answerCertificate(const Name& certName)
+                {
+                    BOOST_REQUIRE(!face.pending.empty());
+                    BOOST_REQUIRE(face.pending.front().interest.getName().isPrefixOf(certName));
+                    face.answerOldest(*keyChain.getCertificate(certName));
+                }
+
+                // run the io_service until every packet passed in has been reported
+                void
+                runUntilDone(const DataVerifier& verifier)
+                {
+                    while (verifier.getBacklog() > 0) {
+                        ioService.poll();
+                        ioService.reset();
+                    }
+                    ioService.poll();
+                    ioService.reset();
+                }
+
+                boost::filesystem::path directory;
+                boost::asio::io_service ioService;
+                FakeFaceEndpoint face;
+                KeyChain keyChain;
+                Name alice;
+                Name bob;
+                std::vector<Outcome> outcomes;
+            };
+
+            BOOST_FIXTURE_TEST_SUITE(TestDataVerifier, VerifierFixture)
+
+            BOOST_AUTO_TEST_CASE(CertificateCache)
+            {
+                shared_ptr<DataVerifier> verifier = makeVerifier(0);
+                // the first packet of a key fetches its certificate, those after it wait for it
+                verifier->verify(makeData("/alice/data/1", alice));
+                verifier->verify(makeData("/alice/data/2", alice));
+                BOOST_CHECK_EQUAL(verifier->getCertificateFetchCount(), 1);
+                BOOST_CHECK_EQUAL(face.pending.size(), 1);
+                BOOST_CHECK_EQUAL(verifier->getKeyCount(), 1);
+                BOOST_CHECK_EQUAL(verifier->getBacklog(), 2);
+
+                answerCertificate(alice);
+                runUntilDone(*verifier);
+                BOOST_REQUIRE_EQUAL(outcomes.size(), 2);
+                BOOST_CHECK(outcomes[0].isAccepted);
+                BOOST_CHECK(outcomes[1].isAccepted);
+
+                // cache hit: no other fetch
+                verifier->verify(makeData("/alice/data/3", alice));
+                runUntilDone(*verifier);
+                BOOST_CHECK_EQUAL(verifier->getCertificateFetchCount(), 1);
+                BOOST_CHECK(face.pending.empty());
+                BOOST_REQUIRE_EQUAL(outcomes.size(), 3);
+                BOOST_CHECK(outcomes[2].isAccepted);
+
+                // another key misses
+                verifier->verify(makeData("/bob/data/1", bob));
+                BOOST_CHECK_EQUAL(verifier->getCertificateFetchCount(), 2);
+                answerCertificate(bob);
+                runUntilDone(*verifier);
+                BOOST_CHECK_EQUAL(verifier->getKeyCount(), 2);
+
+                // a removed key is fetched again
+                verifier->removeKeys("/alice");
+                BOOST_CHECK_EQUAL(verifier->getKeyCount(), 1);
+                verifier->verify(makeData("/alice/data/4", alice));
+                BOOST_CHECK_EQUAL(verifier->getCertificateFetchCount(), 3);
+                answerCertificate(alice);
+                runUntilDone(*verifier);
+                BOOST_REQUIRE_EQUAL(outcomes.size(), 5);
+                BOOST_CHECK(outcomes[4].isAccepted);
+            }
+
+            BOOST_AUTO_TEST_CASE(Rejections)
+            {
+                shared_ptr<DataVerifier> verifier = makeVerifier(0);
+
+                // refused before any fetch: for good
+                Data unsigned_("/alice/data/1");
+                keyChain.sign(unsigned_);
+                verifier->verify(unsigned_);
+                verifier->verify(makeData("/alice/data/2", bob));
+                BOOST_CHECK_EQUAL(verifier->getCertificateFetchCount(), 0);
+                BOOST_REQUIRE_EQUAL(outcomes.size(), 2);
+                BOOST_CHECK(!outcomes[0].isAccepted);
+                BOOST_CHECK(!outcomes[0].isTransient);
+                BOOST_CHECK(!outcomes[1].isAccepted);
+                BOOST_CHECK(!outcomes[1].isTransient);
+
+                // a signature that does not match: for good
+                Data tampered = makeData("/alice/data/3", alice);
+                tampered.setContent(reinterpret_cast<const uint8_t*>("tampered"), 8);
+                verifier->verify(tampered);
+                answerCertificate(alice);
+                runUntilDone(*verifier);
+                BOOST_REQUIRE_EQUAL(outcomes.size(), 3);
+                BOOST_CHECK(!outcomes[2].isAccepted);
+                BOOST_CHECK_EQUAL(outcomes[2].reason, "bad signature");
+                BOOST_CHECK(!outcomes[2].isTransient);
+
+                // no certificate after the retries: transient, and held off without another fetch
+                verifier->verify(makeData("/bob/data/1", bob));
+                for (int i = 0; i < 3; i++) {
+                    BOOST_REQUIRE_EQUAL(face.pending.size(), 1);
+                    face.timeOutOldest();
+                }
+                BOOST_CHECK(face.pending.empty());
+                verifier->verify(makeData("/bob/data/2", bob));
+                runUntilDone(*verifier);
+                BOOST_CHECK_EQUAL(verifier->getCertificateFetchCount(), 2);
+                BOOST_REQUIRE_EQUAL(outcomes.size(), 5);
+                for (size_t i = 3; i < 5; i++) {
+                    BOOST_CHECK(!outcomes[i].isAccepted);
+                    BOOST_CHECK(outcomes[i].isTransient);
+                }
+            }
+
+            BOOST_AUTO_TEST_CASE(TrustAnchor)
+            {
+                Name anchor = keyChain.createIdentity(Name("/anchor"));
+                IdentityCertificate endorsed(*keyChain.getCertificate(alice));
+                keyChain.sign(endorsed, security::signingByCertificate(anchor));
+
+                shared_ptr<DataVerifier> verifier = makeVerifier(0);
+                verifier->setTrustAnchor(*keyChain.getCertificate(anchor));
+                // a self-signed certificate is not acceptable: transient, it may be endorsed later
+                verifier->verify(makeData("/bob/data/1", bob));
+                answerCertificate(bob);
+                verifier->verify(makeData("/alice/data/1", alice));
+                face.answerOldest(endorsed);
+                runUntilDone(*verifier);
+                BOOST_REQUIRE_EQUAL(outcomes.size(), 2);
+                BOOST_CHECK(!outcomes[0].isAccepted);
+                BOOST_CHECK(outcomes[0].isTransient);
+                BOOST_CHECK(outcomes[1].isAccepted);
+            }
+
+            BOOST_AUTO_TEST_CASE(SubmissionOrder)
+            {
+                // one packet per batch, on several threads: batches finish in any order
+                shared_ptr<DataVerifier> verifier = makeVerifier(4, 1);
+                const int N_PACKETS = 400;
+                std::vector<Name> names;
+                for (int i = 0; i < N_PACKETS; i++) {
+                    Name name("/alice/data");
+                    name.appendNumber(i);
+                    Data data = makeData(name, alice);
+                    if (i % 50 == 7) {
+                        data.setContent(reinterpret_cast<const uint8_t*>("tampered"), 8);
+                    }
+                    verifier->verify(data);
+                    names.push_back(name);
+                    if (i == 10) {
+                        // the packets before the certificate and those after it
+                        answerCertificate(alice);
+                    }
+                }
+                runUntilDone(*verifier);
+
+                BOOST_REQUIRE_EQUAL(outcomes.size(), static_cast<size_t>(N_PACKETS));
+                for (int i = 0; i < N_PACKETS; i++) {
+                    BOOST_REQUIRE_EQUAL(outcomes[i].name, names[i]);
+                    BOOST_CHECK_EQUAL(outcomes[i].isAccepted, i % 50 != 7);
+                }
+                BOOST_CHECK_EQUAL(verifier->getBacklog(), 0);
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
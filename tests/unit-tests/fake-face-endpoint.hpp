@@ -0,0 +1,70 @@
+#ifndef NDNFIT_DSU_TESTS_FAKE_FACE_ENDPOINT_HPP
+#define NDNFIT_DSU_TESTS_FAKE_FACE_ENDPOINT_HPP
+
+#include "face-endpoint.hpp"
+
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            // keeps the expressed Interests until the test answers them, oldest first
+            class FakeFaceEndpoint : public FaceEndpoint
+            {
+            public:
+                struct Expressed
+                {
+                    Interest interest;
+                    OnData onData;
+                    OnTimeout onTimeout;
+                };
+
+                virtual void
+                expressInterest(const Interest& interest, const OnData& onData, const OnTimeout& onTimeout)
+                {
+                    Expressed expressed = {interest, onData, onTimeout};
+                    pending.push_back(expressed);
+                    users.push_back(interest.getName().get(0).toUri());
+                }
+
+                virtual void
+                put(const Data& data)
+                {
+                }
+
+                void
+                answerOldest()
+                {
+                    answerOldest(Data(pending.front().interest.getName()));
+                }
+
+                void
+                answerOldest(const Data& data)
+                {
+                    Expressed expressed = pending.front();
+                    pending.pop_front();
+                    Data reply(data);
+                    expressed.onData(expressed.interest, reply);
+                }
+
+                void
+                timeOutOldest()
+                {
+                    Expressed expressed = pending.front();
+                    pending.pop_front();
+                    expressed.onTimeout(expressed.interest);
+                }
+
+                std::deque<Expressed> pending;
+                // the first name component of every Interest expressed, in order: the user in the tests
+                std::vector<std::string> users;
+            };
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
+
+#endif // NDNFIT_DSU_TESTS_FAKE_FACE_ENDPOINT_HPP
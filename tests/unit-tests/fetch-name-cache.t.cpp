@@ -0,0 +1,163 @@
+/**
+ * FetchNameCache: the names and Interests it writes by hand are byte for byte those ndn-cxx
+ * encodes, for the three kinds of fetch, numbers at every width, lifetimes with and without
+ * the default, and user_ids long enough to take the names and Interests across the 1, 3 and
+ * 5 byte TLV lengths.
+ */
+
+#include "fetch-name-cache.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            static const Name COMMON_PREFIX("/org/openmhealth");
+            static const Name DATA_SUFFIX("/data/fitness/physical_activity/time_location");
+
+            // the name of @p key, put together with the Name API
+            static Name
+            makeExpectedName(const name::Component& user, const FetchKey& key)
+            {
+                Name name(COMMON_PREFIX);
+                name.append(user).append(DATA_SUFFIX);
+                switch (key.kind) {
+                    case FETCH_UPDATE_INFO:
+                        name.append("update_info").appendSequenceNumber(key.id);
+                        break;
+                    case FETCH_CATALOG:
+                        name.append("catalog")
+                            .append(name::Component::fromNumberWithMarker(0xFC, key.id * 1000))
+                            .appendVersion(key.version);
+                        break;
+                    default:
+                        name.append(name::Component::fromNumberWithMarker(0xFC, key.id * 1000));
+                        break;
+                }
+                return name;
+            }
+
+            static name::Component
+            makeUser(size_t length)
+            {
+                std::string user(length, 'u');
+                return name::Component(reinterpret_cast<const uint8_t*>(user.data()), user.size());
+            }
+
+            // the first byte of the TLV length: below 253, or 253 and 254 for 2 and 4 more bytes
+            static int
+            getLengthEncoding(const Block& block)
+            {
+                return block.wire()[1] < 253 ? 0 : block.wire()[1];
+            }
+
+            // checks the name and the Interest made for @p key against what ndn-cxx encodes
+            static void
+            checkFetch(FetchNameCache& cache, const name::Component& user, const FetchKey& key,
+                       const time::milliseconds& lifetime)
+            {
+                Name expectedName = makeExpectedName(user, key);
+                Name name = cache.makeName(user, key);
+                BOOST_REQUIRE(name == expectedName);
+                const Block& nameWire = name.wireEncode();
+                const Block& expectedNameWire = expectedName.wireEncode();
+                BOOST_REQUIRE_EQUAL_COLLECTIONS(nameWire.wire(), nameWire.wire() + nameWire.size(),
+                                                expectedNameWire.wire(), expectedNameWire.wire() + expectedNameWire.size());
+
+                Interest interest = cache.makeInterest(name, lifetime);
+                BOOST_REQUIRE(interest.getName() == expectedName);
+                BOOST_REQUIRE(interest.getMustBeFresh());
+                BOOST_REQUIRE_EQUAL(interest.getInterestLifetime().count(), lifetime.count());
+
+                Interest expected(expectedName);
+                expected.setMustBeFresh(true);
+                expected.setInterestLifetime(lifetime);
+                expected.setNonce(interest.getNonce());
+                const Block& wire = interest.wireEncode();
+                const Block& expectedWire = expected.wireEncode();
+                BOOST_REQUIRE_EQUAL_COLLECTIONS(wire.wire(), wire.wire() + wire.size(),
+                                                expectedWire.wire(), expectedWire.wire() + expectedWire.size());
+            }
+
+            BOOST_AUTO_TEST_SUITE(TestFetchNameCache)
+
+            BOOST_AUTO_TEST_CASE(Numbers)
+            {
+                FetchNameCache cache(COMMON_PREFIX, DATA_SUFFIX);
+                name::Component alice("alice");
+                // around every width of a NonNegativeInteger, for the ids and the timestamps made from them
+                const uint64_t NUMBERS[] = {0, 1, 0xFF, 0x100, 0xFFFF, 0x10000, 4294967, 4294968, 0xFFFFFFFF,
+                                            0x100000000ULL, 1456000000000ULL, 0xFFFFFFFFFFFFULL};
+                const size_t N_NUMBERS = sizeof(NUMBERS) / sizeof(NUMBERS[0]);
+                const time::milliseconds LIFETIMES[] = {time::milliseconds(0), time::milliseconds(200),
+                                                        time::milliseconds(255), time::milliseconds(256),
+                                                        DEFAULT_INTEREST_LIFETIME, time::milliseconds(65535),
+                                                        time::milliseconds(65536), time::milliseconds(100000)};
+
+                for (size_t i = 0; i < N_NUMBERS; i++) {
+                    const time::milliseconds& lifetime = LIFETIMES[i % 8];
+                    checkFetch(cache, alice, FetchKey(FETCH_UPDATE_INFO, NUMBERS[i]), lifetime);
+                    checkFetch(cache, alice, FetchKey(FETCH_DATAPOINT, NUMBERS[i]), lifetime);
+                    for (size_t j = 0; j < N_NUMBERS; j++) {
+                        checkFetch(cache, alice, FetchKey(FETCH_CATALOG, NUMBERS[i], NUMBERS[j]), LIFETIMES[j % 8]);
+                    }
+                }
+                for (size_t i = 0; i < 8; i++) {
+                    checkFetch(cache, alice, FetchKey(FETCH_DATAPOINT, 1456000000000ULL), LIFETIMES[i]);
+                }
+
+                // the default lifetime is left out, as ndn-cxx does
+                Interest interest = cache.makeInterest(cache.makeName(alice, FetchKey(FETCH_UPDATE_INFO, 1)),
+                                                       DEFAULT_INTEREST_LIFETIME);
+                Interest longer = cache.makeInterest(cache.makeName(alice, FetchKey(FETCH_UPDATE_INFO, 1)),
+                                                     time::milliseconds(4001));
+                BOOST_CHECK_EQUAL(longer.wireEncode().size(), interest.wireEncode().size() + 4);
+            }
+
+            BOOST_AUTO_TEST_CASE(LongUsers)
+            {
+                FetchNameCache cache(COMMON_PREFIX, DATA_SUFFIX);
+                std::set<int> nameEncodings;
+                std::set<int> interestEncodings;
+                std::set<int> userEncodings;
+                // user_ids whose components, names and Interests cross 253 and 65536 bytes
+                std::vector<size_t> lengths;
+                for (size_t length = 150; length < 260; length++) {
+                    lengths.push_back(length);
+                }
+                for (size_t length = 65400; length < 65545; length++) {
+                    lengths.push_back(length);
+                }
+
+                for (size_t i = 0; i < lengths.size(); i++) {
+                    name::Component user = makeUser(lengths[i]);
+                    time::milliseconds lifetime = i % 2 == 0 ? DEFAULT_INTEREST_LIFETIME : time::milliseconds(1000);
+                    checkFetch(cache, user, FetchKey(FETCH_UPDATE_INFO, 7), lifetime);
+                    checkFetch(cache, user, FetchKey(FETCH_CATALOG, 1456000000000ULL, 2), lifetime);
+                    checkFetch(cache, user, FetchKey(FETCH_DATAPOINT, 1456000000000ULL), lifetime);
+
+                    Name name = cache.makeName(user, FetchKey(FETCH_UPDATE_INFO, 7));
+                    userEncodings.insert(getLengthEncoding(user));
+                    nameEncodings.insert(getLengthEncoding(name.wireEncode()));
+                    interestEncodings.insert(getLengthEncoding(cache.makeInterest(name, lifetime).wireEncode()));
+                    cache.removeUser(user);
+                }
+                BOOST_CHECK_EQUAL(cache.getUserCount(), 0);
+
+                // every length encoding was gone through
+                const int ENCODINGS[] = {0, 253, 254};
+                BOOST_CHECK_EQUAL_COLLECTIONS(userEncodings.begin(), userEncodings.end(), ENCODINGS, ENCODINGS + 3);
+                BOOST_CHECK_EQUAL_COLLECTIONS(nameEncodings.begin(), nameEncodings.end(), ENCODINGS, ENCODINGS + 3);
+                BOOST_CHECK_EQUAL_COLLECTIONS(interestEncodings.begin(), interestEncodings.end(),
+                                              ENCODINGS, ENCODINGS + 3);
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
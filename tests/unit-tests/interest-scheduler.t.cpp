@@ -0,0 +1,147 @@
+/**
+ * InterestScheduler: a user with a large backlog gets the same share of the Face as a light
+ * one, the window of each user caps what it has in flight, and a loss episode halves the
+ * window once.
+ */
+
+#include "interest-scheduler.hpp"
+#include "fake-face-endpoint.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            // queue @p n Interests for @p user, counting the replies in @p nData
+            static void
+            expressMany(InterestScheduler& scheduler, const std::string& user, int n, int& nData)
+            {
+                for (int i = 0; i < n; i++) {
+                    Name name(user);
+                    name.appendNumber(i);
+                    scheduler.express(name::Component(user), Interest(name),
+                                      [&nData] (const Interest&, const Data&, const time::steady_clock::TimePoint&) {
+                                          nData++;
+                                      },
+                                      [] (const Interest&, const time::steady_clock::TimePoint&) {});
+                }
+            }
+
+            BOOST_AUTO_TEST_SUITE(TestInterestScheduler)
+
+            BOOST_AUTO_TEST_CASE(Fairness)
+            {
+                FakeFaceEndpoint face;
+                // windows out of the way, only the global cap and the quantum matter
+                InterestScheduler scheduler(face, 4, 64, 64, 2);
+                int nHeavyData = 0;
+                int nLightData = 0;
+                expressMany(scheduler, "heavy", 100, nHeavyData);
+                expressMany(scheduler, "light", 8, nLightData);
+
+                BOOST_CHECK_EQUAL(scheduler.getInFlight(), 4);
+                BOOST_CHECK_EQUAL(scheduler.getQueued(), 104);
+                BOOST_CHECK_EQUAL(scheduler.getQueueDepth(name::Component("heavy")), 96);
+                BOOST_CHECK_EQUAL(scheduler.getQueueDepth(name::Component("light")), 8);
+
+                // the light user queued behind 96 Interests, yet takes turns with the heavy one
+                while (!face.pending.empty()) {
+                    face.answerOldest();
+                }
+                BOOST_CHECK_EQUAL(nHeavyData, 100);
+                BOOST_CHECK_EQUAL(nLightData, 8);
+                BOOST_CHECK_EQUAL(scheduler.getInFlight(), 0);
+                BOOST_CHECK_EQUAL(scheduler.getQueued(), 0);
+
+                BOOST_REQUIRE_EQUAL(face.users.size(), 108);
+                std::vector<std::string> turns(face.users.begin() + 4, face.users.begin() + 20);
+                std::vector<std::string> expected;
+                for (int i = 0; i < 4; i++) {
+                    expected.push_back("heavy");
+                    expected.push_back("heavy");
+                    expected.push_back("light");
+                    expected.push_back("light");
+                }
+                BOOST_CHECK_EQUAL_COLLECTIONS(turns.begin(), turns.end(), expected.begin(), expected.end());
+            }
+
+            BOOST_AUTO_TEST_CASE(UnusedTurns)
+            {
+                FakeFaceEndpoint face;
+                InterestScheduler scheduler(face, 2, 64, 64, 4);
+                int nData = 0;
+                expressMany(scheduler, "heavy", 20, nData);
+                expressMany(scheduler, "light", 1, nData);
+
+                // a user with less than its quantum queued does not keep the rest for later
+                while (!face.pending.empty()) {
+                    face.answerOldest();
+                }
+                BOOST_REQUIRE_EQUAL(face.users.size(), 21);
+                BOOST_CHECK_EQUAL(face.users[6], "light");
+
+                // the light user got a quantum of 4 and used 1; its next turn is 4 again, not 7
+                expressMany(scheduler, "heavy", 8, nData);
+                expressMany(scheduler, "light", 8, nData);
+                while (!face.pending.empty()) {
+                    face.answerOldest();
+                }
+                BOOST_CHECK_EQUAL(nData, 37);
+                BOOST_REQUIRE_EQUAL(face.users.size(), 37);
+                std::vector<std::string> turns(face.users.begin() + 21, face.users.end());
+                std::vector<std::string> expected(6, "heavy");
+                expected.resize(10, "light");
+                expected.resize(12, "heavy");
+                expected.resize(16, "light");
+                BOOST_CHECK_EQUAL_COLLECTIONS(turns.begin(), turns.end(), expected.begin(), expected.end());
+            }
+
+            BOOST_AUTO_TEST_CASE(Window)
+            {
+                FakeFaceEndpoint face;
+                InterestScheduler scheduler(face, 100, 2, 8, 4);
+                name::Component alice("alice");
+                int nData = 0;
+                expressMany(scheduler, "alice", 30, nData);
+                BOOST_CHECK_EQUAL(scheduler.getInFlight(alice), 2);
+                BOOST_CHECK_EQUAL(scheduler.getQueueDepth(alice), 28);
+
+                // slow start: one more per reply
+                face.answerOldest();
+                BOOST_CHECK_EQUAL(scheduler.getWindow(alice), 3);
+                BOOST_CHECK_EQUAL(scheduler.getInFlight(alice), 3);
+                face.answerOldest();
+                face.answerOldest();
+                BOOST_CHECK_EQUAL(scheduler.getWindow(alice), 5);
+                BOOST_CHECK_EQUAL(scheduler.getInFlight(alice), 5);
+
+                // everything in flight times out: one decrease for the episode
+                size_t nInFlight = face.pending.size();
+                for (size_t i = 0; i < nInFlight; i++) {
+                    face.timeOutOldest();
+                }
+                BOOST_CHECK_EQUAL(scheduler.getWindow(alice), 2.5);
+                BOOST_CHECK_EQUAL(scheduler.getInFlight(alice), 2);
+
+                // past the threshold the window grows by one per window of replies
+                face.answerOldest();
+                BOOST_CHECK_CLOSE(scheduler.getWindow(alice), 2.5 + 1 / 2.5, 0.001);
+
+                // a timeout of an Interest sent after the decrease starts a new episode
+                face.timeOutOldest();
+                BOOST_CHECK_CLOSE(scheduler.getWindow(alice), (2.5 + 1 / 2.5) / 2, 0.001);
+
+                while (!face.pending.empty()) {
+                    face.answerOldest();
+                }
+                BOOST_CHECK_EQUAL(nData, 30 - static_cast<int>(nInFlight) - 1);
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,118 @@
+/**
+ * OutstandingInterestTable: a request for an outstanding name is merged into its Interest and
+ * gets the same Data or timeout, and a callback can express the name again, the requests of
+ * the callbacks after it then being merged into the new Interest.
+ */
+
+#include "outstanding-interest-table.hpp"
+#include "fake-face-endpoint.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            class OutstandingFixture
+            {
+            public:
+                OutstandingFixture()
+                : scheduler(face)
+                , table(scheduler)
+                , alice("alice")
+                {
+                }
+
+                // express @p name, logging the outcome as "<tag> data" or "<tag> timeout"
+                bool
+                express(const Name& name, const std::string& tag)
+                {
+                    return table.express(alice, Interest(name),
+                                         [this, tag] (const Interest&, const Data&, const time::steady_clock::TimePoint&) {
+                                             outcomes.push_back(tag + " data");
+                                         },
+                                         [this, tag] (const Interest&, const time::steady_clock::TimePoint&) {
+                                             outcomes.push_back(tag + " timeout");
+                                         });
+                }
+
+                FakeFaceEndpoint face;
+                InterestScheduler scheduler;
+                OutstandingInterestTable table;
+                name::Component alice;
+                std::vector<std::string> outcomes;
+            };
+
+            BOOST_FIXTURE_TEST_SUITE(TestOutstandingInterestTable, OutstandingFixture)
+
+            BOOST_AUTO_TEST_CASE(Merge)
+            {
+                Name name("/alice/catalog/1");
+                BOOST_CHECK(express(name, "a"));
+                BOOST_CHECK(!express(name, "b"));
+                BOOST_CHECK(!express(name, "c"));
+                BOOST_CHECK(express(Name("/alice/catalog/2"), "d"));
+                BOOST_CHECK_EQUAL(face.pending.size(), 2);
+                BOOST_CHECK_EQUAL(table.size(), 2);
+                BOOST_CHECK(table.contains(name));
+                BOOST_CHECK_EQUAL(table.getWaiterCount(name), 3);
+                BOOST_CHECK_EQUAL(table.getWaiterCount(Name("/alice/catalog/3")), 0);
+
+                // every request gets the Data, in the order they were made
+                face.answerOldest();
+                std::vector<std::string> expected = {"a data", "b data", "c data"};
+                BOOST_CHECK_EQUAL_COLLECTIONS(outcomes.begin(), outcomes.end(), expected.begin(), expected.end());
+                BOOST_CHECK(!table.contains(name));
+                BOOST_CHECK_EQUAL(table.size(), 1);
+
+                // and the timeout
+                outcomes.clear();
+                BOOST_CHECK(!express(Name("/alice/catalog/2"), "e"));
+                face.timeOutOldest();
+                expected = {"d timeout", "e timeout"};
+                BOOST_CHECK_EQUAL_COLLECTIONS(outcomes.begin(), outcomes.end(), expected.begin(), expected.end());
+                BOOST_CHECK_EQUAL(table.size(), 0);
+                BOOST_CHECK_EQUAL(scheduler.getInFlight(), 0);
+            }
+
+            BOOST_AUTO_TEST_CASE(ExpressFromCallback)
+            {
+                Name name("/alice/update_info/7");
+                std::vector<bool> isExpressed;
+                // each request asks again once after a timeout
+                for (int i = 0; i < 3; i++) {
+                    std::string tag(1, 'a' + i);
+                    table.express(alice, Interest(name),
+                                  [this, tag] (const Interest&, const Data&, const time::steady_clock::TimePoint&) {
+                                      outcomes.push_back(tag + " data");
+                                  },
+                                  [this, tag, &isExpressed] (const Interest& interest,
+                                                             const time::steady_clock::TimePoint&) {
+                                      outcomes.push_back(tag + " timeout");
+                                      isExpressed.push_back(express(interest.getName(), tag));
+                                  });
+                }
+                BOOST_CHECK_EQUAL(face.pending.size(), 1);
+
+                // the first callback expresses a new Interest, the others are merged into it
+                face.timeOutOldest();
+                BOOST_REQUIRE_EQUAL(isExpressed.size(), 3);
+                BOOST_CHECK(isExpressed[0]);
+                BOOST_CHECK(!isExpressed[1]);
+                BOOST_CHECK(!isExpressed[2]);
+                BOOST_CHECK_EQUAL(face.pending.size(), 1);
+                BOOST_CHECK_EQUAL(table.getWaiterCount(name), 3);
+
+                face.answerOldest();
+                std::vector<std::string> expected = {"a timeout", "b timeout", "c timeout", "a data", "b data", "c data"};
+                BOOST_CHECK_EQUAL_COLLECTIONS(outcomes.begin(), outcomes.end(), expected.begin(), expected.end());
+                BOOST_CHECK_EQUAL(table.size(), 0);
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,285 @@
+/**
+ * PendingFetchSet and PendingFetchTable: probe chains that wrap around the end of the slot
+ * array, backward-shift deletion anywhere in a chain, growth, and user sets looked up again
+ * after the pool they live in has grown.
+ */
+
+#include "pending-fetch-table.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            // the slot hash of pending-fetch-table.cpp, to pick keys that collide on purpose;
+            // SlotLayout checks that the keys do land where this predicts
+            static uint64_t
+            mix(uint64_t x)
+            {
+                x ^= x >> 30;
+                x *= 0xbf58476d1ce4e5b9ULL;
+                x ^= x >> 27;
+                x *= 0x94d049bb133111ebULL;
+                x ^= x >> 31;
+                return x;
+            }
+
+            static size_t
+            getHomeSlot(const FetchKey& key, size_t capacity)
+            {
+                uint64_t hash = mix(key.id ^ mix(key.version + (static_cast<uint64_t>(key.kind) << 56)));
+                return static_cast<size_t>(hash) & (capacity - 1);
+            }
+
+            // the first @p n datapoint keys, from id @p firstId on, whose home is @p slot of 8
+            static std::vector<FetchKey>
+            makeKeys(size_t slot, size_t n, uint64_t firstId = 0)
+            {
+                std::vector<FetchKey> keys;
+                for (uint64_t id = firstId; keys.size() < n; id++) {
+                    FetchKey key(FETCH_DATAPOINT, id);
+                    if (getHomeSlot(key, 8) == slot) {
+                        keys.push_back(key);
+                    }
+                }
+                return keys;
+            }
+
+            static std::vector<FetchKey>
+            getKeysInSlotOrder(const PendingFetchSet& set)
+            {
+                std::vector<FetchKey> keys;
+                set.forEach([&] (const FetchKey& key, int) {
+                    keys.push_back(key);
+                });
+                return keys;
+            }
+
+            // three keys at home 6, one at 7 and one at 0 fill slots 6, 7, 0, 1 and 2 of 8
+            static std::vector<FetchKey>
+            makeWrappingCluster()
+            {
+                std::vector<FetchKey> keys = makeKeys(6, 3);
+                keys.push_back(makeKeys(7, 1)[0]);
+                keys.push_back(makeKeys(0, 1)[0]);
+                return keys;
+            }
+
+            BOOST_AUTO_TEST_SUITE(TestPendingFetchTable)
+
+            BOOST_AUTO_TEST_CASE(SlotLayout)
+            {
+                std::vector<FetchKey> keys = makeWrappingCluster();
+                PendingFetchSet set;
+                for (size_t i = 0; i < keys.size(); i++) {
+                    set.insert(keys[i]);
+                }
+                BOOST_REQUIRE_EQUAL(set.getMemoryUsage(), 8 * 32);
+
+                // slot order: 0, 1, 2, then 6 and 7
+                std::vector<FetchKey> layout = getKeysInSlotOrder(set);
+                BOOST_REQUIRE_EQUAL(layout.size(), 5);
+                BOOST_CHECK(layout[0] == keys[2]);
+                BOOST_CHECK(layout[1] == keys[3]);
+                BOOST_CHECK(layout[2] == keys[4]);
+                BOOST_CHECK(layout[3] == keys[0]);
+                BOOST_CHECK(layout[4] == keys[1]);
+            }
+
+            BOOST_AUTO_TEST_CASE(WrapAround)
+            {
+                std::vector<FetchKey> keys = makeWrappingCluster();
+                // homes inside the cluster, whose probes run through it without a match
+                uint64_t nextId = 0;
+                for (size_t i = 0; i < keys.size(); i++) {
+                    nextId = std::max(nextId, keys[i].id + 1);
+                }
+                std::vector<FetchKey> absent = makeKeys(6, 2, nextId);
+                absent.push_back(makeKeys(0, 1, nextId)[0]);
+                absent.push_back(makeKeys(1, 1, nextId)[0]);
+
+                PendingFetchSet set;
+                for (size_t i = 0; i < keys.size(); i++) {
+                    set.insert(keys[i], 100 + i) = static_cast<int>(i) + 1;
+                }
+                for (size_t i = 0; i < keys.size(); i++) {
+                    BOOST_REQUIRE(set.find(keys[i]) != 0);
+                    BOOST_CHECK_EQUAL(*set.find(keys[i]), static_cast<int>(i) + 1);
+                }
+                for (size_t i = 0; i < absent.size(); i++) {
+                    BOOST_CHECK(set.find(absent[i]) == 0);
+                    BOOST_CHECK(!set.erase(absent[i]));
+                }
+                BOOST_CHECK_EQUAL(set.size(), keys.size());
+
+                // inserting again keeps the retry counter and takes the new insertion time
+                BOOST_CHECK_EQUAL(set.insert(keys[1], 200), 2);
+                std::vector<FetchKey> expired;
+                set.collectExpired(104, expired);
+                BOOST_CHECK_EQUAL(expired.size(), 3);
+                BOOST_CHECK(std::find(expired.begin(), expired.end(), keys[1]) == expired.end());
+            }
+
+            BOOST_AUTO_TEST_CASE(EraseInChain)
+            {
+                std::vector<FetchKey> keys = makeWrappingCluster();
+                std::vector<size_t> order;
+                for (size_t i = 0; i < keys.size(); i++) {
+                    order.push_back(i);
+                }
+
+                // erase in every order, so that every position of the chain is erased, with
+                // entries moved back across the end of the array before it
+                do {
+                    PendingFetchSet set;
+                    for (size_t i = 0; i < keys.size(); i++) {
+                        set.insert(keys[i]) = static_cast<int>(i) + 1;
+                    }
+                    std::vector<bool> isErased(keys.size(), false);
+                    for (size_t step = 0; step < order.size(); step++) {
+                        BOOST_REQUIRE(set.erase(keys[order[step]]));
+                        BOOST_REQUIRE(!set.erase(keys[order[step]]));
+                        isErased[order[step]] = true;
+                        BOOST_REQUIRE_EQUAL(set.size(), keys.size() - step - 1);
+
+                        for (size_t i = 0; i < keys.size(); i++) {
+                            int* retries = set.find(keys[i]);
+                            if (isErased[i]) {
+                                BOOST_REQUIRE(retries == 0);
+                            } else {
+                                BOOST_REQUIRE(retries != 0);
+                                BOOST_REQUIRE_EQUAL(*retries, static_cast<int>(i) + 1);
+                            }
+                        }
+                    }
+                    // an emptied set gives its slots back
+                    BOOST_REQUIRE_EQUAL(set.getMemoryUsage(), 0);
+                } while (std::next_permutation(order.begin(), order.end()));
+            }
+
+            BOOST_AUTO_TEST_CASE(Growth)
+            {
+                PendingFetchSet set;
+                BOOST_CHECK_EQUAL(set.getMemoryUsage(), 0);
+
+                std::vector<FetchKey> keys;
+                for (uint64_t i = 0; i < 1000; i++) {
+                    keys.push_back(FetchKey(i % 2 == 0 ? FETCH_CATALOG : FETCH_DATAPOINT, 1456000000000 + i * 1000,
+                                            i % 2 == 0 ? i : 0));
+                }
+                size_t capacity = 0;
+                for (size_t i = 0; i < keys.size(); i++) {
+                    set.insert(keys[i], static_cast<uint32_t>(i)) = static_cast<int>(i);
+                    size_t newCapacity = set.getMemoryUsage() / 32;
+                    // powers of two, kept at most three quarters full
+                    BOOST_REQUIRE_EQUAL(newCapacity & (newCapacity - 1), 0);
+                    BOOST_REQUIRE_LE(set.size() * 4, newCapacity * 3);
+                    BOOST_REQUIRE_GE(newCapacity, capacity);
+                    capacity = newCapacity;
+                }
+                BOOST_CHECK_EQUAL(set.size(), keys.size());
+                BOOST_CHECK_EQUAL(capacity, 2048);
+
+                // entries keep their retry counters and insertion times across every growth
+                for (size_t i = 0; i < keys.size(); i++) {
+                    BOOST_REQUIRE(set.find(keys[i]) != 0);
+                    BOOST_CHECK_EQUAL(*set.find(keys[i]), static_cast<int>(i));
+                }
+                size_t nVisited = 0;
+                set.forEachInsertion([&] (const FetchKey& key, uint32_t insertedAt) {
+                    BOOST_CHECK(keys[insertedAt] == key);
+                    nVisited++;
+                });
+                BOOST_CHECK_EQUAL(nVisited, keys.size());
+
+                std::vector<FetchKey> expired;
+                set.collectExpired(10, expired);
+                BOOST_CHECK_EQUAL(expired.size(), 10);
+
+                for (size_t i = 0; i < keys.size(); i += 2) {
+                    BOOST_REQUIRE(set.erase(keys[i]));
+                }
+                for (size_t i = 0; i < keys.size(); i++) {
+                    BOOST_REQUIRE_EQUAL(set.find(keys[i]) != 0, i % 2 == 1);
+                }
+            }
+
+            BOOST_AUTO_TEST_CASE(UsersAfterGrowth)
+            {
+                PendingFetchTable table;
+                name::Component alice("alice");
+                PendingFetchSet* pending = &table.addUser(alice);
+                pending->insert(FetchKey(FETCH_CATALOG, 1000, 1), 50) = 3;
+
+                // enough users to reallocate the pool and grow the index several times
+                for (int i = 0; i < 500; i++) {
+                    table.addUser(name::Component("user" + std::to_string(i))).insert(FetchKey(FETCH_DATAPOINT, i));
+                }
+                BOOST_CHECK_EQUAL(table.getUserCount(), 501);
+                BOOST_CHECK_EQUAL(table.size(), 501);
+
+                // the set moved with the pool; it is found again with everything in it
+                pending = table.getUser(alice);
+                BOOST_REQUIRE(pending != 0);
+                BOOST_CHECK(pending == &table.addUser(alice));
+                BOOST_REQUIRE_EQUAL(pending->size(), 1);
+                BOOST_REQUIRE(pending->find(FetchKey(FETCH_CATALOG, 1000, 1)) != 0);
+                BOOST_CHECK_EQUAL(*pending->find(FetchKey(FETCH_CATALOG, 1000, 1)), 3);
+                BOOST_CHECK_EQUAL(table.getUserCount(), 501);
+
+                // a removed user's pool entry goes to the next new user, empty
+                table.removeUser(alice);
+                BOOST_CHECK(table.getUser(alice) == 0);
+                name::Component bob("bob");
+                BOOST_CHECK_EQUAL(table.addUser(bob).size(), 0);
+                BOOST_CHECK(table.getUser(alice) == 0);
+                BOOST_CHECK_EQUAL(table.getUserCount(), 501);
+            }
+
+            BOOST_AUTO_TEST_CASE(RemoveUsers)
+            {
+                PendingFetchTable table;
+                std::set<std::string> users;
+                for (int i = 0; i < 300; i++) {
+                    std::string user = "user" + std::to_string(i);
+                    table.addUser(name::Component(user)).insert(FetchKey(FETCH_DATAPOINT, i));
+                    users.insert(user);
+                }
+
+                // remove from everywhere in the index chains, re-adding some on the way
+                for (int i = 0; i < 300; i += 3) {
+                    std::string user = "user" + std::to_string((i * 7) % 300);
+                    table.removeUser(name::Component(user));
+                    users.erase(user);
+                    if (i % 2 == 0) {
+                        std::string added = "new" + std::to_string(i);
+                        table.addUser(name::Component(added)).insert(FetchKey(FETCH_DATAPOINT, 1000 + i));
+                        users.insert(added);
+                    }
+                    BOOST_REQUIRE_EQUAL(table.getUserCount(), users.size());
+                }
+
+                std::set<std::string> visited;
+                table.forEachUser([&] (const name::Component& user, const PendingFetchSet& pending) {
+                    visited.insert(std::string(reinterpret_cast<const char*>(user.value()), user.value_size()));
+                    BOOST_CHECK_EQUAL(pending.size(), 1);
+                });
+                BOOST_CHECK(visited == users);
+                for (int i = 0; i < 300; i++) {
+                    std::string user = "user" + std::to_string(i);
+                    BOOST_CHECK_EQUAL(table.hasUser(name::Component(user)), users.count(user) == 1);
+                }
+                BOOST_CHECK_EQUAL(table.size(), users.size());
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,100 @@
+/**
+ * RttEstimator: SRTT, RTTVAR and RTO after RFC 6298, the RTO clamped to its bounds, one
+ * backoff per timeout episode, and the backoff kept until a fresh RTT sample.
+ */
+
+#include "rtt-estimator.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            BOOST_AUTO_TEST_SUITE(TestRttEstimator)
+
+            BOOST_AUTO_TEST_CASE(Rfc6298)
+            {
+                RttEstimator estimator;
+                BOOST_CHECK(!estimator.hasSamples());
+                BOOST_CHECK_EQUAL(estimator.getRto().count(), 1000);
+
+                // first sample: SRTT = R, RTTVAR = R/2, RTO = SRTT + 4 RTTVAR
+                estimator.addMeasurement(time::milliseconds(100));
+                BOOST_CHECK(estimator.hasSamples());
+                BOOST_CHECK_EQUAL(time::duration_cast<time::microseconds>(estimator.getSmoothedRtt()).count(), 100000);
+                BOOST_CHECK_EQUAL(estimator.getRto().count(), 300);
+
+                // RTTVAR = 3/4 * 50 + 1/4 * |100 - 200| = 62.5, SRTT = 7/8 * 100 + 1/8 * 200 = 112.5
+                estimator.addMeasurement(time::milliseconds(200));
+                BOOST_CHECK_EQUAL(time::duration_cast<time::microseconds>(estimator.getSmoothedRtt()).count(), 112500);
+                BOOST_CHECK_EQUAL(estimator.getRto().count(), 362);
+
+                // a steady RTT wears RTTVAR down until the RTO reaches its lower bound
+                for (int i = 0; i < 100; i++) {
+                    estimator.addMeasurement(time::milliseconds(50));
+                }
+                BOOST_CHECK_EQUAL(time::duration_cast<time::milliseconds>(estimator.getSmoothedRtt()).count(), 50);
+                BOOST_CHECK_EQUAL(estimator.getRto().count(), 200);
+
+                // and a long one hits the upper bound
+                RttEstimator bounded(time::milliseconds(1000), time::milliseconds(200), time::milliseconds(2000));
+                bounded.addMeasurement(time::milliseconds(1500));
+                BOOST_CHECK_EQUAL(bounded.getRto().count(), 2000);
+            }
+
+            BOOST_AUTO_TEST_CASE(OneBackoffPerEpisode)
+            {
+                RttEstimator estimator(time::milliseconds(1000), time::milliseconds(200), time::milliseconds(60000));
+                estimator.addMeasurement(time::milliseconds(100));
+                BOOST_REQUIRE_EQUAL(estimator.getRto().count(), 300);
+
+                // a whole window expressed before the first timeout: the RTO doubles once
+                time::steady_clock::TimePoint sentAt = time::steady_clock::now() - time::milliseconds(1);
+                estimator.onTimeout(sentAt);
+                BOOST_CHECK_EQUAL(estimator.getRto().count(), 600);
+                BOOST_CHECK_EQUAL(estimator.getBackoffCount(), 1);
+                for (int i = 0; i < 10; i++) {
+                    estimator.onTimeout(sentAt);
+                }
+                BOOST_CHECK_EQUAL(estimator.getRto().count(), 600);
+                BOOST_CHECK_EQUAL(estimator.getBackoffCount(), 1);
+
+                // an Interest retransmitted after the backoff timing out again is a new episode
+                estimator.onTimeout(time::steady_clock::now());
+                BOOST_CHECK_EQUAL(estimator.getRto().count(), 1200);
+                BOOST_CHECK_EQUAL(estimator.getBackoffCount(), 2);
+
+                // the backoff is kept until a fresh sample
+                BOOST_CHECK_EQUAL(time::duration_cast<time::milliseconds>(estimator.getSmoothedRtt()).count(), 100);
+                estimator.addMeasurement(time::milliseconds(100));
+                BOOST_CHECK_EQUAL(estimator.getBackoffCount(), 0);
+                BOOST_CHECK_LT(estimator.getRto().count(), 600);
+            }
+
+            BOOST_AUTO_TEST_CASE(BackoffBounds)
+            {
+                RttEstimator estimator(time::milliseconds(1000), time::milliseconds(200), time::milliseconds(5000));
+                // without samples the backoff starts from the initial RTO
+                estimator.onTimeout(time::steady_clock::now());
+                BOOST_CHECK_EQUAL(estimator.getRto().count(), 2000);
+                estimator.onTimeout(time::steady_clock::now());
+                estimator.onTimeout(time::steady_clock::now());
+                BOOST_CHECK_EQUAL(estimator.getRto().count(), 5000);
+                BOOST_CHECK_EQUAL(estimator.getBackoffCount(), 3);
+
+                estimator.resetBackoff();
+                BOOST_CHECK_EQUAL(estimator.getRto().count(), 1000);
+                BOOST_CHECK_EQUAL(estimator.getBackoffCount(), 0);
+
+                estimator.addMeasurement(time::milliseconds(100));
+                estimator.onTimeout(time::steady_clock::now());
+                estimator.resetBackoff();
+                BOOST_CHECK_EQUAL(estimator.getRto().count(), 300);
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
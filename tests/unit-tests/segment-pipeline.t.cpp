@@ -0,0 +1,138 @@
+/**
+ * SegmentPipeline: segments delivered in order whatever order they arrive in, and two
+ * pipelines fetching the same object through one OutstandingInterestTable both complete,
+ * sharing their Interests, through timeouts and retries.
+ */
+
+#include "segment-pipeline.hpp"
+#include "fake-face-endpoint.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            static const Name OBJECT("/alice/catalog/1");
+
+            static Data
+            makeSegment(uint64_t segmentNo, uint64_t lastSegment)
+            {
+                Data segment(Name(OBJECT).appendSegment(segmentNo));
+                segment.setFinalBlockId(name::Component::fromSegment(lastSegment));
+                return segment;
+            }
+
+            // answers the oldest Interest with its segment of an object of segments 0 to @p lastSegment
+            static void
+            answerSegment(FakeFaceEndpoint& face, uint64_t lastSegment)
+            {
+                face.answerOldest(makeSegment(face.pending.front().interest.getName().get(-1).toSegment(), lastSegment));
+            }
+
+            class PipelineFixture
+            {
+            public:
+                PipelineFixture()
+                : scheduler(face)
+                , interests(scheduler)
+                {
+                }
+
+                // a pipeline that logs the segments it delivers in @p segments, then -1 if it completes and -2 if it fails
+                shared_ptr<SegmentPipeline>
+                makePipeline(std::vector<int64_t>& segments, int maxRetries = 2)
+                {
+                    return make_shared<SegmentPipeline>(ref(interests), name::Component("alice"), 4,
+                                                        time::milliseconds(1000), maxRetries,
+                                                        [&segments] (const Data& segment) {
+                                                            segments.push_back(segment.getName().get(-1).toSegment());
+                                                        },
+                                                        [&segments] { segments.push_back(-1); },
+                                                        [&segments] { segments.push_back(-2); });
+                }
+
+                FakeFaceEndpoint face;
+                InterestScheduler scheduler;
+                OutstandingInterestTable interests;
+            };
+
+            BOOST_FIXTURE_TEST_SUITE(TestSegmentPipeline, PipelineFixture)
+
+            BOOST_AUTO_TEST_CASE(Reorder)
+            {
+                std::vector<int64_t> segments;
+                makePipeline(segments)->start(makeSegment(2, 5));
+                // the window is 4 from the next segment to deliver, 0
+                BOOST_CHECK_EQUAL(face.pending.size(), 3);
+
+                // 1 before 0: held until 0 arrives
+                face.pending.push_back(face.pending.front());
+                face.pending.pop_front();
+                answerSegment(face, 5);
+                BOOST_CHECK(segments.empty());
+                while (!face.pending.empty()) {
+                    answerSegment(face, 5);
+                }
+                std::vector<int64_t> expected = {0, 1, 2, 3, 4, 5, -1};
+                BOOST_CHECK_EQUAL_COLLECTIONS(segments.begin(), segments.end(), expected.begin(), expected.end());
+            }
+
+            BOOST_AUTO_TEST_CASE(SharedInterests)
+            {
+                std::vector<int64_t> first;
+                std::vector<int64_t> second;
+                makePipeline(first)->start(makeSegment(0, 6));
+                // 1 to 4, segment 0 is not asked for again
+                BOOST_CHECK_EQUAL(face.pending.size(), 4);
+                BOOST_CHECK_EQUAL(face.pending.front().interest.getName().get(-1).toSegment(), 1);
+                // the second pipeline asks for the same segments, no Interest is expressed for them
+                makePipeline(second)->start(makeSegment(0, 6));
+                BOOST_CHECK_EQUAL(face.pending.size(), 4);
+                BOOST_CHECK_EQUAL(interests.getWaiterCount(Name(OBJECT).appendSegment(1)), 2);
+
+                // a timeout is seen by both, each asks again, into one Interest
+                face.timeOutOldest();
+                BOOST_CHECK_EQUAL(interests.size(), 4);
+                BOOST_CHECK_EQUAL(interests.getWaiterCount(Name(OBJECT).appendSegment(1)), 2);
+
+                while (!face.pending.empty()) {
+                    answerSegment(face, 6);
+                }
+                std::vector<int64_t> expected = {0, 1, 2, 3, 4, 5, 6, -1};
+                BOOST_CHECK_EQUAL_COLLECTIONS(first.begin(), first.end(), expected.begin(), expected.end());
+                BOOST_CHECK_EQUAL_COLLECTIONS(second.begin(), second.end(), expected.begin(), expected.end());
+                BOOST_CHECK_EQUAL(interests.size(), 0);
+            }
+
+            BOOST_AUTO_TEST_CASE(SharedFailure)
+            {
+                std::vector<int64_t> first;
+                std::vector<int64_t> second;
+                makePipeline(first, 1)->start(makeSegment(0, 3));
+                makePipeline(second, 1)->start(makeSegment(0, 3));
+
+                // segment 1 never comes: both give up after their retry, once 2 and 3 are back
+                face.timeOutOldest();
+                answerSegment(face, 3);
+                answerSegment(face, 3);
+                BOOST_REQUIRE_EQUAL(face.pending.size(), 1);
+                face.timeOutOldest();
+                BOOST_CHECK(face.pending.empty());
+                std::vector<int64_t> expected = {0, -2};
+                BOOST_CHECK_EQUAL_COLLECTIONS(first.begin(), first.end(), expected.begin(), expected.end());
+                BOOST_CHECK_EQUAL_COLLECTIONS(second.begin(), second.end(), expected.begin(), expected.end());
+
+                // a new fetch of the object starts from scratch
+                std::vector<int64_t> third;
+                makePipeline(third)->start(makeSegment(0, 3));
+                BOOST_CHECK_EQUAL(interests.size(), 3);
+                BOOST_CHECK_EQUAL(interests.getWaiterCount(Name(OBJECT).appendSegment(1)), 1);
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
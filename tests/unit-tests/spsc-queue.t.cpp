@@ -0,0 +1,170 @@
+/**
+ * SpscQueue and Mailbox: items cross chunk boundaries in order, a producer and a consumer
+ * thread hand over every item exactly once, and a Mailbox runs what is posted to it in
+ * order, in batches, on the receiving io_service.
+ */
+
+#include "mailbox.hpp"
+#include "spsc-queue.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            BOOST_AUTO_TEST_SUITE(TestSpscQueue)
+
+            BOOST_AUTO_TEST_CASE(FullChunk)
+            {
+                SpscQueue<int, 4> queue;
+                int item = 0;
+                BOOST_CHECK(!queue.pop(item));
+
+                // a chunk filled to capacity and drained: the next one is not linked yet
+                for (int i = 0; i < 4; i++) {
+                    queue.push(i);
+                }
+                for (int i = 0; i < 4; i++) {
+                    BOOST_REQUIRE(queue.pop(item));
+                    BOOST_CHECK_EQUAL(item, i);
+                }
+                BOOST_CHECK(!queue.pop(item));
+                BOOST_CHECK(!queue.pop(item));
+
+                // the next push links a new chunk, which the consumer moves to
+                queue.push(4);
+                BOOST_REQUIRE(queue.pop(item));
+                BOOST_CHECK_EQUAL(item, 4);
+                BOOST_CHECK(!queue.pop(item));
+
+                // several chunks ahead of the consumer
+                for (int i = 5; i < 5 + 4 * 3 + 1; i++) {
+                    queue.push(i);
+                }
+                for (int i = 5; i < 5 + 4 * 3 + 1; i++) {
+                    BOOST_REQUIRE(queue.pop(item));
+                    BOOST_CHECK_EQUAL(item, i);
+                }
+                BOOST_CHECK(!queue.pop(item));
+            }
+
+            BOOST_AUTO_TEST_CASE(ItemsReleased)
+            {
+                shared_ptr<int> value = make_shared<int>(1);
+                {
+                    SpscQueue<shared_ptr<int>, 4> queue;
+                    for (int i = 0; i < 6; i++) {
+                        queue.push(value);
+                    }
+                    BOOST_CHECK_EQUAL(value.use_count(), 7);
+
+                    // a popped item is released when popped, not when its chunk is freed
+                    shared_ptr<int> item;
+                    BOOST_REQUIRE(queue.pop(item));
+                    item.reset();
+                    BOOST_CHECK_EQUAL(value.use_count(), 6);
+                }
+                // and those never popped with the queue
+                BOOST_CHECK_EQUAL(value.use_count(), 1);
+            }
+
+            BOOST_AUTO_TEST_CASE(TwoThreads)
+            {
+                const uint64_t N_ITEMS = 2000000;
+                SpscQueue<uint64_t, 64> queue;
+
+                std::thread producer([&] {
+                    for (uint64_t i = 1; i <= N_ITEMS; i++) {
+                        queue.push(i);
+                        if (i % 100000 == 0) {
+                            // let the consumer catch up now and then, so that it also pops at the producer's heels
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+
+                uint64_t expected = 1;
+                uint64_t nOutOfOrder = 0;
+                uint64_t item = 0;
+                while (expected <= N_ITEMS) {
+                    if (queue.pop(item)) {
+                        if (item != expected) {
+                            nOutOfOrder++;
+                        }
+                        expected = item + 1;
+                    }
+                }
+                producer.join();
+
+                BOOST_CHECK_EQUAL(nOutOfOrder, 0);
+                BOOST_CHECK_EQUAL(item, N_ITEMS);
+                BOOST_CHECK(!queue.pop(item));
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+            BOOST_AUTO_TEST_SUITE(TestMailbox)
+
+            BOOST_AUTO_TEST_CASE(Batches)
+            {
+                boost::asio::io_service ioService;
+                Mailbox mailbox(ioService, 3);
+                std::vector<int> order;
+
+                mailbox.post([&] { order.push_back(0); });
+                // queued on the io_service behind the first wakeup
+                ioService.post([&] { order.push_back(-1); });
+                for (int i = 1; i < 10; i++) {
+                    mailbox.post([&order, i] { order.push_back(i); });
+                }
+                ioService.run();
+
+                // three functions per wakeup, the other handler runs between two batches
+                std::vector<int> expected = {0, 1, 2, -1, 3, 4, 5, 6, 7, 8, 9};
+                BOOST_CHECK_EQUAL_COLLECTIONS(order.begin(), order.end(), expected.begin(), expected.end());
+            }
+
+            BOOST_AUTO_TEST_CASE(TwoThreads)
+            {
+                const int N_FUNCTIONS = 200000;
+                boost::asio::io_service ioService;
+                boost::asio::io_service::work work(ioService);
+                std::thread receiver([&] { ioService.run(); });
+
+                Mailbox mailbox(ioService, 16);
+                std::vector<int> order;
+                std::atomic<bool> isDone(false);
+                for (int i = 0; i < N_FUNCTIONS; i++) {
+                    mailbox.post([&order, i] { order.push_back(i); });
+                    if (i % 1000 == 0) {
+                        // leave the receiver time to drain, so that wakeups race with posts
+                        std::this_thread::yield();
+                    }
+                }
+                mailbox.post([&] { isDone = true; });
+
+                while (!isDone) {
+                    std::this_thread::yield();
+                }
+                ioService.stop();
+                receiver.join();
+
+                BOOST_REQUIRE_EQUAL(order.size(), static_cast<size_t>(N_FUNCTIONS));
+                int nOutOfOrder = 0;
+                for (int i = 0; i < N_FUNCTIONS; i++) {
+                    if (order[i] != i) {
+                        nOutOfOrder++;
+                    }
+                }
+                BOOST_CHECK_EQUAL(nOutOfOrder, 0);
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
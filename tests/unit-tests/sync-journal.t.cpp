@@ -0,0 +1,242 @@
+/**
+ * SyncJournal: what is appended is replayed after a reopen, replay stops at the first torn
+ * record, a compacted journal replays to the state it was compacted from, and a journal is
+ * not opened with another number of shards than it was written with.
+ */
+
+#include "sync-journal.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            // user -> (kind, id, version) -> insertion time
+            typedef std::map<std::string, std::map<std::tuple<int, uint64_t, uint64_t>, uint32_t>> PendingState;
+
+            static PendingState
+            getState(const PendingFetchTable& table, bool hasUpdateInfo = true)
+            {
+                PendingState state;
+                table.forEachUser([&] (const name::Component& user, const PendingFetchSet& entries) {
+                    std::map<std::tuple<int, uint64_t, uint64_t>, uint32_t>& keys =
+                        state[std::string(reinterpret_cast<const char*>(user.value()), user.value_size())];
+                    entries.forEachInsertion([&] (const FetchKey& key, uint32_t insertedAt) {
+                        if (hasUpdateInfo || key.kind != FETCH_UPDATE_INFO) {
+                            keys[std::make_tuple(static_cast<int>(key.kind), key.id, key.version)] = insertedAt;
+                        }
+                    });
+                });
+                return state;
+            }
+
+            class JournalFixture
+            {
+            public:
+                JournalFixture()
+                : directory(boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path("ndnfit-dsu-journal-%%%%-%%%%"))
+                {
+                    boost::filesystem::create_directories(directory);
+                    path = (directory / "journal").string();
+                }
+
+                ~JournalFixture()
+                {
+                    boost::filesystem::remove_all(directory);
+                }
+
+                size_t
+                load(size_t nShards, PendingFetchTable& pending, SyncJournal::ProgressMap& progress)
+                {
+                    SyncJournal journal(path, nShards);
+                    return journal.load(pending, progress, 999);
+                }
+
+                // overwrite @p size bytes of the journal file at @p offset with @p bytes
+                void
+                overwrite(size_t offset, const char* bytes, size_t size)
+                {
+                    std::fstream file(path.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+                    file.seekp(offset);
+                    file.write(bytes, size);
+                }
+
+                boost::filesystem::path directory;
+                std::string path;
+            };
+
+            static const size_t HEADER_SIZE = 8;
+
+            BOOST_FIXTURE_TEST_SUITE(TestSyncJournal, JournalFixture)
+
+            BOOST_AUTO_TEST_CASE(Replay)
+            {
+                name::Component alice("alice");
+                name::Component bob("bob");
+                name::Component carol("carol");
+                {
+                    SyncJournal journal(path, 0);
+                    journal.addUser(alice);
+                    journal.addUser(bob);
+                    journal.setProgress(alice, 5);
+                    journal.setProgress(alice, 7);
+                    journal.addPending(alice, FetchKey(FETCH_CATALOG, 1000, 3), 100);
+                    journal.addPending(alice, FetchKey(FETCH_DATAPOINT, 2000), 101);
+                    journal.removePending(alice, FetchKey(FETCH_DATAPOINT, 2000));
+                    journal.addPending(bob, FetchKey(FETCH_DATAPOINT, 3000), 102);
+                    journal.setProgress(bob, 2);
+                    journal.removeUser(bob);
+                    journal.addUser(carol);
+                    BOOST_CHECK_EQUAL(journal.getRecordsSinceCompaction(), 12);
+                }
+
+                PendingFetchTable pending;
+                SyncJournal::ProgressMap progress;
+                // the number of shards comes first
+                BOOST_CHECK_EQUAL(load(0, pending, progress), 12);
+
+                PendingState expected;
+                expected["alice"][std::make_tuple(static_cast<int>(FETCH_CATALOG), 1000, 3)] = 100;
+                expected["carol"];
+                BOOST_CHECK(getState(pending) == expected);
+                BOOST_REQUIRE_EQUAL(progress.size(), 1);
+                BOOST_CHECK_EQUAL(progress[alice], 7);
+            }
+
+            BOOST_AUTO_TEST_CASE(TornRecord)
+            {
+                name::Component alice("alice");
+                // a record whose checksum does not match, and one whose length was never written
+                const char BAD_CHECKSUM[] = {'\xde', '\xad', '\xbe', '\xef'};
+                const char ZERO_LENGTH[] = {0, 0, 0, 0};
+                const size_t OFFSETS[] = {4, 0};
+                const char* const CORRUPTIONS[] = {BAD_CHECKSUM, ZERO_LENGTH};
+
+                for (size_t i = 0; i < 2; i++) {
+                    boost::filesystem::remove(path);
+                    size_t tornOffset = 0;
+                    {
+                        SyncJournal journal(path, 0);
+                        journal.addUser(alice);
+                        journal.setProgress(alice, 5);
+                        journal.setProgress(alice, 6);
+                        tornOffset = HEADER_SIZE + journal.getSize();
+                        journal.addPending(alice, FetchKey(FETCH_DATAPOINT, 2000), 100);
+                    }
+                    overwrite(tornOffset + OFFSETS[i], CORRUPTIONS[i], 4);
+
+                    // the scan ends at the torn record
+                    PendingFetchTable pending;
+                    SyncJournal::ProgressMap progress;
+                    BOOST_CHECK_EQUAL(load(0, pending, progress), 4);
+                    BOOST_CHECK_EQUAL(progress[alice], 6);
+                    BOOST_REQUIRE(pending.getUser(alice) != 0);
+                    BOOST_CHECK_EQUAL(pending.getUser(alice)->size(), 0);
+
+                    // records appended after the reopen take the place of the torn one
+                    {
+                        SyncJournal journal(path, 0);
+                        BOOST_CHECK_EQUAL(HEADER_SIZE + journal.getSize(), tornOffset);
+                        journal.setProgress(alice, 8);
+                    }
+                    SyncJournal::ProgressMap progressAfter;
+                    PendingFetchTable pendingAfter;
+                    BOOST_CHECK_EQUAL(load(0, pendingAfter, progressAfter), 5);
+                    BOOST_CHECK_EQUAL(progressAfter[alice], 8);
+                }
+            }
+
+            BOOST_AUTO_TEST_CASE(CompactAndReopen)
+            {
+                PendingFetchTable table;
+                SyncJournal::ProgressMap tableProgress;
+                {
+                    SyncJournal journal(path, 2);
+                    for (int i = 0; i < 50; i++) {
+                        name::Component user("user" + std::to_string(i));
+                        journal.addUser(user);
+                        table.addUser(user);
+                        for (int j = 0; j < i % 4; j++) {
+                            FetchKey key(j % 2 == 0 ? FETCH_CATALOG : FETCH_DATAPOINT, 1000 * j, j);
+                            journal.addPending(user, key, 100 + j);
+                            table.addUser(user).insert(key, 100 + j);
+                        }
+                        // fetches that completed and older progress are not carried over
+                        journal.addPending(user, FetchKey(FETCH_DATAPOINT, 5000), 100);
+                        journal.removePending(user, FetchKey(FETCH_DATAPOINT, 5000));
+                        journal.setProgress(user, i);
+                        // update_info fetches are covered by the progress and left out of the journal
+                        table.addUser(user).insert(FetchKey(FETCH_UPDATE_INFO, i + 1), 100);
+                        journal.setProgress(user, i + 1);
+                        tableProgress[user] = i + 1;
+                    }
+                    size_t sizeBefore = journal.getSize();
+
+                    journal.compact(table, tableProgress);
+                    BOOST_CHECK_EQUAL(journal.getRecordsSinceCompaction(), 0);
+                    BOOST_CHECK_LT(journal.getSize(), sizeBefore);
+                }
+
+                PendingFetchTable pending;
+                SyncJournal::ProgressMap progress;
+                load(2, pending, progress);
+                BOOST_CHECK(getState(pending) == getState(table, false));
+                BOOST_CHECK(progress == tableProgress);
+
+                // appending goes on after the snapshot
+                name::Component late("late");
+                {
+                    SyncJournal journal(path, 2);
+                    journal.addUser(late);
+                    journal.setProgress(late, 3);
+                }
+                PendingFetchTable pendingAfter;
+                SyncJournal::ProgressMap progressAfter;
+                load(2, pendingAfter, progressAfter);
+                BOOST_CHECK_EQUAL(pendingAfter.getUserCount(), 51);
+                BOOST_CHECK_EQUAL(progressAfter[late], 3);
+
+                // the snapshot records the number of shards too
+                BOOST_CHECK_THROW(SyncJournal(path, 3), SyncJournal::Error);
+            }
+
+            BOOST_AUTO_TEST_CASE(OtherShards)
+            {
+                name::Component alice("alice");
+                {
+                    SyncJournal journal(path, 2);
+                    journal.addUser(alice);
+                    journal.setProgress(alice, 5);
+                }
+                BOOST_CHECK_THROW(SyncJournal(path, 3), SyncJournal::Error);
+                BOOST_CHECK_THROW(SyncJournal(path, 0), SyncJournal::Error);
+
+                // refusing it left the journal as it was
+                PendingFetchTable pending;
+                SyncJournal::ProgressMap progress;
+                BOOST_CHECK_EQUAL(load(2, pending, progress), 3);
+                BOOST_CHECK_EQUAL(progress[alice], 5);
+            }
+
+            BOOST_AUTO_TEST_CASE(NotAJournal)
+            {
+                const char CONTENT[] = "NDSUSPL2 something else";
+                {
+                    std::ofstream file(path.c_str(), std::ios::binary);
+                    file.write(CONTENT, sizeof(CONTENT));
+                }
+                BOOST_CHECK_THROW(SyncJournal(path, 0), SyncJournal::Error);
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
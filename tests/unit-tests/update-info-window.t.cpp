@@ -0,0 +1,154 @@
+/**
+ * UpdateInfoWindow: additive growth, one halving per loss episode, and the end of the stream,
+ * where the first missing sequence number is probed and the Interests past it are dropped.
+ */
+
+#include "update-info-window.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            static std::vector<uint64_t>
+            makeSeqNos(uint64_t first, uint64_t last)
+            {
+                std::vector<uint64_t> seqNos;
+                for (uint64_t seqNo = first; seqNo <= last; seqNo++) {
+                    seqNos.push_back(seqNo);
+                }
+                return seqNos;
+            }
+
+            BOOST_AUTO_TEST_SUITE(TestUpdateInfoWindow)
+
+            BOOST_AUTO_TEST_CASE(Growth)
+            {
+                UpdateInfoWindow window(1, 2, 8);
+                std::vector<uint64_t> sent = window.fill();
+                BOOST_CHECK(sent == makeSeqNos(1, 2));
+                BOOST_CHECK(window.fill().empty());
+
+                // one more per Data up to the maximum
+                for (uint64_t seqNo = 1; seqNo <= 20; seqNo++) {
+                    BOOST_REQUIRE(window.onData(seqNo));
+                    window.fill();
+                }
+                BOOST_CHECK_EQUAL(window.getWindow(), 8);
+                BOOST_CHECK_EQUAL(window.getInFlight(), 8);
+                BOOST_CHECK_EQUAL(window.getNextExpected(), 21);
+
+                // duplicates and Data never asked for do not count
+                BOOST_CHECK(!window.onData(20));
+                BOOST_CHECK(!window.onData(100));
+            }
+
+            BOOST_AUTO_TEST_CASE(OneDecreasePerEpisode)
+            {
+                UpdateInfoWindow window(1, 2, 32);
+                window.fill();
+                window.onData(1);
+                window.onData(2);
+                BOOST_CHECK_EQUAL(window.getWindow(), 4);
+                BOOST_CHECK(window.fill() == makeSeqNos(3, 6));
+
+                // 3 and 4 are lost, 5 and 6 arrive
+                window.onData(5);
+                window.onData(6);
+                BOOST_CHECK_EQUAL(window.getWindow(), 6);
+                BOOST_CHECK_EQUAL(window.getNextExpected(), 3);
+
+                // the first loss halves the window, the second, sent before it, is the same episode
+                BOOST_CHECK_EQUAL(window.onTimeout(3), UpdateInfoWindow::RETRANSMIT);
+                BOOST_CHECK_EQUAL(window.getWindow(), 3);
+                BOOST_CHECK_EQUAL(window.onTimeout(4), UpdateInfoWindow::RETRANSMIT);
+                BOOST_CHECK_EQUAL(window.getWindow(), 3);
+                BOOST_CHECK_EQUAL(window.onTimeout(3), UpdateInfoWindow::RETRANSMIT);
+                BOOST_CHECK_EQUAL(window.getWindow(), 3);
+                // retransmitted Interests stay in flight
+                BOOST_CHECK_EQUAL(window.getInFlight(), 2);
+
+                // past the threshold the window grows by one per window of Data
+                BOOST_CHECK(window.onData(3));
+                BOOST_CHECK_CLOSE(window.getWindow(), 3 + 1.0 / 3, 0.001);
+                std::vector<uint64_t> sent = window.fill();
+                BOOST_CHECK(sent == makeSeqNos(7, 8));
+                BOOST_CHECK(window.onData(8));
+                double before = window.getWindow();
+
+                // a loss of an Interest sent after the decrease is a new episode
+                BOOST_CHECK_EQUAL(window.onTimeout(7), UpdateInfoWindow::RETRANSMIT);
+                BOOST_CHECK_CLOSE(window.getWindow(), before / 2, 0.001);
+                BOOST_CHECK_EQUAL(window.onTimeout(4), UpdateInfoWindow::RETRANSMIT);
+                BOOST_CHECK_CLOSE(window.getWindow(), before / 2, 0.001);
+
+                // never below one
+                UpdateInfoWindow small(1, 1, 32);
+                small.fill();
+                small.onData(1);
+                small.fill();
+                small.onData(3);
+                BOOST_CHECK_EQUAL(small.onTimeout(2), UpdateInfoWindow::RETRANSMIT);
+                BOOST_CHECK_GE(small.getWindow(), 1);
+            }
+
+            BOOST_AUTO_TEST_CASE(EndOfStream)
+            {
+                UpdateInfoWindow window(1, 4, 32);
+                BOOST_CHECK(window.fill() == makeSeqNos(1, 4));
+                window.onData(1);
+                BOOST_CHECK(window.fill() == makeSeqNos(5, 6));
+
+                // nothing was published past 1: the first missing seqNo is probed, the rest dropped
+                BOOST_CHECK_EQUAL(window.onTimeout(2), UpdateInfoWindow::PROBE);
+                BOOST_CHECK(window.isAtEndOfStream());
+                BOOST_CHECK_EQUAL(window.getWindow(), 1);
+                BOOST_CHECK_EQUAL(window.getProbeTimeoutCount(), 1);
+                BOOST_CHECK_EQUAL(window.onTimeout(3), UpdateInfoWindow::DROP);
+                BOOST_CHECK_EQUAL(window.onTimeout(5), UpdateInfoWindow::DROP);
+                BOOST_CHECK_EQUAL(window.onTimeout(4), UpdateInfoWindow::DROP);
+                BOOST_CHECK_EQUAL(window.onTimeout(6), UpdateInfoWindow::DROP);
+                BOOST_CHECK_EQUAL(window.getInFlight(), 1);
+                // a dropped seqNo is not in flight any more
+                BOOST_CHECK_EQUAL(window.onTimeout(3), UpdateInfoWindow::IGNORE);
+                BOOST_CHECK_EQUAL(window.getProbeTimeoutCount(), 1);
+
+                // a single probe stays out, and times out as a probe again, without halving
+                BOOST_CHECK(window.fill().empty());
+                BOOST_CHECK_EQUAL(window.onTimeout(2), UpdateInfoWindow::PROBE);
+                BOOST_CHECK_EQUAL(window.getProbeTimeoutCount(), 2);
+                BOOST_CHECK_EQUAL(window.getWindow(), 1);
+                window.resetProbeTimeouts();
+                BOOST_CHECK_EQUAL(window.getProbeTimeoutCount(), 0);
+
+                // the phone published 2: out of probing, the dropped seqNos are asked for again
+                BOOST_CHECK_EQUAL(window.onTimeout(2), UpdateInfoWindow::PROBE);
+                BOOST_CHECK(window.onData(2));
+                BOOST_CHECK(!window.isAtEndOfStream());
+                BOOST_CHECK_EQUAL(window.getProbeTimeoutCount(), 0);
+                BOOST_CHECK_EQUAL(window.getWindow(), 2);
+                BOOST_CHECK(window.fill() == makeSeqNos(3, 4));
+            }
+
+            BOOST_AUTO_TEST_CASE(ProbeBelowInFlight)
+            {
+                // an Interest past the highest Data times out while one below it is still out:
+                // the lowest one in flight past the highest Data is the probe
+                UpdateInfoWindow window(10, 3, 32);
+                BOOST_CHECK(window.fill() == makeSeqNos(10, 12));
+                BOOST_CHECK_EQUAL(window.onTimeout(12), UpdateInfoWindow::DROP);
+                BOOST_CHECK_EQUAL(window.onTimeout(11), UpdateInfoWindow::DROP);
+                BOOST_CHECK_EQUAL(window.onTimeout(10), UpdateInfoWindow::PROBE);
+                BOOST_CHECK(window.fill().empty());
+                BOOST_CHECK(window.onData(10));
+                BOOST_CHECK_EQUAL(window.getNextExpected(), 11);
+                BOOST_CHECK(window.fill() == makeSeqNos(11, 12));
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
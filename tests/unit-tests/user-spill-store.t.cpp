@@ -0,0 +1,229 @@
+/**
+ * UserSpillStore: what is saved is taken back once, in the current format and in the one
+ * without insertion times, user_ids of any bytes are listed back from the file names, and a
+ * damaged file is refused.
+ */
+
+#include "user-spill-store.hpp"
+#include "file-io.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ndn {
+    namespace dsu {
+        namespace tests {
+
+            class SpillFixture
+            {
+            public:
+                SpillFixture()
+                : directory(boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path("ndnfit-dsu-spill-%%%%-%%%%"))
+                {
+                }
+
+                ~SpillFixture()
+                {
+                    boost::filesystem::remove_all(directory);
+                }
+
+                std::string
+                getPath(const std::string& fileName) const
+                {
+                    return (directory / fileName).string();
+                }
+
+                boost::filesystem::path directory;
+            };
+
+            static bool
+            hasEntry(const std::vector<UserSpillStore::Entry>& entries, const FetchKey& key, uint32_t insertedAt)
+            {
+                for (size_t i = 0; i < entries.size(); i++) {
+                    if (entries[i].key == key && entries[i].insertedAt == insertedAt) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            BOOST_FIXTURE_TEST_SUITE(TestUserSpillStore, SpillFixture)
+
+            BOOST_AUTO_TEST_CASE(RoundTrip)
+            {
+                UserSpillStore store(directory.string());
+                BOOST_CHECK_EQUAL(store.size(), 0);
+
+                name::Component alice("alice");
+                PendingFetchSet pending;
+                pending.insert(FetchKey(FETCH_CATALOG, 1456000000000, 3), 100);
+                pending.insert(FetchKey(FETCH_DATAPOINT, 1456000001000), 101);
+                // covered by the sequence number, not written
+                pending.insert(FetchKey(FETCH_UPDATE_INFO, 41), 102);
+                store.save(alice, pending, 42);
+                BOOST_CHECK_EQUAL(store.size(), 1);
+
+                // saving again replaces the file
+                pending.erase(FetchKey(FETCH_DATAPOINT, 1456000001000));
+                pending.insert(FetchKey(FETCH_DATAPOINT, 1456000002000), 103);
+                store.save(alice, pending, 43);
+                BOOST_CHECK_EQUAL(store.size(), 1);
+                BOOST_CHECK_EQUAL(UserSpillStore(directory.string()).size(), 1);
+
+                std::vector<UserSpillStore::Entry> entries;
+                uint64_t nextSeqNo = 0;
+                BOOST_REQUIRE(store.take(alice, entries, nextSeqNo, 999));
+                BOOST_CHECK_EQUAL(nextSeqNo, 43);
+                BOOST_REQUIRE_EQUAL(entries.size(), 2);
+                BOOST_CHECK(hasEntry(entries, FetchKey(FETCH_CATALOG, 1456000000000, 3), 100));
+                BOOST_CHECK(hasEntry(entries, FetchKey(FETCH_DATAPOINT, 1456000002000), 103));
+
+                // the file is gone once taken
+                BOOST_CHECK_EQUAL(store.size(), 0);
+                BOOST_CHECK(store.listUsers().empty());
+                entries.clear();
+                BOOST_CHECK(!store.take(alice, entries, nextSeqNo, 999));
+                BOOST_CHECK(entries.empty());
+            }
+
+            BOOST_AUTO_TEST_CASE(HandOver)
+            {
+                UserSpillStore store(directory.string());
+                UserSpillStore other((directory / "other").string());
+                name::Component alice("alice");
+                PendingFetchSet pending;
+                pending.insert(FetchKey(FETCH_DATAPOINT, 1456000001000), 101);
+                store.save(alice, pending, 7);
+
+                std::vector<uint8_t> state;
+                BOOST_REQUIRE(store.takeState(alice, state));
+                BOOST_CHECK_EQUAL(store.size(), 0);
+                other.putState(alice, state);
+                BOOST_CHECK_EQUAL(other.size(), 1);
+
+                std::vector<UserSpillStore::Entry> parsed;
+                uint64_t parsedSeqNo = 0;
+                BOOST_REQUIRE(UserSpillStore::parseState(state, parsed, parsedSeqNo, 999));
+                std::vector<UserSpillStore::Entry> entries;
+                uint64_t nextSeqNo = 0;
+                BOOST_REQUIRE(other.take(alice, entries, nextSeqNo, 999));
+                BOOST_CHECK_EQUAL(nextSeqNo, 7);
+                BOOST_CHECK_EQUAL(parsedSeqNo, 7);
+                BOOST_REQUIRE_EQUAL(entries.size(), 1);
+                BOOST_CHECK(hasEntry(entries, FetchKey(FETCH_DATAPOINT, 1456000001000), 101));
+                BOOST_CHECK(hasEntry(parsed, FetchKey(FETCH_DATAPOINT, 1456000001000), 101));
+            }
+
+            BOOST_AUTO_TEST_CASE(FormatWithoutInsertionTimes)
+            {
+                // what files were before insertion times: no time after each entry
+                std::vector<uint8_t> state;
+                const char MAGIC_V1[] = "NDSUSPL1";
+                state.insert(state.end(), MAGIC_V1, MAGIC_V1 + 8);
+                putUint(state, 42, 8);
+                putUint(state, 2, 4);
+                putUint(state, FETCH_CATALOG, 1);
+                putUint(state, 1456000000000, 8);
+                putUint(state, 3, 8);
+                putUint(state, FETCH_DATAPOINT, 1);
+                putUint(state, 1456000001000, 8);
+                putUint(state, 0, 8);
+                putUint(state, checksum(&state[0], state.size()), 4);
+
+                UserSpillStore store(directory.string());
+                name::Component alice("alice");
+                store.putState(alice, state);
+
+                // they count as inserted when they are read back
+                std::vector<UserSpillStore::Entry> entries;
+                uint64_t nextSeqNo = 0;
+                BOOST_REQUIRE(store.take(alice, entries, nextSeqNo, 777));
+                BOOST_CHECK_EQUAL(nextSeqNo, 42);
+                BOOST_REQUIRE_EQUAL(entries.size(), 2);
+                BOOST_CHECK(hasEntry(entries, FetchKey(FETCH_CATALOG, 1456000000000, 3), 777));
+                BOOST_CHECK(hasEntry(entries, FetchKey(FETCH_DATAPOINT, 1456000001000), 777));
+
+                // a file of the current format with the entry size of the old one is refused
+                std::memcpy(&state[0], "NDSUSPL2", 8);
+                state.resize(state.size() - 4);
+                putUint(state, checksum(&state[0], state.size()), 4);
+                entries.clear();
+                BOOST_CHECK(!UserSpillStore::parseState(state, entries, nextSeqNo, 777));
+            }
+
+            BOOST_AUTO_TEST_CASE(ListUsers)
+            {
+                UserSpillStore store(directory.string());
+                std::vector<name::Component> users;
+                const uint8_t BINARY[] = {0x00, 0xff, '/', 'A', 0x80};
+                users.push_back(name::Component(BINARY, sizeof(BINARY)));
+                users.push_back(name::Component("alice"));
+                users.push_back(name::Component("b%2Fc d"));
+                PendingFetchSet pending;
+                for (size_t i = 0; i < users.size(); i++) {
+                    store.save(users[i], pending, i + 1);
+                }
+                BOOST_CHECK(boost::filesystem::exists(getPath("00ff2f4180.spill")));
+
+                // files that are not spill files, or not hex, are skipped
+                const char* const OTHERS[] = {"notes.txt", "616c.spill.tmp", "zz.spill", "616.spill", "616C.spill"};
+                for (size_t i = 0; i < sizeof(OTHERS) / sizeof(OTHERS[0]); i++) {
+                    std::ofstream(getPath(OTHERS[i]).c_str()) << "x";
+                }
+
+                std::vector<name::Component> listed = store.listUsers();
+                std::sort(users.begin(), users.end());
+                std::sort(listed.begin(), listed.end());
+                BOOST_CHECK(listed == users);
+            }
+
+            BOOST_AUTO_TEST_CASE(Damaged)
+            {
+                UserSpillStore store(directory.string());
+                name::Component alice("alice");
+                PendingFetchSet pending;
+                pending.insert(FetchKey(FETCH_DATAPOINT, 1456000001000), 101);
+                store.save(alice, pending, 42);
+
+                std::vector<uint8_t> state;
+                BOOST_REQUIRE(store.takeState(alice, state));
+                std::vector<UserSpillStore::Entry> entries;
+                uint64_t nextSeqNo = 0;
+                BOOST_REQUIRE(UserSpillStore::parseState(state, entries, nextSeqNo, 999));
+
+                // any byte flipped, the checksum included, fails the check
+                for (size_t i = 0; i < state.size(); i++) {
+                    std::vector<uint8_t> damaged = state;
+                    damaged[i] ^= 0x01;
+                    entries.clear();
+                    BOOST_CHECK_MESSAGE(!UserSpillStore::parseState(damaged, entries, nextSeqNo, 999),
+                                        "byte " << i << " flipped");
+                }
+                for (size_t size = 0; size < state.size(); size++) {
+                    std::vector<uint8_t> truncated(state.begin(), state.begin() + size);
+                    entries.clear();
+                    BOOST_CHECK_MESSAGE(!UserSpillStore::parseState(truncated, entries, nextSeqNo, 999),
+                                        "truncated to " << size);
+                }
+
+                // a damaged file is refused and removed, the user syncs again from the start
+                state[20] ^= 0x01;
+                store.putState(alice, state);
+                BOOST_CHECK_EQUAL(store.size(), 1);
+                entries.clear();
+                BOOST_CHECK(!store.take(alice, entries, nextSeqNo, 999));
+                BOOST_CHECK_EQUAL(store.size(), 0);
+                BOOST_CHECK(!boost::filesystem::exists(getPath("616c696365.spill")));
+            }
+
+            BOOST_AUTO_TEST_SUITE_END()
+
+        } // namespace tests
+    } // namespace dsu
+} // namespace ndn
@@ -0,0 +1,166 @@
+#!/usr/bin/env bash
+#
+# Checks that a cluster of ndnfit-dsu instances hands users over when its members change:
+# dsu-a, dsu-b and dsu-c share a members file while phones are being synced. dsu-c is taken
+# off the list, and the users it owned must be picked up by dsu-a and dsu-b where dsu-c left
+# them, not synced again from update_info 1. dsu-c is then put back on the list and must get
+# them back the same way. Every user must still be caught up in the end.
+#
+# Starts NFD unless one is running. Needs a tree built with ./waf configure --with-benchmarks
+# && ./waf; BUILD points to another build directory, PORT picks the repo port.
+
+set -u
+
+BUILD=${BUILD:-build}
+PORT=${PORT:-17376}
+PHONES=12
+WORK=$(mktemp -d)
+MEMBERS="$WORK/members"
+NFD_PID=
+REPO_PID=
+DSU_PIDS=
+BENCHMARK_PID=
+
+cleanup() {
+    for pid in $BENCHMARK_PID $DSU_PIDS $REPO_PID $NFD_PID; do
+        kill "$pid" 2>/dev/null
+    done
+    wait 2>/dev/null
+    rm -rf "$WORK"
+}
+trap cleanup EXIT
+
+fail() {
+    echo "FAIL: $*" >&2
+    for log in "$WORK"/*.log; do
+        echo "--- $log" >&2
+        tail -n 20 "$log" >&2
+    done
+    exit 1
+}
+
+# a gauge of the last metrics file written by instance $1, empty until there is one
+gauge() {
+    sed -n "s/.*\"$2\":\([0-9]*\).*/\1/p" "$WORK/$1.metrics.json" 2>/dev/null
+}
+
+# wait up to $1 seconds for the command that follows to succeed
+wait_for() {
+    local seconds=$1
+    shift
+    for ((i = 0; i < seconds * 10; i++)); do
+        if "$@"; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    return 1
+}
+
+start_dsu() {
+    "$BUILD/ndnfit-dsu" --cluster-name "$1" --cluster-members "$MEMBERS" \
+                        --repo "127.0.0.1:$PORT" --journal "$WORK/$1.journal" --spill-dir "$WORK/$1.spill" \
+                        --metrics-file "$WORK/$1.metrics.json" --metrics-interval 1 \
+                        > "$WORK/$1.log" 2>&1 &
+    DSU_PIDS="$DSU_PIDS $!"
+}
+
+set_members() {
+    printf "%s\n" "$@" > "$MEMBERS.new"
+    mv "$MEMBERS.new" "$MEMBERS"
+    echo "Members: $*"
+}
+
+# "<user> <new owner>" for every user instance $1 handed over
+handed_over() {
+    sed -n "s/.*Handed user \([^ ]*\) over to \([^ ]*\)$/\1 \2/p" "$WORK/$1.log"
+}
+
+# every instance given has had the handoff of all the users it said it hands over acknowledged
+are_handed_over() {
+    local from expected
+    for from in "$@"; do
+        expected=$(sed -n "s/.*Handing \([0-9]*\) users over.*/\1/p" "$WORK/$from.log" |
+                   awk '{ n += $1 } END { print n + 0 }')
+        [ "$(handed_over "$from" | wc -l)" -ge "$expected" ] || return 1
+    done
+}
+
+# the update_info sequence number user $1 was last picked up from by instance $2, empty if it was not
+picked_up_from() {
+    grep -E "(Reloaded|into) user $1[ ,]" "$WORK/$2.log" | tail -n 1 | sed -n "s/.*update_info from \([0-9]*\).*/\1/p"
+}
+
+nfd_is_up() { nfd-status > /dev/null 2>&1; }
+has_written() { [ "$(gauge "$1" repo_packets_written)" -gt 0 ] 2>/dev/null; }
+has_registered() { grep -q " $PHONES registered" "$WORK/benchmark.log"; }
+has_handed_over() { [ -n "$(handed_over "$1")" ]; }
+has_handed_back() { has_handed_over dsu-a || has_handed_over dsu-b; }
+
+# every user the instances given have handed over has been picked up by its new owner
+are_picked_up() {
+    local from user owner
+    for from in "$@"; do
+        while read -r user owner; do
+            [ -n "$(picked_up_from "$user" "$owner")" ] || return 1
+        done < <(handed_over "$from")
+    done
+}
+
+# ... from where the instance handing it over left it
+check_progress() {
+    local from user owner seqNo
+    for from in "$@"; do
+        while read -r user owner; do
+            seqNo=$(picked_up_from "$user" "$owner")
+            if [ "$seqNo" -le 1 ]; then
+                fail "$owner started user $user handed over by $from again from update_info $seqNo"
+            fi
+        done < <(handed_over "$from")
+        echo "$from handed $(handed_over "$from" | wc -l) users over, picked up where they were"
+    done
+}
+
+if ! nfd_is_up; then
+    nfd > "$WORK/nfd.log" 2>&1 &
+    NFD_PID=$!
+    wait_for 10 nfd_is_up || fail "NFD did not start"
+fi
+
+"$BUILD/bin/ndnfit-dsu-fake-repo" --port "$PORT" --delay-ms 10 > "$WORK/repo.log" 2>&1 &
+REPO_PID=$!
+set_members dsu-a dsu-b dsu-c
+for name in dsu-a dsu-b dsu-c; do
+    start_dsu "$name"
+done
+# phones register every 15 s, that is what loads a user on its new owner
+"$BUILD/benchmarks/sync-benchmark" --dsu "" --fake-repo "" --repo-port "$PORT" --phones "$PHONES" \
+                                   --register-interval 15 --timeout 300 \
+                                   > "$WORK/benchmark.log" 2>&1 &
+BENCHMARK_PID=$!
+
+wait_for 30 has_registered || fail "the phones did not all register"
+for name in dsu-a dsu-b dsu-c; do
+    wait_for 30 has_written "$name" || fail "$name wrote nothing to the repo, it owns no user"
+done
+kill -0 "$BENCHMARK_PID" 2>/dev/null || fail "the phones were synced before the members changed"
+
+set_members dsu-a dsu-b
+wait_for 30 has_handed_over dsu-c || fail "dsu-c did not hand its users over"
+wait_for 60 are_handed_over dsu-c || fail "the new owners did not acknowledge every user of dsu-c"
+wait_for 60 are_picked_up dsu-c || fail "the users dsu-c handed over were not picked up"
+check_progress dsu-c
+
+kill -0 "$BENCHMARK_PID" 2>/dev/null || fail "the phones were synced before dsu-c came back"
+set_members dsu-a dsu-b dsu-c
+wait_for 30 has_handed_back || fail "no user was handed back to dsu-c"
+wait_for 60 are_handed_over dsu-a dsu-b || fail "dsu-c did not acknowledge every user handed back"
+wait_for 60 are_picked_up dsu-a dsu-b || fail "the users handed back to dsu-c were not picked up"
+check_progress dsu-a dsu-b
+
+wait "$BENCHMARK_PID" || fail "sync-benchmark failed"
+BENCHMARK_PID=
+if grep -q "not caught up" "$WORK/benchmark.log"; then
+    fail "$(grep "not caught up" "$WORK/benchmark.log")"
+fi
+echo "PASS"
@@ -0,0 +1,94 @@
+#!/usr/bin/env bash
+#
+# Checks that ndnfit-dsu gets over a repo crash: ndnfit-dsu-fake-repo is killed while
+# phones are being synced, then started again on the same port. The DSU must reconnect,
+# drain the packets it queued in the meantime and still get every user caught up.
+#
+# Needs a running NFD and a tree built with ./waf configure --with-benchmarks && ./waf;
+# BUILD points to another build directory, PORT picks the repo port.
+
+set -u
+
+BUILD=${BUILD:-build}
+PORT=${PORT:-17376}
+WORK=$(mktemp -d)
+REPO_PID=
+DSU_PID=
+BENCHMARK_PID=
+
+cleanup() {
+    for pid in $BENCHMARK_PID $DSU_PID $REPO_PID; do
+        kill "$pid" 2>/dev/null
+    done
+    wait 2>/dev/null
+    rm -rf "$WORK"
+}
+trap cleanup EXIT
+
+fail() {
+    echo "FAIL: $*" >&2
+    for log in "$WORK"/*.log; do
+        echo "--- $log" >&2
+        tail -n 20 "$log" >&2
+    done
+    exit 1
+}
+
+# a gauge of the last metrics file written, empty until there is one
+gauge() {
+    sed -n "s/.*\"$1\":\([0-9]*\).*/\1/p" "$WORK/metrics.json" 2>/dev/null
+}
+
+# wait up to $1 seconds for the command that follows to succeed
+wait_for() {
+    local seconds=$1
+    shift
+    for ((i = 0; i < seconds * 10; i++)); do
+        if "$@"; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    return 1
+}
+
+start_repo() {
+    "$BUILD/bin/ndnfit-dsu-fake-repo" --port "$PORT" >> "$WORK/repo.log" 2>&1 &
+    REPO_PID=$!
+}
+
+has_written() { [ "$(gauge repo_packets_written)" -gt 0 ] 2>/dev/null; }
+has_queued() { [ "$(gauge repo_queue)" -gt 0 ] 2>/dev/null; }
+has_drained() { [ "$(gauge repo_queue)" = 0 ]; }
+has_reconnected() { [ "$(grep -c "Connected to repo" "$WORK/dsu.log")" -ge 2 ]; }
+
+start_repo
+"$BUILD/ndnfit-dsu" --repo "127.0.0.1:$PORT" --journal "" --spill-dir "" \
+                    --metrics-file "$WORK/metrics.json" --metrics-interval 1 \
+                    > "$WORK/dsu.log" 2>&1 &
+DSU_PID=$!
+"$BUILD/benchmarks/sync-benchmark" --dsu "" --fake-repo "" --dsu-pid "$DSU_PID" \
+                                   --repo-port "$PORT" --phones 5 --timeout 120 \
+                                   > "$WORK/benchmark.log" 2>&1 &
+BENCHMARK_PID=$!
+
+wait_for 30 has_written || fail "nothing was written to the repo"
+kill -9 "$REPO_PID"
+wait "$REPO_PID" 2>/dev/null
+echo "Repo killed after $(gauge repo_packets_written) packets"
+
+# the phones keep serving, what they send piles up in the DSU's queue
+wait_for 15 has_queued || fail "nothing was queued while the repo was down"
+echo "$(gauge repo_queue) packets queued while the repo is down"
+
+start_repo
+wait_for 60 has_reconnected || fail "the DSU did not reconnect to the repo"
+wait_for 60 has_drained || fail "the repo queue did not drain, $(gauge repo_queue) packets left"
+echo "Reconnected, queue drained"
+
+wait "$BENCHMARK_PID" || fail "sync-benchmark failed"
+BENCHMARK_PID=
+if grep -q "not caught up" "$WORK/benchmark.log"; then
+    fail "$(grep "not caught up" "$WORK/benchmark.log")"
+fi
+echo "PASS"
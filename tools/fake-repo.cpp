@@ -0,0 +1,297 @@
+/**
+ * Stand-in for the repo's TCP bulk-insert endpoint, to exercise ndnfit-dsu's repo
+ * connections without a real repo.
+ *
+ * Data packets received are kept in memory by name. An Interest is answered with the
+ * stored Data, or with an empty Data under the Interest's name if nothing is stored.
+ * --delay-ms slows down every packet to make the DSU's queues fill up, --latency-ms delays
+ * the replies without slowing down the packets that follow, and --die-after exits after a
+ * number of packets to simulate a crash; restarting it on the same port lets the DSU reconnect.
+ * check-repo-reconnect.sh kills and restarts it that way under a sync-benchmark load.
+ */
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/interest.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <boost/asio.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <tuple>
+
+namespace ndn {
+    namespace dsu {
+
+        struct FakeRepoOptions
+        {
+            FakeRepoOptions()
+            : port(7376)
+            , delayMs(0)
+            , latencyMs(0)
+            , dieAfter(0)
+            {
+            }
+
+            unsigned short port;
+            int delayMs;
+            int latencyMs;
+            // 0 never dies
+            size_t dieAfter;
+        };
+
+        class FakeRepo : noncopyable
+        {
+        public:
+            explicit
+            FakeRepo(const FakeRepoOptions& options)
+            : m_options(options)
+            , m_acceptor(m_ioService, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), options.port))
+            , m_nPackets(0)
+            , m_nInserted(0)
+            , m_nHits(0)
+            , m_nMisses(0)
+            {
+            }
+
+            void
+            run()
+            {
+                std::cout << "Listening on port " << m_options.port << std::endl;
+                accept();
+                m_ioService.run();
+            }
+
+        private:
+            class Session : public enable_shared_from_this<Session>
+            {
+            public:
+                Session(FakeRepo& repo, boost::asio::io_service& ioService)
+                : m_repo(repo)
+                , m_ioService(ioService)
+                , m_socket(ioService)
+                , m_timer(ioService)
+                , m_inputBuffer(MAX_NDN_PACKET_SIZE)
+                , m_inputBufferSize(0)
+                {
+                }
+
+                boost::asio::ip::tcp::socket&
+                getSocket()
+                {
+                    return m_socket;
+                }
+
+                void
+                receive()
+                {
+                    m_socket.async_receive(boost::asio::buffer(&m_inputBuffer[m_inputBufferSize],
+                                                               m_inputBuffer.size() - m_inputBufferSize),
+                                           bind(&Session::onReceived, shared_from_this(), _1, _2));
+                }
+
+            private:
+                void
+                onReceived(const boost::system::error_code& error, size_t nBytes)
+                {
+                    if (error) {
+                        std::cout << "Connection closed: " << error.message() << std::endl;
+                        return;
+                    }
+                    m_inputBufferSize += nBytes;
+                    processNext();
+                }
+
+                // handle one complete packet, waiting --delay-ms before the next one
+                void
+                processNext()
+                {
+                    bool isOk = false;
+                    Block element;
+                    std::tie(isOk, element) = Block::fromBuffer(&m_inputBuffer[0], m_inputBufferSize);
+                    if (!isOk) {
+                        if (m_inputBufferSize == m_inputBuffer.size()) {
+                            std::cerr << "ERROR: packet too large, closing connection" << std::endl;
+                            return;
+                        }
+                        receive();
+                        return;
+                    }
+                    std::copy(m_inputBuffer.begin() + element.size(), m_inputBuffer.begin() + m_inputBufferSize,
+                              m_inputBuffer.begin());
+                    m_inputBufferSize -= element.size();
+
+                    Block reply = m_repo.process(element);
+                    if (reply.hasWire()) {
+                        if (m_repo.m_options.latencyMs > 0) {
+                            shared_ptr<boost::asio::deadline_timer> timer(new boost::asio::deadline_timer(m_ioService));
+                            timer->expires_from_now(boost::posix_time::milliseconds(m_repo.m_options.latencyMs));
+                            timer->async_wait(bind(&Session::onLatencyElapsed, shared_from_this(), timer, reply));
+                        } else {
+                            send(reply);
+                        }
+                    }
+
+                    m_timer.expires_from_now(boost::posix_time::milliseconds(m_repo.m_options.delayMs));
+                    m_timer.async_wait(bind(&Session::processNext, shared_from_this()));
+                }
+
+                void
+                onLatencyElapsed(const shared_ptr<boost::asio::deadline_timer>& timer, const Block& reply)
+                {
+                    send(reply);
+                }
+
+                // replies are written one at a time, so that they do not interleave on the socket
+                void
+                send(const Block& reply)
+                {
+                    m_replies.push_back(reply);
+                    if (m_replies.size() == 1) {
+                        write();
+                    }
+                }
+
+                void
+                write()
+                {
+                    const Block& wire = m_replies.front();
+                    boost::asio::async_write(m_socket, boost::asio::buffer(wire.wire(), wire.size()),
+                                             bind(&Session::onWritten, shared_from_this(), _1));
+                }
+
+                void
+                onWritten(const boost::system::error_code& error)
+                {
+                    if (error) {
+                        std::cerr << "ERROR: write failed: " << error.message() << std::endl;
+                        return;
+                    }
+                    m_replies.pop_front();
+                    if (!m_replies.empty()) {
+                        write();
+                    }
+                }
+
+            private:
+                FakeRepo& m_repo;
+                boost::asio::io_service& m_ioService;
+                boost::asio::ip::tcp::socket m_socket;
+                boost::asio::deadline_timer m_timer;
+                std::vector<uint8_t> m_inputBuffer;
+                size_t m_inputBufferSize;
+                std::deque<Block> m_replies;
+            };
+
+            void
+            accept()
+            {
+                shared_ptr<Session> session = make_shared<Session>(ref(*this), ref(m_ioService));
+                m_acceptor.async_accept(session->getSocket(), bind(&FakeRepo::onAccepted, this, session, _1));
+            }
+
+            void
+            onAccepted(const shared_ptr<Session>& session, const boost::system::error_code& error)
+            {
+                if (!error) {
+                    std::cout << "Accepted connection from " << session->getSocket().remote_endpoint() << std::endl;
+                    session->receive();
+                }
+                accept();
+            }
+
+            /// @return the reply to send back, or an empty Block
+            Block
+            process(const Block& element)
+            {
+                Block reply;
+                if (element.type() == tlv::Data) {
+                    Data data(element);
+                    m_store[data.getName()] = element;
+                    m_nInserted++;
+                } else if (element.type() == tlv::Interest) {
+                    Interest interest(element);
+                    std::map<Name, Block>::iterator it = m_store.lower_bound(interest.getName());
+                    if (it != m_store.end() && interest.getName().isPrefixOf(it->first)) {
+                        reply = it->second;
+                        m_nHits++;
+                    } else {
+                        Data missing(interest.getName());
+                        m_keyChain.sign(missing, security::signingWithSha256());
+                        reply = missing.wireEncode();
+                        m_nMisses++;
+                    }
+                }
+
+                if (++m_nPackets % 1000 == 0) {
+                    std::cout << m_nPackets << " packets: " << m_nInserted << " inserted, "
+                    << m_nHits << " found, " << m_nMisses << " not found" << std::endl;
+                }
+                if (m_options.dieAfter != 0 && m_nPackets >= m_options.dieAfter) {
+                    std::cout << "Exiting after " << m_nPackets << " packets" << std::endl;
+                    std::exit(1);
+                }
+                return reply;
+            }
+
+        private:
+            FakeRepoOptions m_options;
+            boost::asio::io_service m_ioService;
+            boost::asio::ip::tcp::acceptor m_acceptor;
+            KeyChain m_keyChain;
+            std::map<Name, Block> m_store;
+            size_t m_nPackets;
+            size_t m_nInserted;
+            size_t m_nHits;
+            size_t m_nMisses;
+        };
+
+    } // namespace dsu
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+    namespace po = boost::program_options;
+
+    ndn::dsu::FakeRepoOptions options;
+    po::options_description description("Usage: ndnfit-dsu-fake-repo [options]");
+    description.add_options()
+    ("help,h", "print this help message and exit")
+    ("port,p", po::value<unsigned short>(&options.port)->default_value(options.port),
+     "TCP port to listen on")
+    ("delay-ms", po::value<int>(&options.delayMs)->default_value(options.delayMs),
+     "milliseconds spent on every packet")
+    ("latency-ms", po::value<int>(&options.latencyMs)->default_value(options.latencyMs),
+     "milliseconds before a reply is sent")
+    ("die-after", po::value<size_t>(&options.dieAfter)->default_value(options.dieAfter),
+     "exit after this many packets, 0 never exits");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, description), vm);
+        po::notify(vm);
+    }
+    catch (const po::error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl << description << std::endl;
+        return 2;
+    }
+    if (vm.count("help") > 0) {
+        std::cout << description << std::endl;
+        return 0;
+    }
+
+    try {
+        ndn::dsu::FakeRepo repo(options);
+        repo.run();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}